@@ -0,0 +1,430 @@
+/**********************************************************************************
+ * bench.c -> Benchmark harness of:                                               *
+ * Disassembler and Cycle Counter for the 6502 microprocessor                     *
+ *                                                                                *
+ * This code is offered under the MIT License (MIT)                               *
+ *                                                                                *
+ * Copyright (c) 1998-2014 Tennessee Carmel-Veilleux <veilleux@tentech.ca>        *
+ * Copyright (c) 2017      Michael Pohoreski <michaelangel007@sharedcraft.com>    *
+ *                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ * of this software and associated documentation files (the "Software"), to deal  *
+ * in the Software without restriction, including without limitation the rights   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ * copies of the Software, and to permit persons to whom the Software is          *
+ * furnished to do so, subject to the following conditions:                       *
+ *                                                                                *
+ * The above copyright notice and this permission notice shall be included in all *
+ * copies or substantial portions of the Software.                                *
+ *                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ * SOFTWARE.                                                                      *
+ **********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "dcc6502.h"
+
+#define BENCH_DIR          "bench_data"
+#define BENCH_SIZE         (4ul << 20) /* Bytes of each generated input */
+#define BENCH_RUNS         7           /* Runs of each case, the median counts */
+#define BENCH_RETRIES      2           /* Rounds measuring again the cases over the threshold */
+#define BENCH_THRESHOLD    20          /* Percent slower than the baseline that fails */
+#define MAX_BASELINE       64
+
+/* Generated input */
+typedef struct bench_input_s {
+    const char *name;
+    void      (*generate)(uint8_t *data, size_t size);
+} bench_input_t;
+
+/* Output mode, the switches passed to the disassembler */
+typedef struct bench_mode_s {
+    const char   *name;
+    const char   *args[4];
+    dcc6502_cpu_e cpu;
+} bench_mode_t;
+
+/* Result of a case, name and ns_per_insn are also the line format of the
+   baseline file */
+typedef struct result_s {
+    char                 name[64];     /* input/mode */
+    double               ns_per_insn;
+    double               baseline;     /* ns/instruction of the baseline, 0 without */
+    double               per_insn;     /* 1e9 / instructions of the input */
+    long                 max_kb;
+    const bench_input_t *input;
+    const bench_mode_t  *mode;
+} result_t;
+
+typedef struct options_s {        //Default Description
+    const char   *program;        /* ./dcc6502 disassembler to measure */
+    const char   *baseline;       /*   NULL baseline compared with */
+    const char   *record;         /*   NULL baseline written with this run */
+    unsigned long size;           /*   4 MB bytes of each generated input */
+    int           runs;           /*      7 runs of each case */
+    int           threshold;      /*     20 percent slower than the baseline that fails */
+} options_t;
+
+/* Deterministic generator, the inputs are the same on every machine */
+static uint32_t g_seed;
+
+static uint32_t next_random(void) {
+    g_seed = g_seed * 1664525u + 1013904223u;
+    return g_seed >> 8;
+}
+
+static void generate_random(uint8_t *data, size_t size) {
+    size_t i;
+
+    for (i = 0; i < size; i++)
+        data[i] = (uint8_t)next_random();
+}
+
+static void generate_nop(uint8_t *data, size_t size) {
+    memset(data, 0xEA, size);
+}
+
+/* Conditional branches with CMP, DEX and INY between them */
+static void generate_branches(uint8_t *data, size_t size) {
+    static const uint8_t branches[] = { 0x10, 0x30, 0x50, 0x70, 0x90, 0xB0, 0xD0, 0xF0 };
+    static const uint8_t others[]   = { 0xC9, 0xCA, 0xC8 };
+    size_t               i;
+
+    for (i = 0; i + 1 < size; i += 2) {
+        if (next_random() & 1) {
+            data[i]     = branches[next_random() % sizeof(branches)];
+            data[i + 1] = (uint8_t)next_random();
+        } else {
+            data[i]     = others[next_random() % sizeof(others)];
+            data[i + 1] = 0xEA; // CMP operand, or a NOP after the implied ones
+        }
+    }
+    if (i < size)
+        data[i] = 0xEA;
+}
+
+/* Common instructions with plausible operands, and a data table now and then */
+static void generate_rom(uint8_t *data, size_t size) {
+    static const uint8_t common[] = {
+        0xA9, 0xA5, 0xAD, 0xBD, 0xB9, 0xB1, 0x85, 0x8D, 0x9D, 0x99, 0x91, 0xA2, 0xA0, 0x86, 0x84,
+        0x20, 0x60, 0x4C, 0xD0, 0xF0, 0x90, 0xB0, 0x10, 0x30, 0xE8, 0xC8, 0xCA, 0x88, 0x18, 0x38,
+        0x69, 0xE9, 0xC9, 0xE0, 0xC0, 0x29, 0x09, 0x49, 0x0A, 0x4A, 0xE6, 0xC6, 0x48, 0x68, 0xAA
+    };
+    dcc6502_t dcc;
+    size_t    i = 0, n, length;
+    uint8_t   opcode;
+
+    dcc6502_init(&dcc, DCC6502_CPU_6502);
+    while (i < size) {
+        if (0 == (next_random() % 64)) {
+            for (n = 8 + next_random() % 56; n && (i < size); n--)
+                data[i++] = (uint8_t)next_random();
+            continue;
+        }
+
+        opcode = common[next_random() % sizeof(common)];
+        length = dcc6502_addressing(dcc.table[opcode].addressing)->length;
+        data[i++] = opcode;
+        if ((length > 1) && (i < size))
+            data[i++] = (uint8_t)next_random();
+        if ((length > 2) && (i < size))
+            data[i++] = 0x80 + (uint8_t)(next_random() % 0x80); // Addresses in ROM
+    }
+}
+
+static const bench_input_t g_inputs[] = {
+    { "random",   generate_random   },
+    { "nop",      generate_nop      },
+    { "branches", generate_branches },
+    { "rom",      generate_rom      },
+    { NULL,       NULL              }
+};
+
+static const bench_mode_t g_modes[] = {
+    { "plain",  { NULL              }, DCC6502_CPU_6502  },
+    { "apple",  { "-a", NULL        }, DCC6502_CPU_6502  },
+    { "hex",    { "-d", NULL        }, DCC6502_CPU_6502  },
+    { "cycles", { "-c", NULL        }, DCC6502_CPU_6502  },
+    { "nes",    { "-n", NULL        }, DCC6502_CPU_6502  },
+    { "asm",    { "-s", NULL        }, DCC6502_CPU_6502  },
+    { "65c02",  { "-2", NULL        }, DCC6502_CPU_65C02 },
+    { "all",    { "-d", "-c", "-n", NULL }, DCC6502_CPU_6502 },
+    { NULL,     { NULL              }, DCC6502_CPU_6502  }
+};
+
+static int count_instruction(const dcc6502_insn_t *insn, void *user) {
+    (void)insn;
+    (*(unsigned long *)user)++;
+    return 0;
+}
+
+static int compare_seconds(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void usage_and_exit(int exit_code, const char *message) {
+    fprintf(stderr,
+"Usage: bench [options]\n"
+"  -b BASELINE  : Fail when a case is slower than its BASELINE ns/instruction by more than -t\n"
+"  -n BYTES     : Size of each generated input [default: 4 MB]\n"
+"  -p PROGRAM   : Disassembler to measure [default: ./dcc6502]\n"
+"  -r RUNS      : Runs of each case, the median CPU time counts [default: 7]\n"
+"  -t PERCENT   : Failure threshold of -b [default: 20]\n"
+"  -w BASELINE  : Write the results of this run to BASELINE\n"
+    );
+    if (message)
+        fprintf(stderr, "%s\n", message);
+    exit(exit_code);
+}
+
+static void parse_args(int argc, char *argv[], options_t *options) {
+    int arg_idx;
+
+    options->program   = "./dcc6502";
+    options->baseline  = NULL;
+    options->record    = NULL;
+    options->size      = BENCH_SIZE;
+    options->runs      = BENCH_RUNS;
+    options->threshold = BENCH_THRESHOLD;
+
+    for (arg_idx = 1; arg_idx < argc; arg_idx++) {
+        if ((argv[arg_idx][0] != '-') || (argv[arg_idx][1] == '\0') || (argv[arg_idx][2] != '\0'))
+            usage_and_exit(1, "Unrecognized argument");
+        if (arg_idx == (argc - 1))
+            usage_and_exit(1, "Missing argument to switch");
+
+        switch (argv[arg_idx++][1]) {
+            case 'b': options->baseline  = argv[arg_idx];                     break;
+            case 'n': options->size      = strtoul(argv[arg_idx], NULL, 0);   break;
+            case 'p': options->program   = argv[arg_idx];                     break;
+            case 'r': options->runs      = atoi(argv[arg_idx]);               break;
+            case 't': options->threshold = atoi(argv[arg_idx]);               break;
+            case 'w': options->record    = argv[arg_idx];                     break;
+            default:  usage_and_exit(1, "Unrecognized switch");
+        }
+    }
+    if ((0 == options->size) || (options->runs < 1))
+        usage_and_exit(1, "Size and runs must be positive");
+}
+
+/* This function runs the disassembler once on an input, its listing going
+   to /dev/null. Returns the user and system CPU time of the process in
+   seconds, which unlike the wall time does not count the time other
+   processes hold the CPU, and its peak resident set size in KB in *peak_kb,
+   or a negative time on failure */
+static double run_case(options_t *options, const bench_mode_t *mode, const char *path, long *peak_kb) {
+    const char   *argv[8];
+    struct rusage usage;
+    pid_t         pid;
+    int           status, argc = 0, i, fd;
+
+    argv[argc++] = options->program;
+    for (i = 0; mode->args[i]; i++)
+        argv[argc++] = mode->args[i];
+    argv[argc++] = path;
+    argv[argc]   = NULL;
+
+    pid = fork();
+    if (0 == pid) {
+        fd = open("/dev/null", O_WRONLY);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        execv(options->program, (char *const *)argv);
+        _exit(127);
+    }
+    if ((pid < 0) || (wait4(pid, &status, 0, &usage) != pid))
+        return -1.0;
+    if (!WIFEXITED(status) || WEXITSTATUS(status))
+        return -1.0;
+    *peak_kb = usage.ru_maxrss;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+}
+
+/* This function runs a case options->runs times, seconds holding as many
+   entries. Returns the median CPU time, a single run even the fastest being
+   at the mercy of the rest of the machine, and the largest peak resident set
+   size in *max_kb, or a negative time on failure */
+static double measure_case(options_t *options, const bench_mode_t *mode, const char *path, double *seconds, long *max_kb) {
+    long peak_kb;
+    int  run;
+
+    *max_kb = 0;
+    for (run = 0; run < options->runs; run++) {
+        seconds[run] = run_case(options, mode, path, &peak_kb);
+        if (seconds[run] < 0.0)
+            return -1.0;
+        if (peak_kb > *max_kb)
+            *max_kb = peak_kb;
+    }
+    qsort(seconds, options->runs, sizeof(*seconds), compare_seconds);
+    return (seconds[(options->runs - 1) / 2] + seconds[options->runs / 2]) / 2.0;
+}
+
+/* This function measures a case into result, seconds holding options->runs
+   entries. A slower median than the one already in result is dropped when
+   keep_fastest is set. Returns 0, or -1 on failure */
+static int measure_result(options_t *options, result_t *result, double *seconds, int keep_fastest) {
+    char   path[256];
+    double median;
+    long   max_kb;
+
+    snprintf(path, sizeof(path), "%s/%s.bin", BENCH_DIR, result->input->name);
+    median = measure_case(options, result->mode, path, seconds, &max_kb);
+    if (median < 0.0) {
+        fprintf(stderr, "Could not run %s\n", options->program);
+        return -1;
+    }
+    if (!keep_fastest || (median * result->per_insn < result->ns_per_insn)) {
+        result->ns_per_insn = median * result->per_insn;
+        result->max_kb      = max_kb;
+    }
+    return 0;
+}
+
+/* This function returns 1 when a result is more than the threshold slower
+   than its baseline, else 0 */
+static int is_slow(options_t *options, const result_t *result) {
+    return (result->baseline > 0.0) && (result->ns_per_insn > result->baseline * (100 + options->threshold) / 100.0);
+}
+
+/* This function prints a result, with mark when it is slow. Returns
+   is_slow() */
+static int print_result(options_t *options, const result_t *result, const char *mark) {
+    int slow = is_slow(options, result);
+
+    printf("%-18s %10.2f %10.2f %10ld", result->name,
+        options->size * result->per_insn / (result->ns_per_insn * 1024.0 * 1024.0), result->ns_per_insn, result->max_kb);
+    if (result->baseline > 0.0)
+        printf("  baseline %8.2f%s%s", result->baseline, slow ? "  " : "", slow ? mark : "");
+    printf("\n");
+    return slow;
+}
+
+/* This function reads a baseline file: lines of input/mode and ns/instruction */
+static int read_baseline(const char *path, result_t *baseline) {
+    FILE *file;
+    int   count = 0;
+
+    file = fopen(path, "r");
+    if (NULL == file)
+        return -1;
+    while ((count < MAX_BASELINE) && (2 == fscanf(file, "%63s %lf", baseline[count].name, &baseline[count].ns_per_insn)))
+        count++;
+    fclose(file);
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    options_t      options;
+    result_t       results[MAX_BASELINE], baseline[MAX_BASELINE];
+    const bench_input_t *input;
+    const bench_mode_t *mode;
+    dcc6502_t      dcc;
+    uint8_t       *data;
+    char           path[256];
+    FILE          *file;
+    double        *seconds;
+    unsigned long  num_instructions;
+    int            num_results = 0, num_baseline = 0, num_slow = 0, retry, i;
+
+    parse_args(argc, argv, &options);
+
+    if (NULL != options.baseline) {
+        num_baseline = read_baseline(options.baseline, baseline);
+        if (num_baseline < 0) {
+            fprintf(stderr, ";WARNING: No baseline %s, write one with -w (make bench-baseline)\n", options.baseline);
+            num_baseline = 0;
+        }
+    }
+
+    data    = malloc(options.size);
+    seconds = malloc(options.runs * sizeof(*seconds));
+    if ((NULL == data) || (NULL == seconds))
+        usage_and_exit(3, "Could not allocate input buffer.");
+    mkdir(BENCH_DIR, 0777);
+
+    printf("%-18s %10s %10s %10s\n", "case", "MB/s", "ns/insn", "peak KB");
+    for (input = g_inputs; input->name; input++) {
+        g_seed = 6502;
+        input->generate(data, options.size);
+
+        snprintf(path, sizeof(path), "%s/%s.bin", BENCH_DIR, input->name);
+        file = fopen(path, "wb");
+        if ((NULL == file) || (1 != fwrite(data, options.size, 1, file)) || fclose(file))
+            usage_and_exit(2, "Could not write the inputs");
+
+        for (mode = g_modes; mode->name; mode++) {
+            result_t *result = &results[num_results++];
+
+            num_instructions = 0;
+            dcc6502_init(&dcc, mode->cpu);
+            dcc6502_disassemble(&dcc, data, options.size, 0x8000, count_instruction, &num_instructions);
+
+            snprintf(result->name, sizeof(result->name), "%s/%s", input->name, mode->name);
+            result->per_insn = 1e9 / (num_instructions ? num_instructions : 1);
+            result->input    = input;
+            result->mode     = mode;
+            result->baseline = 0.0;
+            for (i = 0; i < num_baseline; i++) {
+                if (!strcmp(baseline[i].name, result->name))
+                    result->baseline = baseline[i].ns_per_insn;
+            }
+
+            if (measure_result(&options, result, seconds, 0))
+                return 2;
+            num_slow += print_result(&options, result, "SLOW");
+        }
+    }
+
+    /* The cases over the threshold are measured again once all have run,
+       away from the slowdown of the machine that may have hit them, and
+       their fastest median counts */
+    for (retry = 0; num_slow && (retry < BENCH_RETRIES); retry++) {
+        printf("Measuring again the %d cases over the threshold\n", num_slow);
+        num_slow = 0;
+        for (i = 0; i < num_results; i++) {
+            if (!is_slow(&options, &results[i]))
+                continue;
+            if (measure_result(&options, &results[i], seconds, 1))
+                return 2;
+            num_slow += print_result(&options, &results[i], (retry + 1 < BENCH_RETRIES) ? "SLOW" : "REGRESSION");
+        }
+    }
+    free(seconds);
+    free(data);
+
+    if (NULL != options.record) {
+        file = fopen(options.record, "w");
+        if (NULL == file)
+            usage_and_exit(2, "Could not write the baseline");
+        for (i = 0; i < num_results; i++)
+            fprintf(file, "%s %.3f\n", results[i].name, results[i].ns_per_insn);
+        fclose(file);
+        printf("Baseline written to %s\n", options.record);
+    }
+
+    if (num_slow) {
+        printf("%d cases more than %d%% slower than the baseline\n", num_slow, options.threshold);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+/**********************************************************************************
+ * check.c -> Opcode table check of:                                              *
+ * Disassembler and Cycle Counter for the 6502 microprocessor                     *
+ *                                                                                *
+ * This code is offered under the MIT License (MIT)                               *
+ *                                                                                *
+ * Copyright (c) 1998-2014 Tennessee Carmel-Veilleux <veilleux@tentech.ca>        *
+ * Copyright (c) 2017      Michael Pohoreski <michaelangel007@sharedcraft.com>    *
+ *                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ * of this software and associated documentation files (the "Software"), to deal  *
+ * in the Software without restriction, including without limitation the rights   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ * copies of the Software, and to permit persons to whom the Software is          *
+ * furnished to do so, subject to the following conditions:                       *
+ *                                                                                *
+ * The above copyright notice and this permission notice shall be included in all *
+ * copies or substantial portions of the Software.                                *
+ *                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ * SOFTWARE.                                                                      *
+ **********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "dcc6502.h"
+
+/* Each instruction set is described as in its datasheet, independently of
+   the opcode tables of libdcc6502: per opcode row, the instruction length
+   (0 for the opcodes decoded as .byte) and the base cycles, in base 36 so
+   that the 17 cycles of the HuC6280 block transfers fit in one digit. Block
+   transfers are decoded with a length operand of 1 */
+typedef struct datasheet_s {
+    const char   *name;
+    dcc6502_cpu_e cpu;
+    unsigned int  p;             /* Register widths to decode with */
+    const char   *lengths[16];
+    const char   *cycles[16];
+    const char   *page;          /* Opcodes with +1 cycle when the index crosses a page */
+    const char   *branches;      /* Conditional branches */
+    unsigned int  taken;         /* Cycles of a taken branch */
+    const char   *wide;          /* 65816 immediates with a 16-bit operand when M or X is clear */
+} datasheet_t;
+
+#define NMOS_PAGE "11 19 1D 31 39 3D 51 59 5D 71 79 7D B1 B9 BC BD BE D1 D9 DD F1 F9 FD"
+#define BRANCHES  "10 30 50 70 90 B0 D0 F0"
+#define BIT_BRANCHES BRANCHES " 0F 1F 2F 3F 4F 5F 6F 7F 8F 9F AF BF CF DF EF FF"
+
+static const datasheet_t g_datasheets[] = {
+    { "6502", DCC6502_CPU_6502, DCC6502_P_RESET,
+      { "1200022012100330", "2200022013000330", "3200222012103330", "2200022013000330",
+        "1200022012103330", "2200022013000330", "1200022012103330", "2200022013000330",
+        "0200222010103330", "2200222013100300", "2220222012103330", "2200222013103330",
+        "2200222012103330", "2200022013000330", "2200222012103330", "2200022013000330" },
+      { "7600035032200460", "2500046024000470", "6600335042204460", "2500046024000470",
+        "6600035032203460", "2500046024000470", "6600035042205460", "2500046024000470",
+        "0600333020204440", "2600444025200500", "2620333022204440", "2500444024204440",
+        "2600335022204460", "2500046024000470", "2600335022204460", "2500046024000470" },
+      NMOS_PAGE, BRANCHES, 1, "" },
+    { "6502 undocumented", DCC6502_CPU_6502_UNDOC, DCC6502_P_RESET,
+      { "1202222212123333", "2202222213133333", "3202222212123333", "2202222213133333",
+        "1202222212123333", "2202222213133333", "1202222212123333", "2202222213133333",
+        "2222222212103333", "2200222213100300", "2222222212103333", "2202222213103333",
+        "2222222212123333", "2202222213133333", "2222222212123333", "2202222213133333" },
+      { "7608335532224466", "2508446624274477", "6608335542224466", "2508446624274477",
+        "6608335532223466", "2508446624274477", "6608335542225466", "2508446624274477",
+        "2626333322204444", "2600444425200500", "2626333322204444", "2505444424204444",
+        "2628335522224466", "2508446624274477", "2628335522224466", "2508446624274477" },
+      NMOS_PAGE " B3 BF 1C 3C 5C 7C DC FC", BRANCHES, 1, "" },
+    { "65C02", DCC6502_CPU_65C02, DCC6502_P_RESET,
+      { "1220222212103333", "2220222213103333", "3220222212103333", "2220222213103333",
+        "1220222212103333", "2220222213103333", "1220222212103333", "2220222213103333",
+        "2220222212103333", "2220222213103333", "2220222212103333", "2220222213103333",
+        "2220222212113333", "2220222213113333", "2220222212103333", "2220222213103333" },
+      { "7620535532206465", "2550546524206465", "6620335542204465", "2550446524204465",
+        "6620335532203465", "2550446524308465", "6620335542206465", "2550446524406465",
+        "3620333522204445", "2650444525204555", "2620333522204445", "2550444524204445",
+        "2620335522234465", "2550446524334475", "2620335522204465", "2550446524404475" },
+      NMOS_PAGE " 1E 3C 3E 5E 7E", BIT_BRANCHES, 1, "" },
+    { "65816", DCC6502_CPU_65816, DCC6502_P_M | DCC6502_P_X,
+      { "2222222212113334", "2222222213113334", "3242222212113334", "2222222213113334",
+        "1222322212113334", "2222322213114334", "1232222212113334", "2222222213113334",
+        "2232222212113334", "2222222213113334", "2222222212113334", "2222222213113334",
+        "2222222212113334", "2222222213113334", "2222222212113334", "2222322213113334" },
+      { "8684535632246465", "2557546624226475", "6684335642254465", "2557446624224475",
+        "7624735632233465", "2557746624324475", "6664335642265465", "2557446624426475",
+        "3644333622234445", "2657444625224555", "2624333622244445", "2557444624224445",
+        "2634335622234465", "2557646624336475", "2634335622234465", "2557546624428475" },
+      NMOS_PAGE " 3C", BRANCHES, 1, "09 29 49 69 89 A9 C9 E9 A0 A2 C0 E0" },
+    { "HuC6280", DCC6502_CPU_HUC6280, DCC6502_P_RESET,
+      { "1212222212103333", "2222222213103333", "3212222212103333", "2220222213103333",
+        "1212222212103333", "2222122213100333", "1210222212103333", "2227222213103333",
+        "2213222212103333", "2224222213103333", "2223222212103333", "2224222213103333",
+        "2217222212103333", "2227122213100333", "2207222212103333", "2227122213100333" },
+      { "8734646732207576", "2774646725207576", "7734446742205576", "2770446725205576",
+        "7734846732204576", "2775346725300576", "7720446742207576", "277H446725407576",
+        "4727444722205556", "2778444725205556", "2727444722205556", "2778444725205556",
+        "272H446722205576", "277H346725300576", "270H446722205576", "277H246725400576" },
+      "", BIT_BRANCHES, 2, "" }
+};
+
+/* This function returns whether opcode is in the list of hex bytes */
+static int in_list(const char *list, unsigned int opcode) {
+    char *end;
+
+    while (*list) {
+        if (strtoul(list, &end, 16) == opcode)
+            return 1;
+        list = end;
+    }
+    return 0;
+}
+
+/* This function decodes every opcode of the instruction set of sheet, and
+   reports each difference with its datasheet. Returns the number of
+   differences */
+static int check_datasheet(const datasheet_t *sheet) {
+    uint8_t        code[MAX_INSTRUCTION_LENGTH] = { 0 };
+    dcc6502_t      dcc;
+    dcc6502_insn_t insn;
+    unsigned int   opcode, length, cycles, extra;
+    int            errors = 0;
+
+    dcc6502_init(&dcc, sheet->cpu);
+    code[5] = 1;
+
+    for (opcode = 0; opcode < NUMBER_OPCODES; opcode++) {
+        code[0] = opcode;
+        length  = sheet->lengths[opcode >> 4][opcode & 0xf] - '0';
+        cycles  = strtoul((char[]){ sheet->cycles[opcode >> 4][opcode & 0xf], '\0' }, NULL, 36);
+        if (7 == length)
+            cycles += DCC6502_BLOCK_CYCLES;
+        extra = in_list(sheet->branches, opcode) ? sheet->taken : in_list(sheet->page, opcode) ? 1 : 0;
+
+        dcc6502_decode_p(&dcc, code, sizeof(code), 0x8000, sheet->p, &insn);
+        if (0 == length) {
+            if (!(insn.flags & BAD) || (1 != insn.length)) {
+                printf("%s $%02X: decoded as %s, expected .byte\n", sheet->name, opcode, dcc6502_mnemonic(insn.mnemonic));
+                errors++;
+            }
+            continue;
+        }
+        if ((insn.flags & BAD) || (insn.length != length) || (insn.cycles_min != cycles) ||
+            (insn.cycles_max != cycles + extra)) {
+            printf("%s $%02X %s: %s, length %u, cycles %u/%u, expected length %u, cycles %u/%u\n",
+                   sheet->name, opcode, dcc6502_mnemonic(insn.mnemonic), (insn.flags & BAD) ? ".byte" : "valid",
+                   (unsigned int)insn.length, (unsigned int)insn.cycles_min, (unsigned int)insn.cycles_max,
+                   length, cycles, cycles + extra);
+            errors++;
+        }
+
+        // 16-bit registers widen the 65816 immediates
+        if (!*sheet->wide)
+            continue;
+        dcc6502_decode_p(&dcc, code, sizeof(code), 0x8000, 0, &insn);
+        if (insn.length != length + (in_list(sheet->wide, opcode) ? 1 : 0)) {
+            printf("%s $%02X %s: length %u with 16-bit registers\n", sheet->name, opcode,
+                   dcc6502_mnemonic(insn.mnemonic), (unsigned int)insn.length);
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int main(void) {
+    size_t i;
+    int    errors = 0;
+
+    for (i = 0; i < sizeof(g_datasheets) / sizeof(g_datasheets[0]); i++)
+        errors += check_datasheet(&g_datasheets[i]);
+
+    if (errors) {
+        printf("check: %d opcodes differ from the datasheets\n", errors);
+        return 1;
+    }
+    printf("check: the %d opcodes of %d instruction sets match their datasheets\n",
+           (int)(NUMBER_OPCODES * i), (int)i);
+    return 0;
+}
@@ -31,48 +31,126 @@
 #include <stdint.h>
 #include <ctype.h>
 #include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "dcc6502.h"
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define HAVE_POSIX 1 /* mmap, threads, directory walks and sockets */
+#else
+#define HAVE_POSIX 0
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#include <immintrin.h>
+#define HAVE_SIMD 1 /* SSE2 pattern search, AVX2 when the CPU has it */
+#else
+#define HAVE_SIMD 0
+#endif
+
+#if HAVE_POSIX
+typedef pthread_mutex_t lock_t;
+#define LOCK_INIT(lock)    pthread_mutex_init(lock, NULL)
+#define LOCK_DESTROY(lock) pthread_mutex_destroy(lock)
+#define LOCK(lock)         pthread_mutex_lock(lock)
+#define UNLOCK(lock)       pthread_mutex_unlock(lock)
+#else
+typedef int lock_t; /* Single threaded */
+#define LOCK_INIT(lock)    ((void)(lock))
+#define LOCK_DESTROY(lock) ((void)(lock))
+#define LOCK(lock)         ((void)(lock))
+#define UNLOCK(lock)       ((void)(lock))
+#endif
 
 #define AUTHOR "Michael Pohoreski <michaelangel007@sharedcraft.com>"
 #define GIT_LOCATION "https://github.com/Michaelangel007/dcc6502"
 #define FORK_LOCATION "https://github.com/tcarmelveilleux/dcc6502"
 #define VERSION_INFO "v2.5"
-#define NUMBER_OPCODES 256
-
-/* Exceptions for cycle counting */
-#define CYCLE_PAGE      (1 << 0) // Cross page boundary, +1 cycle
-#define CYCLE_BRANCH    (1 << 1) // Branch taken, +1 cycle
-#define _65C02          (1 << 2) // 65C02 only instruction
-#define BAD             (1 << 3) // Illegal 6502 instruction
-#define CYCLE_MASK      (CYCLE_PAGE | CYCLE_BRANCH)
-
-/* The 6502's 13 addressing modes */
-typedef enum {
-    IMMED = 0, /* Immediate */
-    ABSOL,     /* Absolute */
-    ZEROP,     /* Zero Page */
-    IMPLI,     /* Implied */
-    INDIA,     /* Indirect Absolute */
-    ABSIX,     /* Absolute indexed with X */
-    ABSIY,     /* Absolute indexed with Y */
-    ZEPIX,     /* Zero page indexed with X */
-    ZEPIY,     /* Zero page indexed with Y */
-    INDIN,     /* Indexed indirect (with X) */
-    ININD,     /* Indirect indexed (with Y) */
-    RELAT,     /* Relative */
-    ACCUM      /* Accumulator */
-} addressing_mode_e;
+#define UNKNOWN_SIZE ((unsigned long)-1)
+#define MAX_THREADS 64
+#define MAX_ENTRY_POINTS 64
+#define DATA_BYTES_PER_LINE 8
+#define PARALLEL_CHUNK_SIZE     (1 << 18) /* Input bytes formatted per thread and round */
+#define PARALLEL_MIN_CHUNK_SIZE (1 << 12)
+#define LISTING_SUFFIX ".asm"
+#define CACHE_SUFFIX ".lst"
+#define CACHE_DEFAULT_SIZE (256ul << 20)
+#define LISTING_VERSION 2 /* Bump whenever the listing body changes for the same options */
+#define INDEX_MAGIC "DCIX"
+#define INDEX_VERSION 1
+#define INDEX_HEADER_SIZE 24
+#define NO_LINE ((uint32_t)-1)
+#define MAX_PATTERN_LENGTH 64
+#define NGRAM_MAGIC "DCNX"
+#define NGRAM_VERSION 1
+#define NGRAM_HEADER_SIZE 24
+#define NGRAM_LENGTH 3      /* Instructions per n-gram */
+#define NGRAM_SHAPE_BITS 14 /* Mnemonic id and addressing mode of one instruction */
+#define NGRAM_FILE_BITS 22  /* File id, below the n-gram in the sorted pairs */
+#define DIFF_LCS_LIMIT (1ul << 22) /* Largest gap, in instruction pairs, aligned by dynamic programming */
+#define CPU_MAGIC "DCPU"
+#define CPU_VERSION 3
+#define CPU_HEADER_SIZE 32
+#define CPU_SUFFIX ".tbl"
+#define CPU_MNEMONIC_SIZE 5 /* Up to 4 characters and the NUL */
 
 /** Some compilers don't have EOK in errno.h */
 #ifndef EOK
 #define EOK 0
 #endif
 
-typedef struct opcode_s {
-    const char       *mnemonic;          /* Index in the name table */
-    addressing_mode_e addressing;        /* Addressing mode */
-    unsigned int      cycles;            /* Number of cycles */
-    unsigned int      cycles_exceptions; /* Mask of cycle-counting exceptions */
-} opcode_t;
+/* Flags of a decode template */
+#define TEMPLATE_INVALID  (1 << 0) // Illegal opcode, text holds the rest of the line
+#define TEMPLATE_RELATIVE (1 << 1) // Operand digits are the branch target
+#define TEMPLATE_NES      (1 << 2) // Operand is an absolute address, eligible for NES annotation
+#define TEMPLATE_STOP     (1 << 3) // Execution does not fall through to the next instruction
+#define TEMPLATE_JUMP     (1 << 4) // Operand is the absolute address of code (JMP, JSR)
+#define TEMPLATE_ADDRESS  (1 << 5) // Operand is a memory address, eligible for a label
+#define TEMPLATE_CALL     (1 << 6) // Operand is the address of a subroutine (JSR)
+#define TEMPLATE_FORMAT   (1 << 7) // Several operands, formatted by the decoder (TII, TST)
+
+#define TEMPLATE_TEXT_SIZE   40
+#define TEMPLATE_CYCLES_SIZE 16
+
+/* Decode template, expanded from the opcode table at startup */
+typedef struct template_s {
+    char     text[TEMPLATE_TEXT_SIZE];        /* Padded mnemonic column and ';', operand digits patched in */
+    char     cycles[2][TEMPLATE_CYCLES_SIZE]; /* Cycle annotation, [1] when the branch crosses a page */
+    uint8_t  cycles_len[2];                   /* Length of the cycle annotations */
+    uint8_t  text_len;                        /* Number of characters of text to emit */
+    uint8_t  repr_len;                        /* Length of the mnemonic and operand, without padding */
+    uint8_t  length;                          /* Instruction length in bytes */
+    uint8_t  slot;                            /* Offset of the operand digits in text */
+    uint8_t  zp_slot;                         /* Offset of the zero page digits of ZEREL, 0 if none */
+    uint8_t  digits;                          /* Number of operand hex digits: 0, 2 or 4 */
+    uint8_t  flags;                           /* Mask of TEMPLATE_* */
+} template_t;
+
+/* Address column template for one instruction length */
+typedef struct column_s {
+    char     text[32];     /* Address and hex dump column, digits patched in */
+    uint8_t  len;          /* Column width */
+    int8_t   addr_slot;    /* Offset of the address digits, -1 if omitted */
+    int8_t   byte_slot[MAX_INSTRUCTION_LENGTH]; /* Offset of each instruction byte, -1 if omitted */
+} column_t;
+
+/* Output formats */
+typedef enum {
+    FORMAT_TEXT = 0, /* Assembly listing */
+    FORMAT_BIN,      /* Fixed-width binary records, see dcc6502.h */
+    FORMAT_JSONL,    /* One JSON object per line */
+    FORMAT_CSV       /* Comma separated values, with a header line */
+} format_e;
 
 typedef struct options_s {        //Default Description
     char         *filename;       /*    n/a binary input filename */
@@ -82,859 +160,717 @@ typedef struct options_s {        //Default Description
     int           nes_mode;       /*      0 if NES commenting and warnings are enabled */
     int           omit_opcodes;   /*      0 if address and opcodes should be skipped (left blank) == clean assembly style */
     int           user_length;    /*      0 if user requested custom (file) length */
-    uint16_t      org;            /*   8000 origin of (disassembly) addresses */
-    unsigned long max_num_bytes;  /*  10000 maximum number of bytes to read from binary file */
+    uint32_t      org;            /*   8000 origin of (disassembly) addresses, 24-bit for the 65816 */
+    unsigned long max_num_bytes;  /*    all maximum number of bytes to read from binary file */
     unsigned long start_offset;   /*      0 starting offset to read from binary file */
+    unsigned long bank_size;      /*      0 if addresses restart at org every bank_size bytes */
+    char        **filenames;      /*    n/a all input filenames, filename is the first */
+    int           num_files;      /*    n/a number of input filenames */
+    char         *manifest;       /*   NULL file listing more input filenames */
+    char         *output_dir;     /*   NULL directory of batch listings, NULL to write next to each input */
+    int           num_threads;    /*      1 number of worker threads */
+    int           batch;          /*      0 if each input gets its own listing file */
+    int           recursive;      /*      0 if code is found by following control flow, the rest is data */
+    int           num_entry_points; /*    0 number of user provided entry points */
+    uint16_t      entry_points[MAX_ENTRY_POINTS]; /* user provided entry points of the recursive descent */
+    int           labels;         /*      0 if referenced addresses get generated labels */
+    int           xref;           /*      0 if each label is preceded by its cross-references */
+    int           timing;         /*      0 if each basic block is preceded by its cycle budget */
+    int           image;          /*      0 if the input is disassembled as one 64K image (-r, -l, -t) */
+    dcc6502_cpu_e cpu;            /*   6502 instruction set */
+    char         *cpu_path;       /*   NULL CPU definition file replacing the built-in instruction sets */
+    format_e      format;         /*   text output format */
+    char         *socket_path;    /*   NULL Unix socket served by the daemon mode */
+    char         *cache_dir;      /*   NULL directory of the result cache, NULL to disable it */
+    char         *index_path;     /*   NULL instruction index of the previous run, for incremental runs */
+    char         *diff_path;      /*   NULL old image FILENAME is compared with, NULL to disassemble it */
+    char         *pattern;        /*   NULL instruction pattern searched for, NULL to disassemble */
+    char         *ngram_output;   /*   NULL n-gram index written from the files, NULL to disassemble them */
+    char         *ngram_index;    /*   NULL n-gram index queried with the pattern, NULL to search files */
+    int           stats;          /*      0 if instructions are only counted, one JSON summary per file */
+    unsigned long cache_size;     /*  256MB size bound of the result cache, oldest entries are evicted */
 } options_t;
 
-/* Opcode table */
-static opcode_t g_6502_opcodes[NUMBER_OPCODES] = {
-    {"BRK", IMPLI, 7, 0                        }, /* 00 BRK */
-    {"ORA", INDIN, 6, 0                        }, /* 01 ORA */
-    {"???", 0    , 2, BAD                      }, /* 02     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 03     illegal 6502 */
-    {"???", 0    , 3, BAD                      }, /* 04     illegal 6502 */
-    {"ORA", ZEROP, 3, 0                        }, /* 05 ORA */
-    {"ASL", ZEROP, 5, 0                        }, /* 06 ASL */
-    {"???", 0    , 5, BAD                      }, /* 07     illegal 6502 */
-    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
-    {"ORA", IMMED, 2, 0                        }, /* 09 ORA */
-    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
-    {"???", 0    , 2, BAD                      }, /* 0B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 0C     illegal 6502 */
-    {"ORA", ABSOL, 4, 0                        }, /* 0D ORA */
-    {"ASL", ABSOL, 6, 0                        }, /* 0E ASL */
-    {"???", 0    , 6, BAD                      }, /* 0F     illegal 6502 */
-    {"BPL", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 10 BPL */
-    {"ORA", ININD, 5, CYCLE_PAGE               }, /* 11 ORA */
-    {"???", 0    , 2, BAD                      }, /* 12     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 13     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 14     illegal 6502 */
-    {"ORA", ZEPIX, 4, 0                        }, /* 15 ORA */
-    {"ASL", ZEPIX, 6, 0                        }, /* 16 ASL */
-    {"???", 0    , 6, BAD                      }, /* 17     illegal 6502 */
-    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
-    {"ORA", ABSIY, 4, CYCLE_PAGE               }, /* 19 ORA */
-    {"???", 0    , 2, BAD                      }, /* 1A     illegal 6502 */
-    {"???", 0    , 7, BAD                      }, /* 1B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 1C     illegal 6502 */
-    {"ORA", ABSIX, 4, CYCLE_PAGE               }, /* 1D ORA */
-    {"ASL", ABSIX, 7, 0                        }, /* 1E ASL */
-    {"???", 0    , 7, BAD                      }, /* 1F     illegal 6502 */
-    {"JSR", ABSOL, 6, 0                        }, /* 20 JSR */
-    {"AND", INDIN, 6, 0                        }, /* 21 AND */
-    {"???", 0    , 2, BAD                      }, /* 22     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 23     illegal 6502 */
-    {"BIT", ZEROP, 3, 0                        }, /* 24 BIT */
-    {"AND", ZEROP, 3, 0                        }, /* 25 AND */
-    {"ROL", ZEROP, 5, 0                        }, /* 26 ROL */
-    {"???", 0    , 5, BAD                      }, /* 27     illegal 6502 */
-    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
-    {"AND", IMMED, 2, 0                        }, /* 29 AND */
-    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
-    {"???", 0    , 2, BAD                      }, /* 2B     illegal 6502 */
-    {"BIT", ABSOL, 4, 0                        }, /* 2C BIT */
-    {"AND", ABSOL, 4, 0                        }, /* 2D AND */
-    {"ROL", ABSOL, 6, 0                        }, /* 2E ROL */
-    {"???", 0    , 6, BAD                      }, /* 2F     illegal 6502 */
-    {"BMI", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 30 BMI */
-    {"AND", ININD, 5, CYCLE_PAGE               }, /* 31 AND */
-    {"???", 0    , 2, BAD                      }, /* 32     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 33     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 34     illegal 6502 */
-    {"AND", ZEPIX, 4, 0                        }, /* 35 AND */
-    {"ROL", ZEPIX, 6, 0                        }, /* 36 ROL */
-    {"???", 0    , 6, BAD                      }, /* 37     illegal 6502 */
-    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
-    {"AND", ABSIY, 4, CYCLE_PAGE               }, /* 39 AND */
-    {"???", 0    , 2, BAD                      }, /* 3A     illegal 6502 */
-    {"???", 0    , 7, BAD                      }, /* 3B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 3C     illegal 6502 */
-    {"AND", ABSIX, 4, CYCLE_PAGE               }, /* 3D AND */
-    {"ROL", ABSIX, 6, 0                        }, /* 3E ROL */
-    {"???", 0    , 7, BAD                      }, /* 3F     illegal 6502 */
-    {"RTI", IMPLI, 6, 0                        }, /* 40 RTI */
-    {"EOR", INDIN, 6, 1                        }, /* 41 EOR */
-    {"???", 0    , 2, BAD                      }, /* 42     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 43     illegal 6502 */
-    {"???", 0    , 3, BAD                      }, /* 44     illegal 6502 */
-    {"EOR", ZEROP, 3, 0                        }, /* 45 EOR */
-    {"LSR", ZEROP, 5, 0                        }, /* 46 LSR */
-    {"???", 0    , 5, BAD                      }, /* 47     illegal 6502 */
-    {"PHA", IMPLI, 3, 0                        }, /* 48 PHA */
-    {"EOR", IMMED, 2, 0                        }, /* 49 EOR */
-    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
-    {"???", 0    , 2, BAD                      }, /* 4B     illegal 6502 */
-    {"JMP", ABSOL, 3, 0                        }, /* 4C JMP */
-    {"EOR", ABSOL, 4, 0                        }, /* 4D EOR */
-    {"LSR", ABSOL, 6, 0                        }, /* 4E LSR */
-    {"???", 0    , 6, BAD                      }, /* 4F     illegal 6502 */
-    {"BVC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 50 BVC */
-    {"EOR", ININD, 5, CYCLE_PAGE               }, /* 51 EOR */
-    {"???", 0    , 2, BAD                      }, /* 52     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 53     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 54     illegal 6502 */
-    {"EOR", ZEPIX, 4, 0                        }, /* 55 EOR */
-    {"LSR", ZEPIX, 6, 0                        }, /* 56 LSR */
-    {"???", 0    , 6, BAD                      }, /* 57     illegal 6502 */
-    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
-    {"EOR", ABSIY, 4, CYCLE_PAGE               }, /* 59 EOR */
-    {"???", 0    , 2, BAD                      }, /* 5A     illegal 6502 */
-    {"???", 0    , 7, BAD                      }, /* 5B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 5C     illegal 6502 */
-    {"EOR", ABSIX, 4, CYCLE_PAGE               }, /* 5D EOR */
-    {"LSR", ABSIX, 6, 0                        }, /* 5E LSR */
-    {"???", 0    , 7, BAD                      }, /* 5F     illegal 6502 */
-    {"RTS", IMPLI, 6, 0                        }, /* 60 RTS */
-    {"ADC", INDIN, 6, 0                        }, /* 61 ADC */
-    {"???", 0    , 2, BAD                      }, /* 62     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 63     illegal 6502 */
-    {"???", 0    , 3, BAD                      }, /* 64     illegal 6502 */
-    {"ADC", ZEROP, 3, 0                        }, /* 65 ADC */
-    {"ROR", ZEROP, 5, 0                        }, /* 66 ROR */
-    {"???", 0    , 5, BAD                      }, /* 67     illegal 6502 */
-    {"PLA", IMPLI, 4, 0                        }, /* 68 PLA */
-    {"ADC", IMMED, 2, 0                        }, /* 69 ADC */
-    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
-    {"???", 0    , 2, BAD                      }, /* 6B     illegal 6502 */
-    {"JMP", INDIA, 5, 0                        }, /* 6C JMP */
-    {"ADC", ABSOL, 4, 0                        }, /* 6D ADC */
-    {"ROR", ABSOL, 6, 0                        }, /* 6E ROR */
-    {"???", 0    , 6, BAD                      }, /* 6F     illegal 6502 */
-    {"BVS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 70 BVS */
-    {"ADC", ININD, 5, CYCLE_PAGE               }, /* 71 ADC */
-    {"???", 0    , 2, BAD                      }, /* 72     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 73     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 74     illegal 6502 */
-    {"ADC", ZEPIX, 4, 0                        }, /* 75 ADC */
-    {"ROR", ZEPIX, 6, 0                        }, /* 76 ROR */
-    {"???", 0    , 6, BAD                      }, /* 77     illegal 6502 */
-    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
-    {"ADC", ABSIY, 4, CYCLE_PAGE               }, /* 79 ADC */
-    {"???", 0    , 2, BAD                      }, /* 7A     illegal 6502 */
-    {"???", 0    , 7, BAD                      }, /* 7B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 7C     illegal 6502 */
-    {"ADC", ABSIX, 4, CYCLE_PAGE               }, /* 7D ADC */
-    {"ROR", ABSIX, 6, 0                        }, /* 7E ROR */
-    {"???", 0    , 7, BAD                      }, /* 7F     illegal 6502 */
-    {"???", 0    , 2, BAD                      }, /* 80     illegal 6502 */
-    {"STA", INDIN, 6, 0                        }, /* 81 STA */
-    {"???", 0    , 2, BAD                      }, /* 82     illegal 6502 */
-    {"???", 0    , 6, BAD                      }, /* 83     illegal 6502 */
-    {"STY", ZEROP, 3, 0                        }, /* 84 STY */
-    {"STA", ZEROP, 3, 0                        }, /* 85 STA */
-    {"STX", ZEROP, 3, 0                        }, /* 86 STX */
-    {"???", 0    , 3, BAD                      }, /* 87     illegal 6502 */
-    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
-    {"???", 0    , 2, BAD                      }, /* 89     illegal 6502 */
-    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
-    {"???", 0    , 2, BAD                      }, /* 8B     illegal 6502 */
-    {"STY", ABSOL, 4, 0                        }, /* 8C STY */
-    {"STA", ABSOL, 4, 0                        }, /* 8D STA */
-    {"STX", ABSOL, 4, 0                        }, /* 8E STX */
-    {"???", 0    , 4, BAD                      }, /* 8F     illegal 6502 */
-    {"BCC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 90 BCC */
-    {"STA", ININD, 6, CYCLE_PAGE               }, /* 91 STA */
-    {"???", 0    , 2, BAD                      }, /* 92     illegal 6502 */
-    {"???", 0    , 6, BAD                      }, /* 93     illegal 6502 */
-    {"STY", ZEPIX, 4, 0                        }, /* 94 STY */
-    {"STA", ZEPIX, 4, 0                        }, /* 95 STA */
-    {"STX", ZEPIY, 4, 0                        }, /* 96 STX */
-    {"???", 0    , 4, BAD                      }, /* 97     illegal 6502 */
-    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
-    {"STA", ABSIY, 5, CYCLE_PAGE               }, /* 99 STA */
-    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
-    {"???", 0    , 5, BAD                      }, /* 9B     illegal 6502 */
-    {"???", 0    , 5, BAD                      }, /* 9C     illegal 6502 */
-    {"STA", ABSIX, 5, CYCLE_PAGE               }, /* 9D STA */
-    {"???", 0    , 5, BAD                      }, /* 9E     illegal 6502 */
-    {"???", 0    , 5, BAD                      }, /* 9F     illegal 6502 */
-    {"LDY", IMMED, 2, 0                        }, /* A0 LDY */
-    {"LDA", INDIN, 6, 0                        }, /* A1 LDA */
-    {"LDX", IMMED, 2, 0                        }, /* A2 LDX */
-    {"???", 0    , 6, BAD                      }, /* A3     illegal 6502 */
-    {"LDY", ZEROP, 3, 0                        }, /* A4 LDY */
-    {"LDA", ZEROP, 3, 0                        }, /* A5 LDA */
-    {"LDX", ZEROP, 3, 0                        }, /* A6 LDX */
-    {"???", 0    , 3, BAD                      }, /* A7     illegal 6502 */
-    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
-    {"LDA", IMMED, 2, 0                        }, /* A9 LDA */
-    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
-    {"???", 0    , 2, BAD                      }, /* AB     illegal 6502 */
-    {"LDY", ABSOL, 4, 0                        }, /* AC LDY */
-    {"LDA", ABSOL, 4, 0                        }, /* AD LDA */
-    {"LDX", ABSOL, 4, 0                        }, /* AE LDX */
-    {"???", 0    , 4, BAD                      }, /* AF     illegal 6502 */
-    {"BCS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* B0 BCS */
-    {"LDA", ININD, 5, CYCLE_PAGE               }, /* B1 LDA */
-    {"???", 0    , 2, BAD                      }, /* B2     illegal 6502 */
-    {"???", 0    , 5, BAD                      }, /* B3     illegal 6502 */
-    {"LDY", ZEPIX, 4, 0                        }, /* B4 LDY */
-    {"LDA", ZEPIX, 4, 0                        }, /* B5 LDA */
-    {"LDX", ZEPIY, 4, 0                        }, /* B6 LDX */
-    {"???", 0    , 4, BAD                      }, /* B7     illegal 6502 */
-    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
-    {"LDA", ABSIY, 4, CYCLE_PAGE               }, /* B9 LDA */
-    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
-    {"???", 0    , 4, BAD                      }, /* BB     illegal 6502 */
-    {"LDY", ABSIX, 4, CYCLE_PAGE               }, /* BC LDY */
-    {"LDA", ABSIX, 4, CYCLE_PAGE               }, /* BD LDA */
-    {"LDX", ABSIY, 4, CYCLE_PAGE               }, /* BE LDX */
-    {"???", 0    , 4, BAD                      }, /* BF     illegal 6502 */
-    {"CPY", IMMED, 2, 0                        }, /* C0 CPY */
-    {"CMP", INDIN, 6, 0                        }, /* C1 CMP */
-    {"???", 0    , 2, BAD                      }, /* C2     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* C3     illegal 6502 */
-    {"CPY", ZEROP, 3, 0                        }, /* C4 CPY */
-    {"CMP", ZEROP, 3, 0                        }, /* C5 CMP */
-    {"DEC", ZEROP, 5, 0                        }, /* C6 DEC */
-    {"???", 0    , 5, BAD                      }, /* C7     illegal 6502 */
-    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
-    {"CMP", IMMED, 2, 0                        }, /* C9 CMP */
-    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
-    {"???", 0    , 2, BAD                      }, /* CB     illegal 6502 */
-    {"CPY", ABSOL, 4, 0                        }, /* CC CPY */
-    {"CMP", ABSOL, 4, 0                        }, /* CD CMP */
-    {"DEC", ABSOL, 6, 0                        }, /* CE DEC */
-    {"???", 0    , 6, BAD                      }, /* CF     illegal 6502 */
-    {"BNE", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* D0 BNE */
-    {"CMP", ININD, 5, CYCLE_PAGE               }, /* D1 CMP */
-    {"???", 0    , 2, BAD                      }, /* D2     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* D3     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* D4     illegal 6502 */
-    {"CMP", ZEPIX, 4, 0                        }, /* D5 CMP */
-    {"DEC", ZEPIX, 6, 0                        }, /* D6 DEC */
-    {"???", 0    , 6, BAD                      }, /* D7     illegal 6502 */
-    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
-    {"CMP", ABSIY, 4, CYCLE_PAGE               }, /* D9 CMP */
-    {"???", 0    , 2, BAD                      }, /* DA     illegal 6502 */
-    {"???", 0    , 7, BAD                      }, /* DB     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* DC     illegal 6502 */
-    {"CMP", ABSIX, 4, CYCLE_PAGE               }, /* DD CMP */
-    {"DEC", ABSIX, 7, 0                        }, /* DE DEC */
-    {"???", 0    , 7, BAD                      }, /* DF     illegal 6502 */
-    {"CPX", IMMED, 2, 0                        }, /* E0 CPX */
-    {"SBC", INDIN, 6, 0                        }, /* E1 SBC */
-    {"???", 0    , 2, BAD                      }, /* E2     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* E3     illegal 6502 */
-    {"CPX", ZEROP, 3, 0                        }, /* E4 CPX */
-    {"SBC", ZEROP, 3, 0                        }, /* E5 SBC */
-    {"INC", ZEROP, 5, 0                        }, /* E6 INC */
-    {"???", 0    , 5, BAD                      }, /* E7     illegal 6502 */
-    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
-    {"SBC", IMMED, 2, 0                        }, /* E9 SBC */
-    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
-    {"???", 0    , 2, BAD                      }, /* EB     illegal 6502 */
-    {"CPX", ABSOL, 4, 0                        }, /* EC CPX */
-    {"SBC", ABSOL, 4, 0                        }, /* ED SBC */
-    {"INC", ABSOL, 6, 0                        }, /* EE INC */
-    {"???", 0    , 6, BAD                      }, /* EF     illegal 6502 */
-    {"BEQ", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* F0 BEQ */
-    {"SBC", ININD, 5, CYCLE_PAGE               }, /* F1 SBC */
-    {"???", 0    , 2, BAD                      }, /* F2     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* F3     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* F4     illegal 6502 */
-    {"SBC", ZEPIX, 4, 0                        }, /* F5 SBC */
-    {"INC", ZEPIX, 6, 0                        }, /* F6 INC */
-    {"???", 0    , 6, BAD                      }, /* F7     illegal 6502 */
-    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
-    {"SBC", ABSIY, 4, CYCLE_PAGE               }, /* F9 SBC */
-    {"???", 0    , 2, BAD                      }, /* FA     illegal 6502 */
-    {"???", 0    , 7, BAD                      }, /* FB     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* FC     illegal 6502 */
-    {"SBC", ABSIX, 4, CYCLE_PAGE               }, /* FD SBC */
-    {"INC", ABSIX, 7, 0                        }, /* FE INC */
-    {"???", 0    , 7, BAD                      }  /* FF     illegal 6502 */
-}; // 6502
-
-static opcode_t g_65C02_opcodes[NUMBER_OPCODES] = {
-    {"BRK", IMPLI, 7, 0                        }, /* 00 BRK */
-    {"ORA", INDIN, 6, 0                        }, /* 01 ORA */
-    {"???", 0    , 2, BAD                      }, /* 02     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 03     illegal 6502 */
-    {"???", 0    , 5, BAD                      }, /* 04     illegal 6502 */
-    {"ORA", ZEROP, 3, 0                        }, /* 05 ORA */
-    {"ASL", ZEROP, 5, 0                        }, /* 06 ASL */
-    {"???", 0    , 1, BAD                      }, /* 07     illegal 6502 */
-    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
-    {"ORA", IMMED, 2, 0                        }, /* 09 ORA */
-    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
-    {"???", 0    , 1, BAD                      }, /* 0B     illegal 6502 */
-    {"???", 0    , 6, BAD                      }, /* 0C     illegal 6502 */
-    {"ORA", ABSOL, 4, 0                        }, /* 0D ORA */
-    {"ASL", ABSOL, 6, 0                        }, /* 0E ASL */
-    {"???", 0    , 1, BAD                      }, /* 0F     illegal 6502 */
-    {"BPL", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 10 BPL */
-    {"ORA", ININD, 5, CYCLE_PAGE               }, /* 11 ORA */
-    {"???", 0    , 5, BAD                      }, /* 12     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 13     illegal 6502 */
-    {"???", 0    , 5, BAD                      }, /* 14     illegal 6502 */
-    {"ORA", ZEPIX, 4, 0                        }, /* 15 ORA */
-    {"ASL", ZEPIX, 6, 0                        }, /* 16 ASL */
-    {"???", 0    , 1, BAD                      }, /* 17     illegal 6502 */
-    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
-    {"ORA", ABSIY, 4, CYCLE_PAGE               }, /* 19 ORA */
-    {"???", 0    , 2, BAD                      }, /* 1A     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 1B     illegal 6502 */
-    {"???", 0    , 6, BAD                      }, /* 1C     illegal 6502 */
-    {"ORA", ABSIX, 4, CYCLE_PAGE               }, /* 1D ORA */
-    {"ASL", ABSIX, 6, 0                        }, /* 1E ASL */
-    {"???", 0    , 1, BAD                      }, /* 1F     illegal 6502 */
-    {"JSR", ABSOL, 6, 0                        }, /* 20 JSR */
-    {"AND", INDIN, 6, 0                        }, /* 21 AND */
-    {"???", 0    , 2, BAD                      }, /* 22     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 23     illegal 6502 */
-    {"BIT", ZEROP, 3, 0                        }, /* 24 BIT */
-    {"AND", ZEROP, 3, 0                        }, /* 25 AND */
-    {"ROL", ZEROP, 5, 0                        }, /* 26 ROL */
-    {"???", 0    , 1, BAD                      }, /* 27     illegal 6502 */
-    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
-    {"AND", IMMED, 2, 0                        }, /* 29 AND */
-    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
-    {"???", 0    , 1, BAD                      }, /* 2B     illegal 6502 */
-    {"BIT", ABSOL, 4, 0                        }, /* 2C BIT */
-    {"AND", ABSOL, 4, 0                        }, /* 2D AND */
-    {"ROL", ABSOL, 6, 0                        }, /* 2E ROL */
-    {"???", 0    , 1, BAD                      }, /* 2F     illegal 6502 */
-    {"BMI", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 30 BMI */
-    {"AND", ININD, 5, CYCLE_PAGE               }, /* 31 AND */
-    {"???", 0    , 5, BAD                      }, /* 32     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 33     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 34     illegal 6502 */
-    {"AND", ZEPIX, 4, 0                        }, /* 35 AND */
-    {"ROL", ZEPIX, 6, 0                        }, /* 36 ROL */
-    {"???", 0    , 1, BAD                      }, /* 37     illegal 6502 */
-    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
-    {"AND", ABSIY, 4, CYCLE_PAGE               }, /* 39 AND */
-    {"???", 0    , 2, BAD                      }, /* 3A     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 3B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 3C     illegal 6502 */
-    {"AND", ABSIX, 4, CYCLE_PAGE               }, /* 3D AND */
-    {"ROL", ABSIX, 6, 0                        }, /* 3E ROL */
-    {"???", 0    , 1, BAD                      }, /* 3F     illegal 6502 */
-    {"RTI", IMPLI, 6, 0                        }, /* 40 RTI */
-    {"EOR", INDIN, 6, 1                        }, /* 41 EOR */
-    {"???", 0    , 2, BAD                      }, /* 42     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 43     illegal 6502 */
-    {"???", 0    , 3, BAD                      }, /* 44     illegal 6502 */
-    {"EOR", ZEROP, 3, 0                        }, /* 45 EOR */
-    {"LSR", ZEROP, 5, 0                        }, /* 46 LSR */
-    {"???", 0    , 1, BAD                      }, /* 47     illegal 6502 */
-    {"PHA", IMPLI, 3, 0                        }, /* 48 PHA */
-    {"EOR", IMMED, 2, 0                        }, /* 49 EOR */
-    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
-    {"???", 0    , 1, BAD                      }, /* 4B     illegal 6502 */
-    {"JMP", ABSOL, 3, 0                        }, /* 4C JMP */
-    {"EOR", ABSOL, 4, 0                        }, /* 4D EOR */
-    {"LSR", ABSOL, 6, 0                        }, /* 4E LSR */
-    {"???", 0    , 1, BAD                      }, /* 4F     illegal 6502 */
-    {"BVC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 50 BVC */
-    {"EOR", ININD, 5, CYCLE_PAGE               }, /* 51 EOR */
-    {"???", 0    , 5, BAD                      }, /* 52     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 53     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 54     illegal 6502 */
-    {"EOR", ZEPIX, 4, 0                        }, /* 55 EOR */
-    {"LSR", ZEPIX, 6, 0                        }, /* 56 LSR */
-    {"???", 0    , 1, BAD                      }, /* 57     illegal 6502 */
-    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
-    {"EOR", ABSIY, 4, CYCLE_PAGE               }, /* 59 EOR */
-    {"???", 0    , 3, BAD                      }, /* 5A     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 5B     illegal 6502 */
-    {"???", 0    , 8, BAD                      }, /* 5C     illegal 6502 */
-    {"EOR", ABSIX, 4, CYCLE_PAGE               }, /* 5D EOR */
-    {"LSR", ABSIX, 6, 0                        }, /* 5E LSR */
-    {"???", 0    , 1, BAD                      }, /* 5F     illegal 6502 */
-    {"RTS", IMPLI, 6, 0                        }, /* 60 RTS */
-    {"ADC", INDIN, 6, 0                        }, /* 61 ADC */
-    {"???", 0    , 2, BAD                      }, /* 62     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 63     illegal 6502 */
-    {"???", 0    , 3, BAD                      }, /* 64     illegal 6502 */
-    {"ADC", ZEROP, 3, 0                        }, /* 65 ADC */
-    {"ROR", ZEROP, 5, 0                        }, /* 66 ROR */
-    {"???", 0    , 1, BAD                      }, /* 67     illegal 6502 */
-    {"PLA", IMPLI, 4, 0                        }, /* 68 PLA */
-    {"ADC", IMMED, 2, 0                        }, /* 69 ADC */
-    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
-    {"???", 0    , 1, BAD                      }, /* 6B     illegal 6502 */
-    {"JMP", INDIA, 6, 0                        }, /* 6C JMP */
-    {"ADC", ABSOL, 4, 0                        }, /* 6D ADC */
-    {"ROR", ABSOL, 6, 0                        }, /* 6E ROR */
-    {"???", 0    , 1, BAD                      }, /* 6F     illegal 6502 */
-    {"BVS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 70 BVS */
-    {"ADC", ININD, 5, CYCLE_PAGE               }, /* 71 ADC */
-    {"???", 0    , 5, BAD                      }, /* 72     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 73     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 74     illegal 6502 */
-    {"ADC", ZEPIX, 4, 0                        }, /* 75 ADC */
-    {"ROR", ZEPIX, 6, 0                        }, /* 76 ROR */
-    {"???", 0    , 1, BAD                      }, /* 77     illegal 6502 */
-    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
-    {"ADC", ABSIY, 4, CYCLE_PAGE               }, /* 79 ADC */
-    {"???", 0    , 4, BAD                      }, /* 7A     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 7B     illegal 6502 */
-    {"???", 0    , 6, BAD                      }, /* 7C     illegal 6502 */
-    {"ADC", ABSIX, 4, CYCLE_PAGE               }, /* 7D ADC */
-    {"ROR", ABSIX, 6, 0                        }, /* 7E ROR */
-    {"???", 0    , 1, BAD                      }, /* 7F     illegal 6502 */
-    {"???", 0    , 2, BAD                      }, /* 80     illegal 6502 */
-    {"STA", INDIN, 6, 0                        }, /* 81 STA */
-    {"???", 0    , 2, BAD                      }, /* 82     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 83     illegal 6502 */
-    {"STY", ZEROP, 3, 0                        }, /* 84 STY */
-    {"STA", ZEROP, 3, 0                        }, /* 85 STA */
-    {"STX", ZEROP, 3, 0                        }, /* 86 STX */
-    {"???", 0    , 1, BAD                      }, /* 87     illegal 6502 */
-    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
-    {"???", 0    , 2, BAD                      }, /* 89     illegal 6502 */
-    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
-    {"???", 0    , 1, BAD                      }, /* 8B     illegal 6502 */
-    {"STY", ABSOL, 4, 0                        }, /* 8C STY */
-    {"STA", ABSOL, 4, 0                        }, /* 8D STA */
-    {"STX", ABSOL, 4, 0                        }, /* 8E STX */
-    {"???", 0    , 1, BAD                      }, /* 8F     illegal 6502 */
-    {"BCC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 90 BCC */
-    {"STA", ININD, 6, CYCLE_PAGE               }, /* 91 STA */
-    {"???", 0    , 5, BAD                      }, /* 92     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 93     illegal 6502 */
-    {"STY", ZEPIX, 4, 0                        }, /* 94 STY */
-    {"STA", ZEPIX, 4, 0                        }, /* 95 STA */
-    {"STX", ZEPIY, 4, 0                        }, /* 96 STX */
-    {"???", 0    , 1, BAD                      }, /* 97     illegal 6502 */
-    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
-    {"STA", ABSIY, 5, CYCLE_PAGE               }, /* 99 STA */
-    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
-    {"???", 0    , 1, BAD                      }, /* 9B     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* 9C     illegal 6502 */
-    {"STA", ABSIX, 5, CYCLE_PAGE               }, /* 9D STA */
-    {"???", 0    , 5, BAD                      }, /* 9E     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* 9F     illegal 6502 */
-    {"LDY", IMMED, 2, 0                        }, /* A0 LDY */
-    {"LDA", INDIN, 6, 0                        }, /* A1 LDA */
-    {"LDX", IMMED, 2, 0                        }, /* A2 LDX */
-    {"???", 0    , 1, BAD                      }, /* A3     illegal 6502 */
-    {"LDY", ZEROP, 3, 0                        }, /* A4 LDY */
-    {"LDA", ZEROP, 3, 0                        }, /* A5 LDA */
-    {"LDX", ZEROP, 3, 0                        }, /* A6 LDX */
-    {"???", 0    , 1, BAD                      }, /* A7     illegal 6502 */
-    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
-    {"LDA", IMMED, 2, 0                        }, /* A9 LDA */
-    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
-    {"???", 0    , 1, BAD                      }, /* AB     illegal 6502 */
-    {"LDY", ABSOL, 4, 0                        }, /* AC LDY */
-    {"LDA", ABSOL, 4, 0                        }, /* AD LDA */
-    {"LDX", ABSOL, 4, 0                        }, /* AE LDX */
-    {"???", 0    , 1, BAD                      }, /* AF     illegal 6502 */
-    {"BCS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* B0 BCS */
-    {"LDA", ININD, 5, CYCLE_PAGE               }, /* B1 LDA */
-    {"???", 0    , 5, BAD                      }, /* B2     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* B3     illegal 6502 */
-    {"LDY", ZEPIX, 4, 0                        }, /* B4 LDY */
-    {"LDA", ZEPIX, 4, 0                        }, /* B5 LDA */
-    {"LDX", ZEPIY, 4, 0                        }, /* B6 LDX */
-    {"???", 0    , 1, BAD                      }, /* B7     illegal 6502 */
-    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
-    {"LDA", ABSIY, 4, CYCLE_PAGE               }, /* B9 LDA */
-    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
-    {"???", 0    , 1, BAD                      }, /* BB     illegal 6502 */
-    {"LDY", ABSIX, 4, CYCLE_PAGE               }, /* BC LDY */
-    {"LDA", ABSIX, 4, CYCLE_PAGE               }, /* BD LDA */
-    {"LDX", ABSIY, 4, CYCLE_PAGE               }, /* BE LDX */
-    {"???", 0    , 1, BAD                      }, /* BF     illegal 6502 */
-    {"CPY", IMMED, 2, 0                        }, /* C0 CPY */
-    {"CMP", INDIN, 6, 0                        }, /* C1 CMP */
-    {"???", 0    , 2, BAD                      }, /* C2     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* C3     illegal 6502 */
-    {"CPY", ZEROP, 3, 0                        }, /* C4 CPY */
-    {"CMP", ZEROP, 3, 0                        }, /* C5 CMP */
-    {"DEC", ZEROP, 5, 0                        }, /* C6 DEC */
-    {"???", 0    , 1, BAD                      }, /* C7     illegal 6502 */
-    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
-    {"CMP", IMMED, 2, 0                        }, /* C9 CMP */
-    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
-    {"???", 0    , 1, BAD                      }, /* CB     illegal 6502 */
-    {"CPY", ABSOL, 4, 0                        }, /* CC CPY */
-    {"CMP", ABSOL, 4, 0                        }, /* CD CMP */
-    {"DEC", ABSOL, 6, 0                        }, /* CE DEC */
-    {"???", 0    , 1, BAD                      }, /* CF     illegal 6502 */
-    {"BNE", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* D0 BNE */
-    {"CMP", ININD, 5, CYCLE_PAGE               }, /* D1 CMP */
-    {"???", 0    , 5, BAD                      }, /* D2     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* D3     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* D4     illegal 6502 */
-    {"CMP", ZEPIX, 4, 0                        }, /* D5 CMP */
-    {"DEC", ZEPIX, 6, 0                        }, /* D6 DEC */
-    {"???", 0    , 1, BAD                      }, /* D7     illegal 6502 */
-    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
-    {"CMP", ABSIY, 4, CYCLE_PAGE               }, /* D9 CMP */
-    {"???", 0    , 3, BAD                      }, /* DA     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* DB     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* DC     illegal 6502 */
-    {"CMP", ABSIX, 4, CYCLE_PAGE               }, /* DD CMP */
-    {"DEC", ABSIX, 7, 0                        }, /* DE DEC */
-    {"???", 0    , 1, BAD                      }, /* DF     illegal 6502 */
-    {"CPX", IMMED, 2, 0                        }, /* E0 CPX */
-    {"SBC", INDIN, 6, 0                        }, /* E1 SBC */
-    {"???", 0    , 2, BAD                      }, /* E2     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* E3     illegal 6502 */
-    {"CPX", ZEROP, 3, 0                        }, /* E4 CPX */
-    {"SBC", ZEROP, 3, 0                        }, /* E5 SBC */
-    {"INC", ZEROP, 5, 0                        }, /* E6 INC */
-    {"???", 0    , 1, BAD                      }, /* E7     illegal 6502 */
-    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
-    {"SBC", IMMED, 2, 0                        }, /* E9 SBC */
-    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
-    {"???", 0    , 1, BAD                      }, /* EB     illegal 6502 */
-    {"CPX", ABSOL, 4, 0                        }, /* EC CPX */
-    {"SBC", ABSOL, 4, 0                        }, /* ED SBC */
-    {"INC", ABSOL, 6, 0                        }, /* EE INC */
-    {"???", 0    , 1, BAD                      }, /* EF     illegal 6502 */
-    {"BEQ", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* F0 BEQ */
-    {"SBC", ININD, 5, CYCLE_PAGE               }, /* F1 SBC */
-    {"???", 0    , 5, BAD                      }, /* F2     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* F3     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* F4     illegal 6502 */
-    {"SBC", ZEPIX, 4, 0                        }, /* F5 SBC */
-    {"INC", ZEPIX, 6, 0                        }, /* F6 INC */
-    {"???", 0    , 1, BAD                      }, /* F7     illegal 6502 */
-    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
-    {"SBC", ABSIY, 4, CYCLE_PAGE               }, /* F9 SBC */
-    {"???", 0    , 4, BAD                      }, /* FA     illegal 6502 */
-    {"???", 0    , 1, BAD                      }, /* FB     illegal 6502 */
-    {"???", 0    , 4, BAD                      }, /* FC     illegal 6502 */
-    {"SBC", ABSIX, 4, CYCLE_PAGE               }, /* FD SBC */
-    {"INC", ABSIX, 7, 0                        }, /* FE INC */
-    {"???", 0    , 1, BAD                      }  /* FF     illegal 65C02 */
-}; // 65C02
-
-opcode_t *g_opcode_table = g_6502_opcodes;
-
-#define DUMP_FORMAT (options->hex_output ? "%-16s%-16s;" : "%-8s%-16s;")
+/* Input files of batch mode */
+typedef struct file_list_s {
+    char  **names;
+    size_t *relative;  /* Offset in each name of its path below the walked directory, kept under -O */
+    size_t  count;
+    size_t  capacity;
+} file_list_t;
+
+/* Work shared by the batch worker threads */
+typedef struct batch_s {
+    options_t     *options;
+    file_list_t   *files;
+    size_t         next;       /* Index of the next file to disassemble */
+    unsigned long  num_files;  /* Files disassembled */
+    unsigned long  num_failed; /* Files that could not be opened or written */
+    unsigned long  num_bytes;  /* Input bytes disassembled */
+    unsigned long  num_hits;   /* Pattern matches of search mode, instructions of statistics mode */
+    lock_t         lock;
+} batch_t;
+
+/* Instruction pattern of search mode */
+typedef struct pattern_s {
+    uint8_t  bytes[MAX_PATTERN_LENGTH]; /* Bytes to match, 0 where any byte matches */
+    uint8_t  mask[MAX_PATTERN_LENGTH];  /* 0xFF where the byte must match, 0 where any byte matches */
+    uint32_t length;                    /* Length in bytes */
+    uint32_t last;                      /* Offset of the last byte that must match */
+    uint32_t num_instructions;
+} pattern_t;
+
+/* Linear sweep state, carried across the ranges of one disassembly */
+typedef struct sweep_s {
+    options_t     *options;
+    char          *output;      /* Output buffer */
+    size_t         output_size; /* Size of the output buffer */
+    char          *out;         /* Output buffer write position */
+    FILE          *stream;      /* Where the output buffer is flushed, NULL to grow it instead */
+    FILE          *cache;       /* Result cache entry also receiving the flushed output, NULL if none */
+    unsigned long  offset;  /* Offset of the next instruction from start_offset */
+    unsigned long  bank;    /* Bank of the last instruction */
+    uint32_t       last_pc; /* Address of the last instruction */
+    uint8_t       *widths;  /* 65816 register widths at jump and branch targets, NULL for the 8-bit CPUs */
+    unsigned int   p;       /* 65816 DCC6502_P_* state at the next instruction */
+    int            stopped; /* The last instruction does not fall through */
+} sweep_t;
+
+/* Bitmap over the 64K address space, one bit per address */
+#define BITMAP_SIZE       (0x10000 / 8)
+#define BIT_TEST(map, a)  ((map)[(a) >> 3] & (1u << ((a) & 7)))
+#define BIT_SET(map, a)   ((map)[(a) >> 3] |= (uint8_t)(1u << ((a) & 7)))
+
+/* 65816 register widths over the 16M address space, 4 bits per address:
+   WIDTH_KNOWN, then the X, M and E bits of the DCC6502_P_* state */
+#define WIDTH_MAP_SIZE    (0x1000000 / 2)
+#define WIDTH_KNOWN       1
+#define WIDTH_GET(map, a) (((map)[(a) >> 1] >> (((a) & 1) << 2)) & 0xF)
+#define WIDTH_SET(map, a, w) ((map)[(a) >> 1] |= (uint8_t)((w) << (((a) & 1) << 2)))
+
+/* Code/data separation of one 64K image */
+typedef struct flow_s {
+    const uint8_t *image;              /* 64K image, file bytes placed at org */
+    uint32_t       begin;              /* First loaded address */
+    uint32_t       end;                /* One past the last loaded address */
+    uint8_t        code[BITMAP_SIZE];  /* Bytes of decoded instructions */
+    uint8_t        start[BITMAP_SIZE]; /* First byte of decoded instructions */
+    uint8_t        entry[BITMAP_SIZE]; /* Addresses entered by a seed, a jump or a branch */
+    uint16_t       work[0x10000 + MAX_ENTRY_POINTS + 3]; /* Worklist of addresses to decode */
+    uint32_t       num_work;
+} flow_t;
+
+/* Cycle budgets of the basic blocks of one 64K image. Block k spans the
+   instructions first[k] to last[k]; its straight-line path continues
+   through the following blocks while execution falls through */
+typedef struct timing_s {
+    uint32_t       block[0x10000];     /* Index + 1 of the block starting at each address, 0 if none */
+    uint32_t       num_blocks;
+    uint16_t       first[0x10000];     /* First instruction */
+    uint16_t       last[0x10000];      /* Last instruction */
+    uint32_t       min[0x10000];       /* Fewest cycles through the block */
+    uint32_t       max[0x10000];       /* Most cycles through the block, last branch taken */
+    uint32_t       fall_min[0x10000];  /* Fewest cycles when the last branch is not taken */
+    uint32_t       fall_max[0x10000];  /* Most cycles when the last branch is not taken */
+    uint32_t       taken[0x10000];     /* Cycles of the last instruction when its branch is taken */
+    uint32_t       fall[0x10000];      /* Cycles of the last instruction when it falls through */
+    uint32_t       path_min[0x10000];  /* Fewest cycles to the end of the straight-line path */
+    uint32_t       path_max[0x10000];  /* Most cycles to the end of the straight-line path */
+    uint16_t       path_last[0x10000]; /* Last instruction of the straight-line path */
+    uint8_t        falls[0x10000];     /* 1 if execution falls through into block k + 1 */
+} timing_t;
+
+/* Kind of a generated label */
+#define LABEL_NONE 0
+#define LABEL_CODE 1 // L_XXXX
+#define LABEL_SUB  2 // sub_XXXX, target of a JSR
+
+/* Reference index of one 64K image. The sources referencing address a are
+   source[first[a]] to source[first[a + 1] - 1], in address order; the
+   opcode and addressing mode are those of the referencing instruction */
+typedef struct xref_s {
+    uint32_t       first[0x10000 + 1];
+    uint16_t       source[0x10000];     /* Referencing instructions, grouped by target */
+    uint16_t       ref_source[0x10000]; /* Referencing instructions, in decode order */
+    uint16_t       ref_target[0x10000]; /* Referenced addresses, in decode order */
+    uint8_t        label[0x10000];      /* LABEL_* of every address */
+} xref_t;
+
+/* Work areas of disassemble_image, an area left NULL is allocated by the
+   first image needing it. A long running caller keeps them across images,
+   they are then only cleared */
+typedef struct image_work_s {
+    flow_t        *flow;
+    xref_t        *xref;
+    timing_t      *timing;
+} image_work_t;
+
+/* Chunk of a parallel disassembly */
+typedef struct chunk_s {
+    unsigned long  begin;                        /* First byte of the chunk */
+    unsigned long  end;                          /* One past the last byte of the chunk */
+    unsigned long  exit[MAX_INSTRUCTION_LENGTH]; /* First instruction at or past end, per entry candidate */
+    unsigned long  last[MAX_INSTRUCTION_LENGTH]; /* Last instruction before end, per entry candidate */
+    unsigned long  entry;                        /* First instruction of the chunk, once stitched */
+    unsigned long  prev;                         /* Instruction before entry, UNKNOWN_SIZE if none */
+    size_t         listing_len;                  /* Length of the formatted chunk */
+} chunk_t;
+
+/* Work shared by the parallel disassembly threads */
+typedef struct parallel_s {
+    options_t     *options;
+    const uint8_t *data;
+    chunk_t       *chunks;
+    size_t         num_chunks;
+    size_t         next;                       /* Next chunk to process */
+    size_t         round_begin;                /* First chunk of the current round */
+    size_t         round_end;                  /* One past the last chunk of the current round */
+    char          *listing[MAX_THREADS];       /* Formatted chunks of the current round */
+    size_t         listing_size[MAX_THREADS];
+    lock_t         lock;
+} parallel_t;
+
+/* State shared by the daemon threads */
+typedef struct daemon_s {
+    options_t     *options;
+    int            listen_fd;
+    unsigned long  num_requests;  /* Requests served */
+    double         total_seconds; /* Decode time of all requests */
+    double         max_seconds;   /* Slowest request */
+    lock_t         lock;
+} daemon_t;
+
+/* Result cache statistics of this run */
+typedef struct cache_stats_s {
+    unsigned long  hits;
+    unsigned long  misses;
+    unsigned long  evictions;
+    unsigned long  num_temp;     /* Temporary entries created, for unique names */
+    unsigned long  total;        /* Size of the cache as of the last scan, plus entries added since */
+    int            scanned;      /* 1 once the cache directory was scanned */
+    lock_t         lock;
+} cache_stats_t;
+
+/* Instruction index of an incremental run, and the listing it indexes */
+typedef struct index_s {
+    uint64_t       key;          /* options_key of the run */
+    uint32_t       length;       /* Bytes disassembled */
+    uint32_t       listing_len;  /* Length of the listing, without header */
+    const uint8_t *bytes;        /* The bytes disassembled */
+    const uint32_t *line;        /* Listing offset of the instruction starting at each byte, NO_LINE if none;
+                                    line[length] is the end of the listing */
+    const char    *listing;
+    void          *file;         /* Buffer holding the loaded index */
+} index_t;
+
+/* Instructions of one image of a diff */
+typedef struct diff_side_s {
+    const char    *filename;
+    unsigned long  size;       /* File size */
+    unsigned long  length;     /* Bytes disassembled */
+    uint8_t       *data;       /* The bytes, zero padded by MAX_INSTRUCTION_LENGTH */
+    uint32_t      *offset;     /* Offset of each instruction */
+    uint64_t      *key;        /* Length and bytes of each instruction: equal keys, equal instructions */
+    int32_t       *match;      /* Instruction of the other image it is aligned with, -1 if changed */
+    uint32_t       count;      /* Number of instructions */
+} diff_side_t;
+
+/* Slot of the hash table counting the instructions of a gap of both images */
+typedef struct diff_slot_s {
+    uint64_t key;              /* 0 if empty, keys are never 0 */
+    uint32_t count[2];
+    uint32_t index[2];         /* Last instruction with this key in each image */
+} diff_slot_t;
+
+typedef struct diff_s {
+    diff_side_t  side[2];      /* Old, new */
+    diff_slot_t *slots;
+    uint32_t     num_slots;
+} diff_t;
+
+/* Opcode of a compiled CPU definition, CPU_HEADER_SIZE + opcode * 10 in the table file */
+typedef struct cpu_record_s {
+    char     mnemonic[CPU_MNEMONIC_SIZE]; /* NUL terminated, "???" for illegal opcodes */
+    uint8_t  addressing;                  /* addressing_mode_e */
+    uint8_t  cycles;                      /* Base cycles */
+    uint8_t  reserved;                    /* Zero */
+    uint16_t exceptions;                  /* Mask of CYCLE_PAGE, CYCLE_BRANCH, _65C02, BAD, UNDOC, CYCLE_M,
+                                             CYCLE_X, CYCLE_RMW, CYCLE_BRANCH2 */
+} cpu_record_t;
+
+/* Result cache entry being filled */
+typedef struct cache_entry_s {
+    FILE          *file;
+    char           path[4096];   /* Final name of the entry */
+    char           temp[4096];   /* Name while it is filled */
+} cache_entry_t;
+
+static dcc6502_t g_dcc; /* Decoder of the selected instruction set */
+static opcode_t  g_cpu_table[NUMBER_OPCODES]; /* Opcode table of the -P CPU definition */
+static uint64_t  g_cpu_key; /* Hash of the -P CPU definition, 0 with the built-in tables */
+
+/* Addressing mode names of CPU definitions, in addressing_mode_e order */
+static const char *g_cpu_modes[] = {
+    "imm", "abs", "zp", "imp", "ind", "abx", "aby", "zpx", "zpy", "izx", "izy", "rel", "acc",
+    "izp", "iax", "zpr", "abl", "alx", "izl", "ily", "sr", "isy", "rll", "blk", "ial", "blt",
+    "tzp", "tab", "tzx", "tabx", NULL
+};
+static cache_stats_t g_cache_stats;
+
+/* Instructions after which execution does not fall through */
+static const char *g_stop_mnemonics[] = { "BRA", "BRK", "BRL", "JML", "JMP", "RTI", "RTL", "RTS", "STP", NULL };
+
+static template_t g_templates[NUMBER_OPCODES];
+static pattern_t  g_pattern;
+/* Address column layouts differ by -d, -a and -s */
+#define COLUMN_STYLES 8
+#define COLUMN_STYLE(options) ((options)->hex_output | ((options)->apple2_output << 1) | ((options)->omit_opcodes << 2))
+
+static column_t   g_columns[COLUMN_STYLES][MAX_INSTRUCTION_LENGTH + 1]; /* Indexed by style, then instruction length */
+
+/* The 65816 has 24-bit addresses */
+#define LONG_ADDRESSES(options) (DCC6502_CPU_65816 == (options)->cpu)
+
+/* The HuC6280 has 7 byte block transfers */
+#define LONG_OPCODES(options) (DCC6502_CPU_HUC6280 == (options)->cpu)
+
+#define DUMP_FORMAT "%-*s%-16s;"
+
+/* Column widths of DUMP_FORMAT, used by the sprintf-free output engine */
+#define DUMP_ADDR_WIDTH     (options->hex_output ? (LONG_ADDRESSES(options) ? 20 : LONG_OPCODES(options) ? 26 : 16) : 8)
+#define DUMP_MNEMONIC_WIDTH 16
+
+/* Output engine: lines are formatted into one large buffer which is
+   flushed with a single fwrite() whenever it can no longer hold a line */
+#define OUTPUT_BUFFER_SIZE  (1 << 16)
+#define MAX_LINE_LENGTH     256
+
+/* Input is read through a sliding window of this size */
+#define STREAM_WINDOW_SIZE  (1 << 16)
+
+static const char g_hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+static char *put_str(char *output, const char *str) {
+    while (*str)
+        *output++ = *str++;
+    return output;
+}
+
+static char *put_hex2(char *output, uint8_t value) {
+    output[0] = g_hex_digits[(value >> 4) & 0xF];
+    output[1] = g_hex_digits[(value     ) & 0xF];
+    return output + 2;
+}
+
+static char *put_hex4(char *output, uint16_t value) {
+    output[0] = g_hex_digits[(value >> 12) & 0xF];
+    output[1] = g_hex_digits[(value >>  8) & 0xF];
+    output[2] = g_hex_digits[(value >>  4) & 0xF];
+    output[3] = g_hex_digits[(value      ) & 0xF];
+    return output + 4;
+}
+
+static char *put_hex6(char *output, uint32_t value) {
+    output = put_hex2(output, (uint8_t)(value >> 16));
+    return put_hex4(output, (uint16_t)value);
+}
+
+static char *put_dec(char *output, unsigned long value) {
+    char digits[20];
+    int  len = 0;
+
+    do {
+        digits[len++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value);
+
+    while (len)
+        *output++ = digits[--len];
+    return output;
+}
+
+/* Pad a column that started at *field with spaces, same as "%-*s" */
+static char *put_pad(char *field, char *output, int width) {
+    while ((output - field) < width)
+        *output++ = ' ';
+    return output;
+}
+
+static char *put_label(char *output, uint8_t kind, uint16_t addr) {
+    output = put_str(output, (LABEL_SUB == kind) ? "sub_" : "L_");
+    return put_hex4(output, addr);
+}
+
+static void flush_output(FILE *stream, const char *output, size_t len) {
+    if (len)
+        fwrite(output, 1, len, stream);
+}
 
 /* This function emits a comment header with information about the file
    being disassembled */
-static void emit_header(options_t *options, int fsize) {
-    char mnemonic[256];
-    sprintf( mnemonic, "ORG $%04X", options->org);
-
-    /*                        */ fprintf(stdout, "; Source generated by DCC6502 version %s\n", VERSION_INFO);
-    /*                        */ fprintf(stdout, "; For more info about DCC6502, see %s\n", GIT_LOCATION);
-    /*                        */ fprintf(stdout, "; FILENAME: %s, File Size: $%04X (%d)\n", options->filename, fsize, fsize);
-    if (options->hex_output)     fprintf(stdout, ";     -> Hex output enabled\n");
-    if (options->cycle_counting) fprintf(stdout, ";     -> Cycle counting enabled\n");
-    if (options->nes_mode)       fprintf(stdout, ";     -> NES mode enabled\n");
-    if (options->apple2_output)  fprintf(stdout, ";     -> Apple II output enabled\n");
-    /*                        */ fprintf(stdout, ";---------------------------------------------------------------------------\n");
-    /*                        */ fprintf(stdout, DUMP_FORMAT, "", mnemonic);
-    /*                        */ fprintf(stdout, "\n" );
-}
-
-/* This function appends cycle counting to the comment block. See following
- * for methods used:
+static void emit_header(FILE *stream, options_t *options, unsigned long fsize) {
+    char    mnemonic[256];
+    uint8_t header[DCC6502_HEADER_SIZE];
+
+    if (FORMAT_BIN == options->format) {
+        fwrite(header, 1, dcc6502_record_header(header, options->org, options->cpu), stream);
+        return;
+    }
+    if (FORMAT_JSONL == options->format) {
+        return;
+    }
+    if (FORMAT_CSV == options->format) {
+        fprintf(stream, "address,bytes,mnemonic,mode,operand,target,cycles_min,cycles_max,nes\n");
+        return;
+    }
+
+    sprintf( mnemonic, LONG_ADDRESSES(options) ? "ORG $%06lX" : "ORG $%04lX", (unsigned long)options->org);
+
+    /*                        */ fprintf(stream, "; Source generated by DCC6502 version %s\n", VERSION_INFO);
+    /*                        */ fprintf(stream, "; For more info about DCC6502, see %s\n", GIT_LOCATION);
+    if (UNKNOWN_SIZE == fsize)   fprintf(stream, "; FILENAME: %s, File Size: unknown\n", options->filename);
+    else                         fprintf(stream, "; FILENAME: %s, File Size: $%04lX (%lu)\n", options->filename, fsize, fsize);
+    if (options->hex_output)     fprintf(stream, ";     -> Hex output enabled\n");
+    if (options->cycle_counting) fprintf(stream, ";     -> Cycle counting enabled\n");
+    if (options->nes_mode)       fprintf(stream, ";     -> NES mode enabled\n");
+    if (options->apple2_output)  fprintf(stream, ";     -> Apple II output enabled\n");
+    if (options->bank_size)      fprintf(stream, ";     -> Bank size $%04lX\n", options->bank_size);
+    if (options->recursive)      fprintf(stream, ";     -> Code/data separation enabled\n");
+    if (options->timing)         fprintf(stream, ";     -> Basic block cycle budgets enabled\n");
+    if (options->labels)         fprintf(stream, ";     -> Labels generated%s\n", options->xref ? ", with cross-references" : "");
+    /*                        */ fprintf(stream, ";---------------------------------------------------------------------------\n");
+    /*                        */ fprintf(stream, DUMP_FORMAT, DUMP_ADDR_WIDTH, "", mnemonic);
+    /*                        */ fprintf(stream, "\n" );
+}
+
+/* This function appends the cycles of insn, as decoded by libdcc6502, to
+ * the comment block. See following for methods used:
  * "Nick Bensema's Guide to Cycle Counting on the Atari 2600"
  * http://www.alienbill.com/2600/cookbook/cycles/nickb.txt
  */
-static char *append_cycle(char *input, uint8_t entry, uint16_t pc, uint16_t new_pc) {
-    char tmpstr[256];
-    int  cycles       = g_opcode_table[entry].cycles;
-    int  exceptions   = g_opcode_table[entry].cycles_exceptions & CYCLE_MASK;
-    int  crosses_page = ((pc & 0xff00u) != (new_pc & 0xff00u)) ? 1 : 0;
-
-    // On some exceptional conditions, instruction will take an extra cycle, or even two
-    if (exceptions != 0) {
-        if ((exceptions & CYCLE_BRANCH) && (exceptions & CYCLE_PAGE)) {
-            /* Branch case: check for page crossing, since it can be determined
-             * statically from the relative offset and current PC.
-             */
-            if (crosses_page) {
-                /* Crosses page, always at least 1 extra cycle, two times */
-                sprintf(tmpstr, " Cycles: %d/%d", cycles + 1, cycles + 2);
-            } else {
-                /* Does not cross page, maybe one extra cycle if branch taken */
-                sprintf(tmpstr, " Cycles: %d/%d", cycles, cycles + 1);
-            }
-        } else {
-            /* One exception: two times, can't tell in advance whether page crossing occurs */
-            sprintf(tmpstr, " Cycles: %d/%d", cycles, cycles + 1);
-        }
-    } else {
-        /* No exceptions, no extra time */
-        sprintf(tmpstr, " Cycles: %d", cycles);
+static char *append_cycle(char *output, const dcc6502_insn_t *insn) {
+    output = put_str(output, " Cycles: ");
+    output = put_dec(output, insn->cycles_min);
+    if (insn->cycles_max != insn->cycles_min) {
+        *output++ = '/';
+        output = put_dec(output, insn->cycles_max);
     }
-
-    strcat(input, tmpstr);
-    return (input + strlen(input));
+    return output;
 }
 
-static void add_nes_str(char *instr, char *instr2) {
-    strcat(instr, " [NES] ");
-    strcat(instr, instr2);
+#define NES_PREFIX_LENGTH 7 /* " [NES] " */
+
+static char *add_nes_str(char *output, const char *instr2) {
+    output = put_str(output, " [NES] ");
+    return put_str(output, instr2);
 }
 
 /* This function put NES-specific info in the comment block */
-static void append_nes(char *input, uint16_t arg) {
+static char *append_nes(char *output, uint16_t arg) {
     switch(arg) {
-        case 0x2000: add_nes_str(input, "PPU setup #1"); break;
-        case 0x2001: add_nes_str(input, "PPU setup #2"); break;
-        case 0x2002: add_nes_str(input, "PPU status"); break;
-        case 0x2003: add_nes_str(input, "SPR-RAM address select"); break;
-        case 0x2004: add_nes_str(input, "SPR-RAM data"); break;
-        case 0x2005: add_nes_str(input, "PPU scroll"); break;
-        case 0x2006: add_nes_str(input, "VRAM address select"); break;
-        case 0x2007: add_nes_str(input, "VRAM data"); break;
-        case 0x4000: add_nes_str(input, "Audio -> Square 1"); break;
-        case 0x4001: add_nes_str(input, "Audio -> Square 1"); break;
-        case 0x4002: add_nes_str(input, "Audio -> Square 1"); break;
-        case 0x4003: add_nes_str(input, "Audio -> Square 1"); break;
-        case 0x4004: add_nes_str(input, "Audio -> Square 2"); break;
-        case 0x4005: add_nes_str(input, "Audio -> Square 2"); break;
-        case 0x4006: add_nes_str(input, "Audio -> Square 2"); break;
-        case 0x4007: add_nes_str(input, "Audio -> Square 2"); break;
-        case 0x4008: add_nes_str(input, "Audio -> Triangle"); break;
-        case 0x4009: add_nes_str(input, "Audio -> Triangle"); break;
-        case 0x400a: add_nes_str(input, "Audio -> Triangle"); break;
-        case 0x400b: add_nes_str(input, "Audio -> Triangle"); break;
-        case 0x400c: add_nes_str(input, "Audio -> Noise control reg"); break;
-        case 0x400e: add_nes_str(input, "Audio -> Noise Frequency reg #1"); break;
-        case 0x400f: add_nes_str(input, "Audio -> Noise Frequency reg #2"); break;
-        case 0x4010: add_nes_str(input, "Audio -> DPCM control"); break;
-        case 0x4011: add_nes_str(input, "Audio -> DPCM D/A data"); break;
-        case 0x4012: add_nes_str(input, "Audio -> DPCM address"); break;
-        case 0x4013: add_nes_str(input, "Audio -> DPCM data length"); break;
-        case 0x4014: add_nes_str(input, "Sprite DMA trigger"); break;
-        case 0x4015: add_nes_str(input, "IRQ status / Sound enable"); break;
-        case 0x4016: add_nes_str(input, "Joypad & I/O port for port #1"); break;
-        case 0x4017: add_nes_str(input, "Joypad & I/O port for port #2"); break;
-    }
-}
-
-/* Helper macros for disassemble() function */
-#define HIGH_PART(val) (((val) >> 8) & 0xFFu)
-#define LOW_PART(val) ((val) & 0xFFu)
-
-#define LOAD_BYTE() byte_operand = buffer[*pc]                                     ; *pc += 1;
-#define LOAD_WORD() word_operand = buffer[*pc] | (((uint16_t)buffer[*pc + 1]) << 8); *pc += 2;
-
-#define HEXDUMP_APPLE_0() if (options->apple2_output) { sprintf(hex_dump, "%04X:"              , current_addr                                                        ); } else
-#define HEXDUMP_APPLE_1() if (options->apple2_output) { sprintf(hex_dump, "%04X:%02X        "  , current_addr, opcode                                                 ); } else
-#define HEXDUMP_APPLE_2() if (options->apple2_output) { sprintf(hex_dump, "%04X:%02X %02X    " , current_addr, opcode, byte_operand                                   ); } else
-#define HEXDUMP_APPLE_3() if (options->apple2_output) { sprintf(hex_dump, "%04X:%02X %02X %02X", current_addr, opcode, LOW_PART(word_operand), HIGH_PART(word_operand)); } else
-
-#define HEXDUMP_NES_1() sprintf(hex_dump, "$%04X> %02X:"         , current_addr, opcode);
-#define HEXDUMP_NES_2() sprintf(hex_dump, "$%04X> %02X %02X:"    , current_addr, opcode, byte_operand);
-#define HEXDUMP_NES_3() sprintf(hex_dump, "$%04X> %02X %02X%02X:", current_addr, opcode, LOW_PART(word_operand), HIGH_PART(word_operand));
-
-/* This function disassembles the opcode at the PC and outputs it in *output */
-static void disassemble(char *output, uint8_t *buffer, options_t *options, uint16_t *pc) {
-    char        opcode_repr[256], hex_dump[256];
-    int         len = 0;
-    uint8_t     byte_operand;
-    uint16_t    word_operand = 0;
-    uint16_t    current_addr = *pc;
-    uint8_t     opcode = buffer[current_addr];
-    int         found  = !(g_opcode_table[opcode].cycles_exceptions & BAD);
-    const char *mnemonic = g_opcode_table[opcode].mnemonic; // Opcode found in table: disassemble properly according to addressing mode
-
-    opcode_repr[0] = '\0';
-    hex_dump[0] = '\0';
-
-    // Set hex dump to default single address format. Will be overwritten
-    // by more complex output in case of hex dump mode enabled
-    HEXDUMP_APPLE_0()
-    sprintf(hex_dump, "$%04X", current_addr);
-
-    *pc += 1; // Instructions are always at least 1 byte
-
-    // For opcode not found, terminate early
-    if (!found) {
-        sprintf(opcode_repr, ".byte $%02X", opcode);
+        case 0x2000: return add_nes_str(output, "PPU setup #1");
+        case 0x2001: return add_nes_str(output, "PPU setup #2");
+        case 0x2002: return add_nes_str(output, "PPU status");
+        case 0x2003: return add_nes_str(output, "SPR-RAM address select");
+        case 0x2004: return add_nes_str(output, "SPR-RAM data");
+        case 0x2005: return add_nes_str(output, "PPU scroll");
+        case 0x2006: return add_nes_str(output, "VRAM address select");
+        case 0x2007: return add_nes_str(output, "VRAM data");
+        case 0x4000: return add_nes_str(output, "Audio -> Square 1");
+        case 0x4001: return add_nes_str(output, "Audio -> Square 1");
+        case 0x4002: return add_nes_str(output, "Audio -> Square 1");
+        case 0x4003: return add_nes_str(output, "Audio -> Square 1");
+        case 0x4004: return add_nes_str(output, "Audio -> Square 2");
+        case 0x4005: return add_nes_str(output, "Audio -> Square 2");
+        case 0x4006: return add_nes_str(output, "Audio -> Square 2");
+        case 0x4007: return add_nes_str(output, "Audio -> Square 2");
+        case 0x4008: return add_nes_str(output, "Audio -> Triangle");
+        case 0x4009: return add_nes_str(output, "Audio -> Triangle");
+        case 0x400a: return add_nes_str(output, "Audio -> Triangle");
+        case 0x400b: return add_nes_str(output, "Audio -> Triangle");
+        case 0x400c: return add_nes_str(output, "Audio -> Noise control reg");
+        case 0x400e: return add_nes_str(output, "Audio -> Noise Frequency reg #1");
+        case 0x400f: return add_nes_str(output, "Audio -> Noise Frequency reg #2");
+        case 0x4010: return add_nes_str(output, "Audio -> DPCM control");
+        case 0x4011: return add_nes_str(output, "Audio -> DPCM D/A data");
+        case 0x4012: return add_nes_str(output, "Audio -> DPCM address");
+        case 0x4013: return add_nes_str(output, "Audio -> DPCM data length");
+        case 0x4014: return add_nes_str(output, "Sprite DMA trigger");
+        case 0x4015: return add_nes_str(output, "IRQ status / Sound enable");
+        case 0x4016: return add_nes_str(output, "Joypad & I/O port for port #1");
+        case 0x4017: return add_nes_str(output, "Joypad & I/O port for port #2");
+    }
+    return output;
+}
+
+/* Expand the address column for instructions of num_bytes bytes. Digits
+   are left blank and patched per instruction at the recorded slots */
+static void build_column(column_t *column, options_t *options, int num_bytes) {
+    char *text = column->text;
+    char *p    = text;
+    int   i;
+
+    memset(column->text, ' ', sizeof(column->text));
+    column->len       = DUMP_ADDR_WIDTH;
+    column->addr_slot = -1;
+    for (i = 0; i < MAX_INSTRUCTION_LENGTH; i++)
+        column->byte_slot[i] = -1;
+
+    if (options->omit_opcodes)
+        return;
+
+    if (options->apple2_output) {
+        // AAAA:OP BB BB
+        column->addr_slot = 0;
+        p += LONG_ADDRESSES(options) ? 6 : 4;
+        *p++ = ':';
+        if (options->hex_output) {
+            for (i = 0; i < num_bytes; i++) {
+                if (i)
+                    *p++ = ' ';
+                column->byte_slot[i] = p - text;
+                p += 2;
+            }
+        }
+    } else {
+        // $AAAA> OP BBBB:
+        *p++ = '$';
+        column->addr_slot = 1;
+        p += LONG_ADDRESSES(options) ? 6 : 4;
         if (options->hex_output) {
-            HEXDUMP_APPLE_1()
-            sprintf(hex_dump, "$%04X> %02X:", current_addr, opcode);
+            *p++ = '>';
+            for (i = 0; i < num_bytes; i++) {
+                if (i < 2)
+                    *p++ = ' ';
+                column->byte_slot[i] = p - text;
+                p += 2;
+            }
+            *p++ = ':';
         }
+    }
+}
 
-        if (options->omit_opcodes)
-            hex_dump[0] = '\0';
-        len = sprintf(output, DUMP_FORMAT, hex_dump, opcode_repr);
-        sprintf( &output[len], "%s", " INVALID OPCODE !!!" );
-        return;
+/* Expand the opcode table of g_dcc into the per-opcode decode templates. Must be
+   called once the opcode table and output options are final */
+static void build_templates(options_t *options) {
+    const addressing_t *mode;
+    const opcode_t     *entry;
+    template_t         *tpl;
+    options_t           style_options;
+    uint8_t             code[MAX_INSTRUCTION_LENGTH] = { 0 };
+    dcc6502_insn_t      insn;
+    char               *p;
+    int                 opcode, style, i;
+
+    /* Every style is built so that one process can serve different -d, -a and -s */
+    for (style = 0; style < COLUMN_STYLES; style++) {
+        style_options               = *options;
+        style_options.hex_output    = (style >> 0) & 1;
+        style_options.apple2_output = (style >> 1) & 1;
+        style_options.omit_opcodes  = (style >> 2) & 1;
+        for (i = 1; i <= MAX_INSTRUCTION_LENGTH; i++)
+            build_column(&g_columns[style][i], &style_options, i);
     }
 
-    switch (g_opcode_table[opcode].addressing) {
-        case IMMED:
-            /* Get immediate value operand */
-            LOAD_BYTE()
+    for (opcode = 0; opcode < NUMBER_OPCODES; opcode++) {
+        entry = &g_dcc.table[opcode];
+        tpl   = &g_templates[opcode];
 
-            sprintf(opcode_repr, "%s #$%02X", mnemonic, byte_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+        memset(tpl, 0, sizeof(*tpl));
+        memset(tpl->text, ' ', sizeof(tpl->text));
 
-            break;
-        case ABSOL:
-            /* Get absolute address operand */
-            LOAD_WORD()
-
-            sprintf(opcode_repr, "%s $%02X%02X", mnemonic, HIGH_PART(word_operand), LOW_PART(word_operand));
-            if (options->hex_output) {
-                HEXDUMP_APPLE_3()
-                sprintf(hex_dump, "$%04X> %02X %02X%02X:", current_addr, opcode, LOW_PART(word_operand), HIGH_PART(word_operand));
-            }
+        if (entry->cycles_exceptions & BAD) {
+            tpl->length = 1;
+            tpl->flags  = TEMPLATE_INVALID;
 
-            break;
-        case ZEROP:
-            /* Get zero page address */
-            LOAD_BYTE()
-
-            sprintf(opcode_repr, "%s $%02X", mnemonic, byte_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+            p = put_str(tpl->text, ".byte $");
+            p = put_hex2(p, opcode);
+            tpl->repr_len = p - tpl->text;
+            p = put_pad(tpl->text, p, DUMP_MNEMONIC_WIDTH);
+            p = put_str(p, "; INVALID OPCODE !!!");
+            tpl->text_len = p - tpl->text;
+            continue;
+        }
 
-            break;
-        case IMPLI:
-            sprintf(opcode_repr, "%s", mnemonic);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_1()
-                sprintf(hex_dump, "$%04X> %02X:", current_addr, opcode);
-            }
+        mode = dcc6502_addressing(entry->addressing);
+        tpl->length = mode->length;
+        tpl->digits = mode->digits;
 
-            break;
-        case INDIA:
-            /* Get indirection address */
-            LOAD_WORD()
-
-            sprintf(opcode_repr, "%s ($%02X%02X)", mnemonic, HIGH_PART(word_operand), LOW_PART(word_operand));
-            if (options->hex_output) {
-                HEXDUMP_APPLE_3()
-                sprintf(hex_dump, "$%04X> %02X %02X%02X:", current_addr, opcode, LOW_PART(word_operand), HIGH_PART(word_operand));
-            }
+        p = put_str(tpl->text, entry->mnemonic);
+        p = put_str(p, mode->prefix);
+        if (entry->addressing == ZEREL) {
+            tpl->zp_slot = p - tpl->text;
+            p = put_str(p + 2, ",$");
+        }
+        tpl->slot = p - tpl->text;
+        p += mode->digits;
+        p = put_str(p, mode->suffix);
+        tpl->repr_len = p - tpl->text;
+        p = put_pad(tpl->text, p, DUMP_MNEMONIC_WIDTH);
+        *p++ = ';';
+        tpl->text_len = p - tpl->text;
 
-            break;
-        case ABSIX:
-            /* Get base address */
-            LOAD_WORD()
-
-            sprintf(opcode_repr, "%s $%02X%02X,X", mnemonic, HIGH_PART(word_operand), LOW_PART(word_operand));
-            if (options->hex_output) {
-                HEXDUMP_APPLE_3()
-                sprintf(hex_dump, "$%04X> %02X %02X%02X:", current_addr, opcode, LOW_PART(word_operand), HIGH_PART(word_operand));
-            }
+        if ((entry->addressing == RELAT) || (entry->addressing == ZEREL))
+            tpl->flags |= TEMPLATE_RELATIVE;
+        if ((entry->addressing == ABSOL) || (entry->addressing == ABSIX) || (entry->addressing == ABSIY))
+            tpl->flags |= TEMPLATE_NES;
+        if ((entry->addressing == BLKTR) || (entry->addressing >= TSTZP))
+            tpl->flags |= TEMPLATE_FORMAT;
+        else if ((entry->addressing != IMMED) && (entry->addressing != IMPLI) && (entry->addressing != ACCUM))
+            tpl->flags |= TEMPLATE_ADDRESS;
+        if ((entry->addressing == ABSOL) && (!strcmp(entry->mnemonic, "JMP") || !strcmp(entry->mnemonic, "JSR")))
+            tpl->flags |= TEMPLATE_JUMP;
+        if ((entry->addressing == ABSOL) && !strcmp(entry->mnemonic, "JSR"))
+            tpl->flags |= TEMPLATE_CALL;
+        if ((entry->addressing == ABSLO) && (!strcmp(entry->mnemonic, "JML") || !strcmp(entry->mnemonic, "JSL")))
+            tpl->flags |= TEMPLATE_JUMP;
+        if ((entry->addressing == ABSLO) && !strcmp(entry->mnemonic, "JSL"))
+            tpl->flags |= TEMPLATE_CALL;
+        for (i = 0; g_stop_mnemonics[i]; i++) {
+            if (!strcmp(entry->mnemonic, g_stop_mnemonics[i]))
+                tpl->flags |= TEMPLATE_STOP;
+        }
 
-            break;
-        case ABSIY:
-            /* Get baser address */
-            LOAD_WORD()
-
-            sprintf(opcode_repr, "%s $%02X%02X,Y", mnemonic, HIGH_PART(word_operand), LOW_PART(word_operand));
-            if (options->hex_output) {
-                HEXDUMP_APPLE_3()
-                sprintf(hex_dump, "$%04X> %02X %02X%02X:", current_addr, opcode, LOW_PART(word_operand), HIGH_PART(word_operand));
-            }
+        /* Cycle annotation from the decoder when the branch target stays on
+           the page of the next instruction, and when it crosses it */
+        code[0] = opcode;
+        dcc6502_decode(&g_dcc, code, MAX_INSTRUCTION_LENGTH, 0x0000, &insn);
+        tpl->cycles_len[0] = append_cycle(tpl->cycles[0], &insn) - tpl->cycles[0];
+        if (tpl->flags & TEMPLATE_RELATIVE)
+            code[tpl->length - 1] = 0x7F;
+        dcc6502_decode(&g_dcc, code, MAX_INSTRUCTION_LENGTH, 0x00F0, &insn);
+        tpl->cycles_len[1] = append_cycle(tpl->cycles[1], &insn) - tpl->cycles[1];
+        code[tpl->length - 1] = 0;
+        code[0] = 0;
+    }
+}
 
-            break;
-        case ZEPIX:
-            /* Get zero-page base address */
-            LOAD_BYTE()
-
-            sprintf(opcode_repr, "%s $%02X,X", mnemonic, byte_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+/* This function returns the target of the relative branch at code, located
+   at addr. The offset is the last byte of the instruction */
+static uint16_t branch_target(const template_t *tpl, const uint8_t *code, uint32_t addr) {
+    return (uint16_t)(addr + tpl->length + (int8_t)code[tpl->length - 1]);
+}
 
-            break;
-        case ZEPIY:
-            /* Get zero-page base address */
-            LOAD_BYTE()
-
-            sprintf(opcode_repr, "%s $%02X,Y", mnemonic, byte_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+/* This function disassembles the instruction at code, located at address
+   PC, and outputs it in *output. code must hold MAX_INSTRUCTION_LENGTH
+   readable bytes. Operands referencing an address with a label in labels
+   are written as that label, labels may be NULL. Returns a pointer past the
+   last character written (not NUL terminated) */
+static char *disassemble(char *output, const uint8_t *code, options_t *options, uint16_t *pc, const uint8_t *labels) {
+    uint16_t          current_addr = *pc;
+    uint8_t           opcode       = code[0];
+    const template_t *tpl          = &g_templates[opcode];
+    const column_t   *column       = &g_columns[COLUMN_STYLE(options)][tpl->length];
+    uint8_t           byte_operand = code[1];
+    uint16_t          word_operand = byte_operand | (((uint16_t)code[2]) << 8);
+    uint16_t          target;
+    dcc6502_insn_t    insn;
+    char             *field;
+    int               crosses_page;
+    int               i;
 
-            break;
-        case INDIN:
-            /* Get zero-page base address */
-            LOAD_BYTE()
-
-            sprintf(opcode_repr, "%s ($%02X,X)", mnemonic, byte_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+    *pc += tpl->length;
 
-            break;
-        case ININD:
-            /* Get zero-page base address */
-            LOAD_BYTE()
-
-            sprintf(opcode_repr, "%s ($%02X),Y", mnemonic, byte_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+    // Compute displacement from first byte after full instruction.
+    if (tpl->flags & TEMPLATE_RELATIVE)
+        word_operand = branch_target(tpl, code, current_addr);
 
-            break;
-        case RELAT:
-            /* Get relative modifier */
-            LOAD_BYTE()
-
-            // Compute displacement from first byte after full instruction.
-            word_operand = current_addr + 2;
-            if (byte_operand > 0x7Fu) {
-                word_operand -= ((~byte_operand & 0x7Fu) + 1);
-            } else {
-                word_operand += byte_operand & 0x7Fu;
-            }
+    // Emit address column, prior to mnemonic
+    memcpy(output, column->text, sizeof(column->text));
+    if (column->addr_slot >= 0)
+        put_hex4(output + column->addr_slot, current_addr);
+    for (i = 0; i < tpl->length; i++) {
+        if (column->byte_slot[i] >= 0)
+            put_hex2(output + column->byte_slot[i], code[i]);
+    }
+    output += column->len;
 
-            sprintf(opcode_repr, "%s $%04X", mnemonic, word_operand);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_2()
-                sprintf(hex_dump, "$%04X> %02X %02X:", current_addr, opcode, byte_operand);
-            }
+    // Emit mnemonic column, patching in the operand digits
+    target = (tpl->digits == 2) ? byte_operand : word_operand;
+    field  = output;
+    if (tpl->flags & TEMPLATE_FORMAT) {
+        dcc6502_decode(&g_dcc, code, MAX_INSTRUCTION_LENGTH, current_addr, &insn);
+        output += dcc6502_format(&insn, output, TEMPLATE_TEXT_SIZE);
+        output  = put_pad(field, output, DUMP_MNEMONIC_WIDTH);
+        *output++ = ';';
+    } else if (labels && (tpl->flags & TEMPLATE_ADDRESS) && labels[target]) {
+        // Replace the '$' and digits by the label, keep the suffix
+        memcpy(output, tpl->text, tpl->slot - 1);
+        output = put_label(output + tpl->slot - 1, labels[target], target);
+        memcpy(output, tpl->text + tpl->slot + tpl->digits, tpl->repr_len - tpl->slot - tpl->digits);
+        output += tpl->repr_len - tpl->slot - tpl->digits;
+        output = put_pad(field, output, DUMP_MNEMONIC_WIDTH);
+        *output++ = ';';
+    } else {
+        memcpy(output, tpl->text, sizeof(tpl->text));
+        if (tpl->digits == 2)
+            put_hex2(output + tpl->slot, byte_operand);
+        else if (tpl->digits == 4)
+            put_hex4(output + tpl->slot, word_operand);
+        output += tpl->text_len;
+    }
+    if (tpl->zp_slot)
+        put_hex2(field + tpl->zp_slot, byte_operand);
 
-            break;
-        case ACCUM:
-            sprintf(opcode_repr, "%s A", mnemonic);
-            if (options->hex_output) {
-                HEXDUMP_APPLE_1()
-                sprintf(hex_dump, "$%04X> %02X:", current_addr, opcode);
-            }
+    // For opcode not found, the template holds the complete line
+    if (tpl->flags & TEMPLATE_INVALID)
+        return output;
 
-            break;
-        default:
-            // Will not happen since each entry in opcode_table has address mode set
-            break;
+    /* Add cycle count if necessary, a branch crosses a page when its target
+       is not on the page of the next instruction, as in dcc6502_decode_p */
+    if (options->cycle_counting && (tpl->flags & TEMPLATE_FORMAT)) {
+        output = append_cycle(output, &insn);
+    } else if (options->cycle_counting) {
+        crosses_page = ((*pc ^ word_operand) & 0xff00u) ? 1 : 0;
+        memcpy(output, tpl->cycles[crosses_page], sizeof(tpl->cycles[0]));
+        output += tpl->cycles_len[crosses_page];
     }
 
-    // Emit disassembly line content, prior to annotation comments
-    if (options->omit_opcodes)
-        hex_dump[0] = '\0';
+    /* Add NES port info if necessary */
+    if (options->nes_mode && (tpl->flags & TEMPLATE_NES)) {
+        output = append_nes(output, word_operand);
+    }
+
+    return output;
+}
+
 
-    len = sprintf(output, DUMP_FORMAT, hex_dump, opcode_repr);
-    output += len;
+/* This function outputs the decoded 65816 instruction insn in the columns
+   of disassemble, with 24-bit addresses. The immediate operand width
+   comes from the register widths insn was decoded with */
+static char *disassemble_long(char *output, options_t *options, const dcc6502_insn_t *insn) {
+    const column_t *column = &g_columns[COLUMN_STYLE(options)][insn->length];
+    char           *field;
+    int             i;
 
-    /* Add cycle count if necessary */
-    if (options->cycle_counting) {
-        output = append_cycle(output, opcode, *pc + 1, word_operand);
+    // Emit address column, prior to mnemonic
+    memcpy(output, column->text, sizeof(column->text));
+    if (column->addr_slot >= 0)
+        put_hex6(output + column->addr_slot, insn->address);
+    for (i = 0; i < insn->length; i++) {
+        if (column->byte_slot[i] >= 0)
+            put_hex2(output + column->byte_slot[i], insn->bytes[i]);
     }
+    output += column->len;
 
-    /* Add NES port info if necessary */
-    switch (g_opcode_table[opcode].addressing) {
-        case ABSOL:
-        case ABSIX:
-        case ABSIY:
-            if (options->nes_mode) {
-                append_nes(output, word_operand);
-            }
-            break;
-        default:
-            /* Other addressing modes: not enough info to add NES register annotation */
-            break;
+    field   = output;
+    output += dcc6502_format(insn, output, TEMPLATE_TEXT_SIZE);
+    output  = put_pad(field, output, DUMP_MNEMONIC_WIDTH);
+    if (insn->flags & BAD)
+        return put_str(output, "; INVALID OPCODE !!!");
+    *output++ = ';';
+
+    if (options->cycle_counting)
+        output = append_cycle(output, insn);
+
+    if (options->nes_mode && (g_templates[insn->opcode].flags & TEMPLATE_NES)) {
+        output = append_nes(output, (uint16_t)insn->operand);
     }
+
+    return output;
 }
 
 static void version(void) {
@@ -954,26 +890,83 @@ static void version(void) {
 static void usage(void) {
     fprintf(stderr,
 "\n"
-"Usage: dcc6502 [options] FILENAME\n"
+"Usage: dcc6502 [options] FILENAME [FILENAME...]\n"
+"  FILENAME     : Binary file to disassemble, - reads standard input\n"
+"                 With several files or a directory, each FILENAME is\n"
+"                 disassembled to FILENAME" LISTING_SUFFIX " (batch mode)\n"
 "  -?           : Show this help message\n"
+"  -@ MANIFEST  : Batch mode: also disassemble each file listed in MANIFEST\n"
+"  -C DIR       : Cache listings of regular files in DIR, keyed by a hash of the input\n"
+"                 bytes and options; see -Z\n"
+"  -D SOCKET    : Daemon mode: serve disassembly requests on the Unix socket SOCKET,\n"
+"                 -j connections at a time (no FILENAME)\n"
 "  -2           : Use 65C02 opcodes\n"
+"  -8           : Use 65816 opcodes: 24-bit addresses, immediates sized by the register\n"
+"                 widths followed through REP, SEP and XCE from reset (linear sweep only)\n"
+"  -I INDEX     : Incremental mode: re-decode only the bytes changed since the run\n"
+"                 that wrote INDEX, then update INDEX (linear sweep of a regular file)\n"
 "  -a           : Apple II/Atari style output\n"
 "  -apple\n"
 "  -b NUM_BYTES : Skip this many bytes of the input file [default: 0x0]\n"
 "  -c           : Enable cycle counting annotations\n"
 "  -d           : Enable hex dump within disassembly\n"
+"  -e ADDRESS   : Add an entry point for -r, may be repeated (implies -r)\n"
+"  -f FORMAT    : Output format: text, bin (fixed-width binary records), jsonl or csv [default: text]\n"
+"  -g PATTERN   : Search mode: disassemble every match of PATTERN in the files, a list of\n"
+"                 opcodes like \"A9 8D 4C\" whose operand bytes match anything, or of whole\n"
+"                 instructions like \"A900 8D??40\" where ?? matches any byte\n"
 "  -h           : Show this help message\n"
+"  -H           : Use HuC6280 (PC Engine) opcodes: block transfers are annotated with\n"
+"                 the cycles of their length operand; use -k 0x2000 for its 8K banks\n"
+"  -j THREADS   : Number of worker threads, for batch mode or to split one file [default: 1]\n"
+"  -k BANK_SIZE : Restart addresses at ORIGIN every BANK_SIZE bytes [default: 0, addresses wrap at $FFFF]\n"
+"                 With -8, at ORIGIN in the next 64K bank\n"
+"  -l           : Generate labels (L_XXXX, sub_XXXX) for referenced addresses\n"
 "  -m NUM_BYTES : Only disassemble the first NUM_BYTES bytes\n"
 "  -n           : Enable NES register annotations\n"
-"  -o ORIGIN    : Set the origin (base address of disassembly) [default: 0x8000]\n"
+"  -N INDEX     : Write an index of the instruction shapes (mnemonic and addressing\n"
+"                 mode, operands ignored) of the files to INDEX, see -Q\n"
+"  -o ORIGIN    : Set the origin (base address of disassembly) [default: 0x8000], 24-bit with -8\n"
+"  -O DIRECTORY : Batch mode: write the listings into DIRECTORY, at the path of each file\n"
+"                 below the directory it was found in\n"
+"  -P CPUFILE   : Use the instruction set defined in the text file CPUFILE, compiled\n"
+"                 once into CPUFILE" CPU_SUFFIX " (see cpu/6502.cpu)\n"
+"  -Q INDEX     : List the files of the -N INDEX containing the shape of the -g pattern\n"
+"                 (no FILENAME, at least 3 instructions)\n"
+"  -r           : Separate code from data by following control flow from the\n"
+"                 origin, the $FFFA-$FFFF vectors and -e entry points\n"
 "  -s           : Assembly style output only (omit address and opcodes) [default OFF]\n"
+"  -S           : Statistics mode: count opcodes, addressing modes, illegal bytes, page\n"
+"                 crossing branches and static cycles, one JSON line per file\n"
+"  -t           : Precede each basic block by its min/max cycle budget, and report\n"
+"                 straight-line paths and loop iterations (called subroutines excluded)\n"
+"  -u OLDFILE   : Diff mode: list the instructions of FILENAME that changed from OLDFILE\n"
+"  -U           : Decode the stable undocumented NMOS opcodes (LAX, SAX, DCP, ISC, SLO,\n"
+"                 RLA, SRE, RRA, ANC, ALR, ARR, SBX, multi-byte NOPs) instead of .byte\n"
 "  -v           : Get only version information\n"
+"  -x           : Precede each label by a cross-reference of its users (implies -l)\n"
+"  -Z BYTES     : Size bound of the -C cache, least recently used entries are evicted\n"
+"                 [default: 256 MB]\n"
 "\n"
 "Examples:\n"
 "\n"
 "\tdcc6502       -o 0xF800 f800.rom\n"
 "\n"
 "\tdcc6502 -a -d -o 0xF800 f800.rom\n"
+"\n"
+"\tdcc6502 -j 8 -O listings roms/\n"
+"\n"
+"\tdcc6502 -d -u game_v1.nes game_v2.nes\n"
+"\n"
+"\tdcc6502 -d -j 8 -g \"A9 8D A9 8D\" roms/\n"
+"\n"
+"\tdcc6502 -N roms.idx roms/ && dcc6502 -Q roms.idx -g \"A9 8D A9 8D\"\n"
+"\n"
+"\tdcc6502 -P cpu/65c02.cpu -o 0xF800 f800.rom\n"
+"\n"
+"\tdcc6502 -8 -d -k 0x8000 -o 0x808000 game.sfc\n"
+"\n"
+"\tdcc6502 -H -c -k 0x2000 -o 0xE000 game.pce\n"
     );
 }
 
@@ -1007,9 +1000,32 @@ static void parse_args(int argc, char *argv[], options_t *options) {
     unsigned long tmp_value;
 
     options->apple2_output  = 0;
+    options->bank_size      = 0; // Default to a single linear address space
+    options->batch          = 0;
+    options->manifest       = NULL;
+    options->socket_path    = NULL;
+    options->cache_dir      = NULL;
+    options->index_path     = NULL;
+    options->diff_path      = NULL;
+    options->pattern        = NULL;
+    options->ngram_output   = NULL;
+    options->ngram_index    = NULL;
+    options->stats          = 0;
+    options->cache_size     = CACHE_DEFAULT_SIZE;
+    options->num_entry_points = 0;
+    options->num_threads    = 1;
+    options->recursive      = 0;
+    options->labels         = 0;
+    options->xref           = 0;
+    options->timing         = 0;
+    options->image          = 0;
+    options->cpu            = DCC6502_CPU_6502;
+    options->cpu_path       = NULL;
+    options->format         = FORMAT_TEXT;
+    options->output_dir     = NULL;
     options->cycle_counting = 0;
     options->hex_output     = 0;
-    options->max_num_bytes  = 65536; // Default to entire file
+    options->max_num_bytes  = 0; // Default to entire file
     options->nes_mode       = 0;
     options->omit_opcodes   = 0;
     options->org            = 0x8000;
@@ -1017,8 +1033,8 @@ static void parse_args(int argc, char *argv[], options_t *options) {
     options->user_length    = 0; // False=read default 64K, True=user provided num bytes to read
 
     while (arg_idx < argc) {
-        /* First non-dash-starting argument is assumed to be filename */
-        if (argv[arg_idx][0] != '-') {
+        /* First non-dash-starting argument, or a lone dash, is assumed to be filename */
+        if ((argv[arg_idx][0] != '-') || (argv[arg_idx][1] == '\0')) {
             break;
         }
 
@@ -1029,7 +1045,28 @@ static void parse_args(int argc, char *argv[], options_t *options) {
                 usage_and_exit(0, NULL);
                 break;
             case '2':
-                g_opcode_table = g_65C02_opcodes;
+                if (DCC6502_CPU_6502_UNDOC == options->cpu) {
+                    usage_and_exit(1, "-U decodes NMOS opcodes, it takes no -2");
+                }
+                if (DCC6502_CPU_65816 == options->cpu) {
+                    usage_and_exit(1, "-8 decodes 65816 opcodes, it takes no -2, -H or -U");
+                }
+                if (DCC6502_CPU_HUC6280 == options->cpu) {
+                    usage_and_exit(1, "-H decodes HuC6280 opcodes, it takes no -2, -8 or -U");
+                }
+                options->cpu = DCC6502_CPU_65C02;
+                break;
+            case '8':
+                if (DCC6502_CPU_6502 != options->cpu) {
+                    usage_and_exit(1, "-8 decodes 65816 opcodes, it takes no -2, -H or -U");
+                }
+                options->cpu = DCC6502_CPU_65816;
+                break;
+            case 'H':
+                if (DCC6502_CPU_6502 != options->cpu) {
+                    usage_and_exit(1, "-H decodes HuC6280 opcodes, it takes no -2, -8 or -U");
+                }
+                options->cpu = DCC6502_CPU_HUC6280;
                 break;
             case 'a':
                 /* Optional long form */
@@ -1056,6 +1093,73 @@ static void parse_args(int argc, char *argv[], options_t *options) {
             case 'd':
                 options->hex_output = 1;
                 break;
+            case '@':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -@ switch");
+                }
+
+                arg_idx++;
+                options->manifest = argv[arg_idx];
+                break;
+            case 'e':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -e switch");
+                }
+
+                /* Get argument and parse it */
+                arg_idx++;
+                if (!str_arg_to_ulong(argv[arg_idx], &tmp_value) || (tmp_value > 0xFFFF)) {
+                    usage_and_exit(1, "Invalid argument to -e switch");
+                }
+                if (options->num_entry_points == MAX_ENTRY_POINTS) {
+                    usage_and_exit(1, "Too many -e entry points");
+                }
+                options->entry_points[options->num_entry_points++] = (uint16_t)tmp_value;
+                options->recursive = 1;
+                options->image     = 1;
+                break;
+            case 'f':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -f switch");
+                }
+
+                arg_idx++;
+                if (!strcmp(argv[arg_idx], "text")) {
+                    options->format = FORMAT_TEXT;
+                } else if (!strcmp(argv[arg_idx], "bin")) {
+                    options->format = FORMAT_BIN;
+                } else if (!strcmp(argv[arg_idx], "jsonl")) {
+                    options->format = FORMAT_JSONL;
+                } else if (!strcmp(argv[arg_idx], "csv")) {
+                    options->format = FORMAT_CSV;
+                } else {
+                    usage_and_exit(1, "Invalid argument to -f switch");
+                }
+                break;
+            case 'j':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -j switch");
+                }
+
+                /* Get argument and parse it */
+                arg_idx++;
+                if (!str_arg_to_ulong(argv[arg_idx], &tmp_value) || (tmp_value < 1) || (tmp_value > MAX_THREADS)) {
+                    usage_and_exit(1, "Invalid argument to -j switch");
+                }
+                options->num_threads = (int)tmp_value;
+                break;
+            case 'k':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -k switch");
+                }
+
+                /* Get argument and parse it */
+                arg_idx++;
+                if (!str_arg_to_ulong(argv[arg_idx], &tmp_value)) {
+                    usage_and_exit(1, "Invalid argument to -k switch");
+                }
+                options->bank_size = tmp_value;
+                break;
             case 'm':
                 if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
                     usage_and_exit(1, "Missing argument to -m switch");
@@ -1066,8 +1170,6 @@ static void parse_args(int argc, char *argv[], options_t *options) {
                 if (!str_arg_to_ulong(argv[arg_idx], &tmp_value)) {
                     usage_and_exit(1, "Invalid argument to -m switch");
                 }
-                if (tmp_value > 0x10000)
-                    tmp_value = 0x10000;
                 options->max_num_bytes = tmp_value;
                 options->user_length   = 1;
                 break;
@@ -1081,113 +1183,3910 @@ static void parse_args(int argc, char *argv[], options_t *options) {
                 if (!str_arg_to_ulong(argv[arg_idx], &tmp_value)) {
                     usage_and_exit(1, "Invalid argument to -o switch");
                 }
-                options->org = (uint16_t)(tmp_value & 0xFFFFu);
+                options->org = (uint32_t)(tmp_value & 0xFFFFFFu); // 16 bits unless -8, see below
                 break;
             case 'n':
                 options->nes_mode = 1;
                 break;
-            case 's':
-                options->omit_opcodes = 1;
+            case 'C':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -C switch");
+                }
+
+                arg_idx++;
+                options->cache_dir = argv[arg_idx];
                 break;
-            case 'v':
-                version();
-                exit(0);
+            case 'g':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -g switch");
+                }
+
+                arg_idx++;
+                options->pattern = argv[arg_idx];
                 break;
-            default:
-unknown:
-                version();
-                usage();
-                fprintf(stderr, "Unrecognized switch: %s\n", argv[arg_idx]);
-                exit(1);
-        }
-        arg_idx++;
-    }
+            case 'S':
+                options->stats = 1;
+                break;
+            case 'N':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -N switch");
+                }
 
-    /* Make sure we have a filename left to take after we stopped parsing switches */
-    if (arg_idx >= argc) {
-        usage_and_exit(1, "Missing filename from command line");
-    }
+                arg_idx++;
+                options->ngram_output = argv[arg_idx];
+                break;
+            case 'U':
+                if (DCC6502_CPU_65C02 == options->cpu) {
+                    usage_and_exit(1, "-U decodes NMOS opcodes, it takes no -2");
+                }
+                if (DCC6502_CPU_65816 == options->cpu) {
+                    usage_and_exit(1, "-8 decodes 65816 opcodes, it takes no -2, -H or -U");
+                }
+                if (DCC6502_CPU_HUC6280 == options->cpu) {
+                    usage_and_exit(1, "-H decodes HuC6280 opcodes, it takes no -2, -8 or -U");
+                }
+                options->cpu = DCC6502_CPU_6502_UNDOC;
+                break;
+            case 'P':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -P switch");
+                }
 
-    options->filename = argv[arg_idx];
-}
+                arg_idx++;
+                options->cpu_path = argv[arg_idx];
+                break;
+            case 'Q':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -Q switch");
+                }
 
-int main(int argc, char *argv[]) {
-    char      tmpstr[512];
-    uint8_t  *buffer;     /* Memory buffer */
-    FILE     *input_file; /* Input file */
-    uint16_t  pc;         /* Program counter */
-    size_t    end;
-    options_t options;    /* Command-line options parsing results */
+                arg_idx++;
+                options->ngram_index = argv[arg_idx];
+                break;
+            case 'u':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -u switch");
+                }
 
-    parse_args(argc, argv, &options);
+                arg_idx++;
+                options->diff_path = argv[arg_idx];
+                break;
+            case 'I':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -I switch");
+                }
 
-    buffer = calloc(1, 65536 + 4); // fix array out-of-bounds buffer overflow
-    if (NULL == buffer) {
-        usage_and_exit(3, "Could not allocate disassembly memory buffer.");
-    }
+                arg_idx++;
+                options->index_path = argv[arg_idx];
+                break;
+            case 'Z':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -Z switch");
+                }
 
-    /* Read file into memory buffer */
-    input_file = fopen(options.filename, "rb");
+                arg_idx++;
+                if (!str_arg_to_ulong(argv[arg_idx], &options->cache_size)) {
+                    usage_and_exit(1, "Invalid argument to -Z switch");
+                }
+                break;
+            case 'D':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -D switch");
+                }
+
+                arg_idx++;
+                options->socket_path = argv[arg_idx];
+                break;
+            case 'O':
+                if ((arg_idx == (argc - 1)) || (argv[arg_idx + 1][0] == '-')) {
+                    usage_and_exit(1, "Missing argument to -O switch");
+                }
+
+                arg_idx++;
+                options->output_dir = argv[arg_idx];
+                break;
+            case 'l':
+                options->labels = 1;
+                options->image  = 1;
+                break;
+            case 'r':
+                options->recursive = 1;
+                options->image     = 1;
+                break;
+            case 's':
+                options->omit_opcodes = 1;
+                break;
+            case 't':
+                options->timing = 1;
+                options->image  = 1;
+                break;
+            case 'x':
+                options->labels = 1;
+                options->xref   = 1;
+                options->image  = 1;
+                break;
+            case 'v':
+                version();
+                exit(0);
+                break;
+            default:
+unknown:
+                version();
+                usage();
+                fprintf(stderr, "Unrecognized switch: %s\n", argv[arg_idx]);
+                exit(1);
+        }
+        arg_idx++;
+    }
+
+    /* Make sure we have a filename left to take after we stopped parsing switches */
+    if ((arg_idx >= argc) && (NULL == options->manifest) && (NULL == options->socket_path) && (NULL == options->ngram_index)) {
+        usage_and_exit(1, "Missing filename from command line");
+    }
+
+    options->filenames = &argv[arg_idx];
+    options->num_files = argc - arg_idx;
+    options->filename  = (arg_idx < argc) ? argv[arg_idx] : options->manifest;
+
+    if ((NULL != options->index_path) && (options->image || (options->num_files > 1) || (NULL != options->manifest))) {
+        usage_and_exit(1, "-I needs a single file and no -r, -l, -x or -t");
+    }
+    if ((NULL != options->diff_path) && (options->image || (options->num_files > 1) || (NULL != options->manifest) ||
+        (NULL != options->index_path) || (FORMAT_TEXT != options->format))) {
+        usage_and_exit(1, "-u needs a single file, text output and no -r, -l, -x, -t or -I");
+    }
+    if ((NULL != options->pattern) && (options->image || (NULL != options->index_path) ||
+        (NULL != options->diff_path) || (FORMAT_TEXT != options->format))) {
+        usage_and_exit(1, "-g needs text output and no -r, -l, -x, -t, -I or -u");
+    }
+    if ((NULL != options->ngram_index) && (NULL == options->pattern)) {
+        usage_and_exit(1, "-Q needs the -g pattern to look up");
+    }
+    if (options->stats && (options->image || (NULL != options->index_path) || (NULL != options->diff_path) ||
+        (NULL != options->pattern) || (NULL != options->ngram_output) || (FORMAT_TEXT != options->format))) {
+        usage_and_exit(1, "-S counts instructions, it takes no -r, -l, -x, -t, -I, -u, -g, -N or -f");
+    }
+    if ((NULL != options->ngram_output) && (NULL != options->pattern)) {
+        usage_and_exit(1, "-N writes an index, use -Q to look up a -g pattern");
+    }
+    if ((NULL != options->cpu_path) && (DCC6502_CPU_6502 != options->cpu) && (DCC6502_CPU_65816 != options->cpu) &&
+        (DCC6502_CPU_HUC6280 != options->cpu)) {
+        usage_and_exit(1, "-P replaces the instruction set, it takes no -2 or -U");
+    }
+    if (LONG_ADDRESSES(options) && (options->image || (NULL != options->index_path) || (NULL != options->diff_path) ||
+        (NULL != options->pattern) || (NULL != options->ngram_output) || (NULL != options->ngram_index) || options->stats ||
+        (NULL != options->socket_path))) {
+        usage_and_exit(1, "-8 follows the register widths by linear sweep, it takes no -r, -l, -x, -t, -I, -u, -g, -N, -Q, -S or -D");
+    }
+    if (!LONG_ADDRESSES(options)) {
+        options->org &= 0xFFFFu;
+    }
+}
+
+/* This function emits an ORG line, and a bank comment when bank is non-zero */
+static char *emit_org(char *output, options_t *options, unsigned long bank, uint32_t org) {
+    char *field;
+
+    if (bank) {
+        output = put_str(output, "; BANK ");
+        output = put_dec(output, bank);
+        *output++ = '\n';
+    }
+
+    output = put_pad(output, output, DUMP_ADDR_WIDTH);
+    field  = output;
+    output = put_str(output, "ORG $");
+    output = LONG_ADDRESSES(options) ? put_hex6(output, org) : put_hex4(output, (uint16_t)org);
+    output = put_pad(field, output, DUMP_MNEMONIC_WIDTH);
+    *output++ = ';';
+    *output++ = '\n';
+    return output;
+}
+
+/* This function writes the operand text of insn, e.g. "$1234,X": the
+   assembly text past the mnemonic */
+static char *put_operand(char *output, const dcc6502_insn_t *insn) {
+    char  text[32];
+    char *operand;
+
+    if (insn->flags & BAD)
+        return output;
+
+    dcc6502_format(insn, text, sizeof(text));
+    operand = strchr(text, ' ');
+    return (NULL != operand) ? put_str(output, operand + 1) : output;
+}
+
+/* This function emits the decoded instruction insn as a binary record, a
+   JSON line or a CSV line */
+static char *emit_insn(char *output, options_t *options, const dcc6502_insn_t *insn) {
+    const char    *mode;
+    char           nes[64];
+    int            nes_len = 0;
+    int            i;
+
+    if (FORMAT_BIN == options->format)
+        return output + dcc6502_record(insn, (uint8_t *)output);
+
+    mode = (insn->flags & BAD) ? "illegal" : dcc6502_addressing(insn->addressing)->name;
+    if (options->nes_mode && (g_templates[insn->opcode].flags & TEMPLATE_NES))
+        nes_len = append_nes(nes, (uint16_t)insn->operand) - nes;
+    if (nes_len)
+        nes_len -= NES_PREFIX_LENGTH;
+
+    if (FORMAT_JSONL == options->format) {
+        output = put_str(output, "{\"address\":");
+        output = put_dec(output, insn->address);
+        output = put_str(output, ",\"bytes\":\"");
+        for (i = 0; i < insn->length; i++)
+            output = put_hex2(output, insn->bytes[i]);
+        output = put_str(output, "\",\"mnemonic\":\"");
+        output = put_str(output, g_dcc.table[insn->opcode].mnemonic);
+        output = put_str(output, "\",\"mode\":\"");
+        output = put_str(output, mode);
+        output = put_str(output, "\",\"operand\":\"");
+        output = put_operand(output, insn);
+        output = put_str(output, "\",\"target\":");
+        output = put_dec(output, insn->target);
+        output = put_str(output, ",\"cycles_min\":");
+        output = put_dec(output, insn->cycles_min);
+        output = put_str(output, ",\"cycles_max\":");
+        output = put_dec(output, insn->cycles_max);
+        if (nes_len) {
+            output = put_str(output, ",\"nes\":\"");
+            memcpy(output, nes + NES_PREFIX_LENGTH, nes_len);
+            output += nes_len;
+            *output++ = '"';
+        }
+        *output++ = '}';
+    } else {
+        output = put_dec(output, insn->address);
+        *output++ = ',';
+        for (i = 0; i < insn->length; i++)
+            output = put_hex2(output, insn->bytes[i]);
+        *output++ = ',';
+        output = put_str(output, g_dcc.table[insn->opcode].mnemonic);
+        output = put_str(output, ",\"");
+        output = put_str(output, mode);
+        output = put_str(output, "\",\"");
+        output = put_operand(output, insn);
+        output = put_str(output, "\",");
+        output = put_dec(output, insn->target);
+        *output++ = ',';
+        output = put_dec(output, insn->cycles_min);
+        *output++ = ',';
+        output = put_dec(output, insn->cycles_max);
+        *output++ = ',';
+        if (nes_len) {
+            *output++ = '"';
+            memcpy(output, nes + NES_PREFIX_LENGTH, nes_len);
+            output += nes_len;
+            *output++ = '"';
+        }
+    }
+    *output++ = '\n';
+    return output;
+}
+
+/* This function emits the instruction at code, located at address PC, as
+   a binary record, a JSON line or a CSV line. code must hold
+   MAX_INSTRUCTION_LENGTH readable bytes */
+static char *emit_record(char *output, const uint8_t *code, options_t *options, uint16_t *pc) {
+    dcc6502_insn_t insn;
+
+    dcc6502_decode(&g_dcc, code, MAX_INSTRUCTION_LENGTH, *pc, &insn);
+    *pc += insn.length;
+    return emit_insn(output, options, &insn);
+}
+
+/* Address of the byte at offset from start_offset */
+static uint16_t sweep_address(options_t *options, unsigned long offset) {
+    if (options->bank_size) {
+        return options->org + (offset % options->bank_size);
+    }
+    return options->org + offset;
+}
+
+/* 65816 address of the byte at offset from start_offset. With a bank
+   layout, each bank_size bytes are mapped at the origin of the next 64K bank */
+static uint32_t sweep_address_long(options_t *options, unsigned long offset) {
+    if (options->bank_size) {
+        return (options->org + ((offset / options->bank_size) << 16) + (offset % options->bank_size)) & 0xffffffu;
+    }
+    return (options->org + offset) & 0xffffffu;
+}
+
+/* Write part of the listing to the stream, and to the result cache entry
+   being filled if any */
+static void sweep_write(sweep_t *sweep, const char *output, size_t len) {
+    flush_output(sweep->stream, output, len);
+    if (NULL != sweep->cache)
+        flush_output(sweep->cache, output, len);
+}
+
+/* Make room in the output buffer for the next lines: flush it to the
+   stream, or when the listing is collected in memory, grow it */
+static char *sweep_reserve(sweep_t *sweep, char *out) {
+    size_t used = out - sweep->output;
+
+    if (NULL != sweep->stream) {
+        sweep_write(sweep, sweep->output, used);
+        return sweep->output;
+    }
+
+    sweep->output_size *= 2;
+    sweep->output       = realloc(sweep->output, sweep->output_size);
+    if (NULL == sweep->output) {
+        usage_and_exit(3, "Could not allocate output buffer.");
+    }
+    return sweep->output + used;
+}
+
+/* This function records the register widths of the 65816 instruction insn,
+   decoded in state p, at the code address it jumps or branches to. The
+   first jump or branch to an address wins */
+static void sweep_mark(sweep_t *sweep, const dcc6502_insn_t *insn, unsigned int p) {
+    const template_t *tpl = &g_templates[insn->opcode];
+    uint32_t          target;
+
+    if (insn->flags & BAD)
+        return;
+    if ((tpl->flags & TEMPLATE_RELATIVE) || ((RELLO == insn->addressing) && (tpl->flags & TEMPLATE_STOP)))
+        target = insn->target; // Branches, BRL
+    else if ((tpl->flags & TEMPLATE_JUMP) && (ABSOL == insn->addressing))
+        target = (insn->address & 0xff0000u) | insn->target; // JMP, JSR within the bank
+    else if (tpl->flags & TEMPLATE_JUMP)
+        target = insn->target; // JML, JSL
+    else
+        return;
+
+    if (!WIDTH_GET(sweep->widths, target))
+        WIDTH_SET(sweep->widths, target, WIDTH_KNOWN | ((p & (DCC6502_P_M | DCC6502_P_X)) >> 3) | ((p & DCC6502_P_E) ? 8 : 0));
+}
+
+/* This function is sweep_range for the 65816. The register widths that
+   size immediate operands follow REP, SEP and XCE from one instruction to
+   the next; after an instruction that does not fall through, the widths
+   recorded by an earlier jump or branch to the address take over. Each
+   byte is visited once, so a multi-megabyte ROM is swept in linear time */
+static size_t sweep_long(sweep_t *sweep, const uint8_t *code, size_t count) {
+    options_t      *options = sweep->options;
+    char           *out     = sweep->out;
+    size_t          pos     = 0;
+    dcc6502_insn_t  insn;
+    unsigned int    width;
+    uint32_t        pc;
+
+    while (pos < count) {
+        if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+            out = sweep_reserve(sweep, out);
+
+        pc = sweep_address_long(options, sweep->offset);
+
+        if (FORMAT_TEXT != options->format) {
+            // Records carry their own address
+        } else if (options->bank_size && ((sweep->offset / options->bank_size) != sweep->bank)) {
+            // Entered the next bank, start a new section
+            sweep->bank = sweep->offset / options->bank_size;
+            out = emit_org(out, options, sweep->bank, pc);
+        } else if (pc < sweep->last_pc) {
+            // Addresses wrapped around, start a new section
+            out = emit_org(out, options, 0, pc);
+        }
+        sweep->last_pc = pc;
+
+        if (sweep->stopped && (0 != (width = WIDTH_GET(sweep->widths, pc))))
+            sweep->p = ((width & 6) << 3) | ((width & 8) ? DCC6502_P_E : 0);
+
+        dcc6502_decode_p(&g_dcc, &code[pos], MAX_INSTRUCTION_LENGTH, pc, sweep->p, &insn);
+        sweep_mark(sweep, &insn, sweep->p);
+        sweep->p       = dcc6502_track(&insn, sweep->p);
+        sweep->stopped = !(insn.flags & BAD) && (g_templates[insn.opcode].flags & TEMPLATE_STOP);
+
+        if (FORMAT_TEXT != options->format) {
+            out = emit_insn(out, options, &insn);
+        } else {
+            out = disassemble_long(out, options, &insn);
+            *out++ = '\n';
+        }
+
+        pos           += insn.length;
+        sweep->offset += insn.length;
+    }
+
+    sweep->out = out;
+    return pos;
+}
+
+/* This function disassembles the instructions starting in the first count
+   bytes of code, continuing the linear sweep at sweep->offset. code must
+   hold count + MAX_INSTRUCTION_LENGTH - 1 readable bytes. Addresses wrap
+   around at $FFFF, or restart at the origin every bank_size bytes when a
+   bank layout is given. Returns the number of bytes consumed, which may
+   exceed count when the last instruction straddles the end */
+static size_t sweep_range(sweep_t *sweep, const uint8_t *code, size_t count) {
+    options_t *options = sweep->options;
+    char      *out     = sweep->out;
+    size_t     pos     = 0;
+    uint16_t   pc;
+
+    if (NULL != sweep->widths)
+        return sweep_long(sweep, code, count);
+
+    while (pos < count) {
+        if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+            out = sweep_reserve(sweep, out);
+
+        pc = sweep_address(options, sweep->offset);
+
+        if (FORMAT_TEXT != options->format) {
+            // Records carry their own address
+        } else if (options->bank_size && ((sweep->offset / options->bank_size) != sweep->bank)) {
+            // Entered the next bank, start a new section
+            sweep->bank = sweep->offset / options->bank_size;
+            out = emit_org(out, options, sweep->bank, pc);
+        } else if (pc < sweep->last_pc) {
+            // Addresses wrapped around, start a new section
+            out = emit_org(out, options, 0, pc);
+        }
+        sweep->last_pc = pc;
+
+        if (FORMAT_TEXT != options->format) {
+            out = emit_record(out, &code[pos], options, &pc);
+        } else {
+            out = disassemble(out, &code[pos], options, &pc, NULL);
+            *out++ = '\n';
+        }
+
+        pos           += (uint16_t)(pc - sweep->last_pc);
+        sweep->offset += (uint16_t)(pc - sweep->last_pc);
+    }
+
+    sweep->out = out;
+    return pos;
+}
+
+static void sweep_init(sweep_t *sweep, options_t *options, char *output, size_t output_size, FILE *stream) {
+    sweep->options     = options;
+    sweep->output      = output;
+    sweep->output_size = output_size;
+    sweep->out         = output;
+    sweep->stream  = stream;
+    sweep->cache   = NULL;
+    sweep->offset  = 0;
+    sweep->bank    = 0;
+    sweep->last_pc = options->org;
+    sweep->widths  = NULL;
+    sweep->p       = DCC6502_P_RESET;
+    sweep->stopped = 0;
+}
+
+static void sweep_flush(sweep_t *sweep) {
+    if (NULL == sweep->stream)
+        return;
+
+    sweep_write(sweep, sweep->output, sweep->out - sweep->output);
+    sweep->out = sweep->output;
+}
+
+/* This function disassembles max_num_bytes bytes of input_file through a
+   fixed size sliding window, so memory use does not depend on file size.
+   This is the read path used for pipes, stdin and unmappable files */
+static void disassemble_stream(FILE *input_file, sweep_t *sweep, uint8_t *window) {
+    options_t     *options = sweep->options;
+    unsigned long  to_read = options->max_num_bytes; /* Bytes not yet read into the window */
+    size_t         pos     = 0;                      /* Window position of the next instruction */
+    size_t         avail   = 0;                      /* Bytes held in the window */
+    size_t         count;
+    size_t         want;
+    size_t         got;
+
+    while (sweep->offset < options->max_num_bytes) {
+        /* Slide the window when the next instruction could straddle its end */
+        if ((pos + MAX_INSTRUCTION_LENGTH) > avail) {
+            if (pos < avail) {
+                memmove(window, &window[pos], avail - pos);
+                avail -= pos;
+            } else {
+                avail = 0;
+            }
+            pos = 0;
+
+            if (to_read) {
+                want    = (to_read < (STREAM_WINDOW_SIZE - avail)) ? to_read : (STREAM_WINDOW_SIZE - avail);
+                got     = fread(&window[avail], 1, want, input_file);
+                to_read = (got < want) ? 0 : (to_read - got); // Short read: end of input
+                avail  += got;
+            }
+
+            // Bytes past the end of the input read as zero
+            memset(&window[avail], 0, MAX_INSTRUCTION_LENGTH);
+            if (!avail)
+                break;
+        }
+
+        // Until the input is exhausted, keep the bytes an instruction could straddle for the next window
+        count = avail - pos;
+        if (to_read)
+            count -= MAX_INSTRUCTION_LENGTH - 1;
+
+        pos += sweep_range(sweep, &window[pos], count);
+    }
+
+    sweep_flush(sweep);
+}
+
+/* This function disassembles the instructions of data, which holds length
+   bytes, that start between sweep->offset and end. Instructions are decoded
+   straight from data; only the last ones go through a small zero padded
+   copy, so they never read past the end of data */
+static void sweep_mapped(sweep_t *sweep, const uint8_t *data, unsigned long length, unsigned long end) {
+    unsigned long safe = (length >= MAX_INSTRUCTION_LENGTH) ? (length - (MAX_INSTRUCTION_LENGTH - 1)) : 0;
+    uint8_t       tail[2 * MAX_INSTRUCTION_LENGTH];
+
+    if (sweep->offset < safe)
+        sweep_range(sweep, &data[sweep->offset], ((end < safe) ? end : safe) - sweep->offset);
+
+    if (sweep->offset < end) {
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, &data[sweep->offset], length - sweep->offset);
+        sweep_range(sweep, tail, end - sweep->offset);
+    }
+}
+
+/* This function disassembles max_num_bytes bytes of a file mapped in memory,
+   decoding straight from the mapped pages */
+static void disassemble_mapped(const uint8_t *data, sweep_t *sweep) {
+    sweep_mapped(sweep, data, sweep->options->max_num_bytes, sweep->options->max_num_bytes);
+    sweep_flush(sweep);
+}
+
+static double elapsed_seconds(void) {
+#if HAVE_POSIX
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/* Run worker on num_threads threads, the calling thread being one of them.
+   Returns the number of threads that ran */
+static int run_workers(int num_threads, void *(*worker)(void *), void *arg) {
+#if HAVE_POSIX
+    pthread_t threads[MAX_THREADS];
+    int       i;
+
+    for (i = 1; i < num_threads; i++) {
+        if (0 != pthread_create(&threads[i], NULL, worker, arg)) {
+            num_threads = i;
+            break;
+        }
+    }
+    worker(arg);
+    for (i = 1; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+    return num_threads;
+#else
+    (void)num_threads;
+    worker(arg);
+    return 1;
+#endif
+}
+
+/* Take the next chunk of the current round, or -1 when the round is done */
+static long parallel_next(parallel_t *parallel) {
+    long index = -1;
+
+    LOCK(&parallel->lock);
+    if (parallel->next < parallel->round_end)
+        index = (long)parallel->next++;
+    UNLOCK(&parallel->lock);
+    return index;
+}
+
+/* Phase 1: for each possible entry into the chunk (the previous chunk's
+   last instruction may overrun into it by up to MAX_INSTRUCTION_LENGTH - 1
+   bytes), find where the instruction stream leaves the chunk. The entry
+   candidates are walked in lockstep and merge as soon as they land on the
+   same instruction, so this costs about one length-only pass */
+static void *parallel_scan(void *arg) {
+    parallel_t          *parallel = arg;
+    chunk_t             *chunk;
+    unsigned long        pos[MAX_INSTRUCTION_LENGTH];
+    unsigned long        last[MAX_INSTRUCTION_LENGTH];
+    int                  root[MAX_INSTRUCTION_LENGTH];
+    long                 index;
+    int                  c, d, lowest;
+
+    while ((index = parallel_next(parallel)) >= 0) {
+        chunk = &parallel->chunks[index];
+
+        for (c = 0; c < MAX_INSTRUCTION_LENGTH; c++) {
+            pos[c]  = chunk->begin + c;
+            last[c] = UNKNOWN_SIZE;
+            root[c] = c;
+        }
+
+        for (;;) {
+            // Advance the live candidate that is furthest behind
+            lowest = -1;
+            for (c = 0; c < MAX_INSTRUCTION_LENGTH; c++) {
+                if ((root[c] == c) && (pos[c] < chunk->end) && ((lowest < 0) || (pos[c] < pos[lowest])))
+                    lowest = c;
+            }
+            if (lowest < 0)
+                break;
+
+            last[lowest]  = pos[lowest];
+            pos[lowest]  += g_templates[parallel->data[pos[lowest]]].length;
+
+            // Merge with any candidate that already decoded from there. Past
+            // the end, candidates that exit at the same place stay apart
+            // since their last instructions differ
+            for (d = 0; (d < MAX_INSTRUCTION_LENGTH) && (pos[lowest] < chunk->end); d++) {
+                if ((d != lowest) && (root[d] == d) && (pos[d] == pos[lowest]))
+                    root[(d < lowest) ? lowest : d] = (d < lowest) ? d : lowest;
+            }
+        }
+
+        for (c = 0; c < MAX_INSTRUCTION_LENGTH; c++) {
+            d = c;
+            while (root[d] != d)
+                d = root[d];
+            chunk->exit[c] = pos[d];
+            chunk->last[c] = ((chunk->begin + c) < chunk->end) ? last[d] : UNKNOWN_SIZE;
+        }
+    }
+    return NULL;
+}
+
+/* Phase 3: format each chunk of the round from its resolved entry into
+   the listing buffer of its slot, which is kept for the next rounds */
+static void *parallel_format(void *arg) {
+    parallel_t *parallel = arg;
+    options_t  *options  = parallel->options;
+    chunk_t    *chunk;
+    sweep_t     sweep;
+    size_t      slot;
+    long        index;
+
+    while ((index = parallel_next(parallel)) >= 0) {
+        chunk = &parallel->chunks[index];
+        slot  = index - parallel->round_begin;
+
+        sweep_init(&sweep, options, parallel->listing[slot], parallel->listing_size[slot], NULL);
+        sweep.offset = chunk->entry;
+        if (UNKNOWN_SIZE != chunk->prev) {
+            sweep.last_pc = sweep_address(options, chunk->prev);
+            sweep.bank    = options->bank_size ? (chunk->prev / options->bank_size) : 0;
+        }
+
+        sweep_mapped(&sweep, parallel->data, options->max_num_bytes, chunk->end);
+
+        parallel->listing[slot]      = sweep.output;
+        parallel->listing_size[slot] = sweep.output_size;
+        chunk->listing_len           = sweep.out - sweep.output;
+    }
+
+    return NULL;
+}
+
+/* This function disassembles a file mapped in memory across the worker
+   threads. The input is split into chunks which are scanned in parallel
+   from every possible entry offset, then stitched together by following
+   where each chunk's instruction stream lands in the next one, and
+   finally formatted in parallel. The output is identical to the
+   sequential linear sweep */
+static void disassemble_parallel(const uint8_t *data, sweep_t *sweep) {
+    options_t     *options = sweep->options;
+    unsigned long  length  = options->max_num_bytes;
+    unsigned long  chunk_size;
+    parallel_t     parallel;
+    chunk_t       *chunk;
+    size_t         i, c;
+    double         start, seconds;
+    int            num_threads = options->num_threads;
+
+    start = elapsed_seconds();
+
+    chunk_size = (length + num_threads - 1) / num_threads;
+    if (chunk_size > PARALLEL_CHUNK_SIZE)
+        chunk_size = PARALLEL_CHUNK_SIZE;
+    if (chunk_size < PARALLEL_MIN_CHUNK_SIZE)
+        chunk_size = PARALLEL_MIN_CHUNK_SIZE;
+
+    memset(&parallel, 0, sizeof(parallel));
+    parallel.options    = options;
+    parallel.data       = data;
+    parallel.num_chunks = (length + chunk_size - 1) / chunk_size;
+    parallel.chunks     = calloc(parallel.num_chunks, sizeof(chunk_t));
+    if (NULL == parallel.chunks) {
+        usage_and_exit(3, "Could not allocate chunk table.");
+    }
+
+    for (i = 0; i < parallel.num_chunks; i++) {
+        parallel.chunks[i].begin = i * chunk_size;
+        parallel.chunks[i].end   = (i == (parallel.num_chunks - 1)) ? length : ((i + 1) * chunk_size);
+    }
+
+    LOCK_INIT(&parallel.lock);
+
+    /* Phase 1: scan every chunk from every entry candidate */
+    parallel.next      = 0;
+    parallel.round_end = parallel.num_chunks;
+    num_threads = run_workers(num_threads, parallel_scan, &parallel);
+
+    /* Phase 2: stitch, the first chunk is entered at its first byte */
+    parallel.chunks[0].entry = 0;
+    parallel.chunks[0].prev  = UNKNOWN_SIZE;
+    for (i = 1; i < parallel.num_chunks; i++) {
+        chunk = &parallel.chunks[i - 1];
+        c     = chunk->entry - chunk->begin;
+        parallel.chunks[i].entry = chunk->exit[c];
+        parallel.chunks[i].prev  = (UNKNOWN_SIZE != chunk->last[c]) ? chunk->last[c] : chunk->prev;
+    }
+
+    /* Phase 3: format the chunks in rounds, writing each round in order so
+       only a bounded amount of listing is held in memory */
+    sweep_flush(sweep);
+    for (c = 0; c < (size_t)num_threads; c++) {
+        parallel.listing_size[c] = OUTPUT_BUFFER_SIZE;
+        parallel.listing[c]      = malloc(OUTPUT_BUFFER_SIZE);
+        if (NULL == parallel.listing[c]) {
+            usage_and_exit(3, "Could not allocate output buffer.");
+        }
+    }
+
+    for (i = 0; i < parallel.num_chunks; i = parallel.round_end) {
+        parallel.next        = i;
+        parallel.round_begin = i;
+        parallel.round_end   = i + num_threads;
+        if (parallel.round_end > parallel.num_chunks)
+            parallel.round_end = parallel.num_chunks;
+
+        run_workers(num_threads, parallel_format, &parallel);
+
+        for (c = i; c < parallel.round_end; c++)
+            sweep_write(sweep, parallel.listing[c - i], parallel.chunks[c].listing_len);
+    }
+
+    for (c = 0; c < (size_t)num_threads; c++)
+        free(parallel.listing[c]);
+
+    LOCK_DESTROY(&parallel.lock);
+    free(parallel.chunks);
+
+    seconds = elapsed_seconds() - start;
+    if (seconds <= 0.0)
+        seconds = 1e-9;
+
+    fprintf(stderr, ";INFORMATION: Disassembled $%lX bytes in %lu chunks with %d threads in %.3f s, %.2f MB/s\n",
+        length, (unsigned long)parallel.num_chunks, num_threads, seconds, length / (seconds * 1024.0 * 1024.0));
+}
+
+#if HAVE_POSIX
+/* Map a regular, non-empty file read-only. Returns 0 when the file must go
+   through the read path instead */
+static int map_file(const char *filename, const uint8_t **data, unsigned long *size) {
+    struct stat st;
+    void       *map;
+    int         fd;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode) || (st.st_size <= 0)) {
+        close(fd);
+        return 0;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == map)
+        return 0;
+
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    *data = map;
+    *size = (unsigned long)st.st_size;
+    return 1;
+}
+
+static void unmap_file(const uint8_t *data, unsigned long size) {
+    munmap((void *)data, size);
+}
+#else
+static int map_file(const char *filename, const uint8_t **data, unsigned long *size) {
+    (void)filename; (void)data; (void)size;
+    return 0;
+}
+
+static void unmap_file(const uint8_t *data, unsigned long size) {
+    (void)data; (void)size;
+}
+#endif
+
+/* Skip the first bytes of an input that can not seek, e.g. a pipe */
+static void skip_input(FILE *input_file, unsigned long num_bytes, uint8_t *window) {
+    size_t got;
+
+    while (num_bytes) {
+        got = fread(window, 1, (num_bytes < STREAM_WINDOW_SIZE) ? num_bytes : STREAM_WINDOW_SIZE, input_file);
+        if (!got)
+            break;
+        num_bytes -= got;
+    }
+}
+
+/* This function clamps the disassembly length to the input size */
+static void clamp_length(options_t *options, unsigned long size) {
+    int quiet = options->batch; // Batch mode does not report per file
+    if (UNKNOWN_SIZE == size) {
+        if (!options->user_length) {
+            options->max_num_bytes = UNKNOWN_SIZE;
+        }
+        if (options->image && (options->max_num_bytes > (0x10000ul - options->org))) {
+            options->max_num_bytes = 0x10000 - options->org;
+        }
+        return;
+    }
+
+    if (!options->user_length) {
+        options->max_num_bytes = size;
+    }
+
+    // If file offset > file length nothing to do
+    if (options->start_offset > size) {
+        if (!quiet) {
+            fprintf(stderr, ";INFORMATION: Starting position > file size.\n");
+            fprintf(stderr, ";             Skipping file since nothing to do.\n");
+        }
+        options->max_num_bytes = 0;
+    } else if ((options->start_offset + options->max_num_bytes) > size) {
+        options->max_num_bytes = size - options->start_offset;
+
+        if (!quiet) {
+            fprintf(stderr, ";INFORMATION: Starting offset + disassembly length > file size!\n");
+            fprintf(stderr, ";             Clamping disassembly length to $%05lX.\n", options->max_num_bytes);
+        }
+    }
+
+    // Recursive descent, labels and cycle budgets work on one 64K address space, clamp to it
+    if (options->image && (options->max_num_bytes > (0x10000ul - options->org))) {
+        options->max_num_bytes = 0x10000 - options->org;
+        if (!quiet) {
+            fprintf(stderr, ";WARNING: Start + Length > $FFFF (65,535) bytes.\n");
+            fprintf(stderr, ";         Clamping to $%05lX.\n", options->max_num_bytes);
+        }
+    }
+
+    // If user offset + user length > (0xFFFF+1) then addresses wrap around, the 65816 has 16M
+    if (!quiet && !options->bank_size && LONG_ADDRESSES(options)) {
+        if ((options->org + options->max_num_bytes) > 0x1000000)
+            fprintf(stderr, ";INFORMATION: Addresses wrap around from $FFFFFF to $000000.\n");
+    } else if (!quiet && !options->bank_size && ((options->org + options->max_num_bytes) > 0x10000)) {
+        fprintf(stderr, ";INFORMATION: Start + Length > $FFFF (65,535) bytes.\n");
+        fprintf(stderr, ";             Addresses wrap around to $0000.\n");
+    }
+}
+
+/* Queue an address for decoding if it lies in the loaded image */
+static void flow_push(flow_t *flow, uint32_t addr) {
+    if ((addr >= flow->begin) && (addr < flow->end)) {
+        BIT_SET(flow->entry, addr);
+        if (!BIT_TEST(flow->code, addr))
+            flow->work[flow->num_work++] = (uint16_t)addr;
+    }
+}
+
+/* This function follows control flow from every queued address, marking
+   the instructions it reaches. Each path stops at an instruction that does
+   not fall through, an illegal opcode, the end of the image, or bytes
+   already decoded as part of another instruction. Every address is decoded
+   at most once, so this runs in linear time over the image */
+static void flow_trace(flow_t *flow) {
+    const template_t *tpl;
+    uint32_t          addr, next, i;
+    uint16_t          target;
+
+    while (flow->num_work) {
+        addr = flow->work[--flow->num_work];
+
+        while ((addr < flow->end) && !BIT_TEST(flow->code, addr)) {
+            tpl  = &g_templates[flow->image[addr]];
+            next = addr + tpl->length;
+
+            if ((tpl->flags & TEMPLATE_INVALID) || (next > flow->end))
+                break;
+            for (i = addr + 1; i < next; i++) {
+                if (BIT_TEST(flow->code, i))
+                    break;
+            }
+            if (i < next)
+                break;
+
+            BIT_SET(flow->start, addr);
+            for (i = addr; i < next; i++)
+                BIT_SET(flow->code, i);
+
+            if (tpl->flags & TEMPLATE_RELATIVE) {
+                target = branch_target(tpl, &flow->image[addr], addr);
+                flow_push(flow, target);
+            } else if (tpl->flags & TEMPLATE_JUMP) {
+                target = flow->image[addr + 1] | (((uint16_t)flow->image[addr + 2]) << 8);
+                flow_push(flow, target);
+            }
+
+            if (tpl->flags & TEMPLATE_STOP)
+                break;
+            addr = next;
+        }
+    }
+}
+
+/* This function emits a .byte line for num_bytes bytes of data at addr */
+static char *emit_data(char *output, options_t *options, const uint8_t *image, uint16_t addr, int num_bytes) {
+    char *field = output;
+    int   i;
+
+    if (!options->omit_opcodes) {
+        if (options->apple2_output) {
+            output = put_hex4(output, addr);
+            *output++ = ':';
+        } else {
+            *output++ = '$';
+            output = put_hex4(output, addr);
+        }
+    }
+    output = put_pad(field, output, DUMP_ADDR_WIDTH);
+
+    field  = output;
+    output = put_str(output, ".byte ");
+    for (i = 0; i < num_bytes; i++) {
+        if (i)
+            *output++ = ',';
+        *output++ = '$';
+        output = put_hex2(output, image[addr + i]);
+    }
+    output = put_pad(field, output, DUMP_MNEMONIC_WIDTH);
+    if ((output - field) > DUMP_MNEMONIC_WIDTH)
+        *output++ = ' ';
+    *output++ = ';';
+    return output;
+}
+
+/* This function marks the instructions of a linear sweep of the image,
+   the bytes of a last instruction running past the end are left as data */
+static void flow_linear(flow_t *flow) {
+    uint32_t addr, next, i;
+
+    for (addr = flow->begin; addr < flow->end; addr = next) {
+        next = addr + g_templates[flow->image[addr]].length;
+        if (next > flow->end)
+            break;
+
+        BIT_SET(flow->start, addr);
+        for (i = addr; i < next; i++)
+            BIT_SET(flow->code, i);
+    }
+}
+
+/* This function builds the reference index of the decoded instructions in
+   a single decode pass, recording (source, target) pairs in flat arrays,
+   then groups them by target with a counting sort. Referenced addresses in
+   the image get a label, unless they fall inside an instruction */
+static void xref_build(xref_t *xref, const flow_t *flow) {
+    const template_t *tpl;
+    uint32_t          addr, num_refs, i, total, count;
+    uint16_t          target;
+
+    num_refs = 0;
+    for (addr = flow->begin; addr < flow->end; addr++) {
+        if (!BIT_TEST(flow->start, addr))
+            continue;
+
+        tpl = &g_templates[flow->image[addr]];
+        if (!(tpl->flags & TEMPLATE_ADDRESS))
+            continue;
+
+        if (tpl->flags & TEMPLATE_RELATIVE)
+            target = branch_target(tpl, &flow->image[addr], addr);
+        else if (tpl->digits == 2)
+            target = flow->image[addr + 1];
+        else
+            target = flow->image[addr + 1] | (((uint16_t)flow->image[addr + 2]) << 8);
+
+        xref->ref_source[num_refs] = (uint16_t)addr;
+        xref->ref_target[num_refs] = target;
+        xref->first[target + 1]++;
+        num_refs++;
+
+        if ((target >= flow->begin) && (target < flow->end) && (BIT_TEST(flow->start, target) || !BIT_TEST(flow->code, target))) {
+            if (tpl->flags & TEMPLATE_CALL)
+                xref->label[target] = LABEL_SUB;
+            else if (LABEL_NONE == xref->label[target])
+                xref->label[target] = LABEL_CODE;
+        }
+    }
+
+    /* Counting sort by target, sources stay in address order */
+    total = 0;
+    for (i = 1; i <= 0x10000; i++) {
+        count          = xref->first[i];
+        xref->first[i] = total;
+        total         += count;
+    }
+    for (i = 0; i < num_refs; i++)
+        xref->source[xref->first[xref->ref_target[i] + 1]++] = xref->ref_source[i];
+}
+
+/* This function emits the cross-references and the label line of addr */
+static char *emit_label(sweep_t *sweep, char *out, const xref_t *xref, const uint8_t *image, uint16_t addr) {
+    const opcode_t *entry;
+    uint32_t        i;
+
+    if (sweep->options->xref) {
+        for (i = xref->first[addr]; i < xref->first[addr + 1]; i++) {
+            if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+                out = sweep_reserve(sweep, out);
+
+            entry = &g_dcc.table[image[xref->source[i]]];
+            out = put_str(out, "; XREF $");
+            out = put_hex4(out, xref->source[i]);
+            *out++ = ' ';
+            out = put_str(out, entry->mnemonic);
+            *out++ = ' ';
+            out = put_str(out, dcc6502_addressing(entry->addressing)->name);
+            *out++ = '\n';
+        }
+        if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+            out = sweep_reserve(sweep, out);
+    }
+
+    out = put_label(out, xref->label[addr], addr);
+    *out++ = ':';
+    *out++ = '\n';
+    return out;
+}
+
+/* This function returns the cycles of the instruction at addr, as a
+   min/max pair when execution falls through to the next instruction and
+   exactly when its branch is taken. The taken branch penalty is computed
+   from the actual target, indexed page crossings are only known at run
+   time and count in the max */
+static void instruction_cycles(const uint8_t *image, uint32_t addr, uint32_t *min, uint32_t *max, uint32_t *taken) {
+    dcc6502_insn_t insn;
+
+    dcc6502_decode(&g_dcc, &image[addr], MAX_INSTRUCTION_LENGTH, addr, &insn);
+
+    *min = *max = *taken = insn.cycles_min;
+    if ((insn.flags & (CYCLE_BRANCH | CYCLE_BRANCH2)) && (g_templates[image[addr]].flags & TEMPLATE_RELATIVE))
+        *taken = insn.cycles_max;
+    else
+        *max = insn.cycles_max;
+
+    // Unconditional transfers always take their branch
+    if (g_templates[image[addr]].flags & TEMPLATE_STOP)
+        *min = *max = *taken;
+}
+
+/* This function splits the decoded instructions into basic blocks, sums
+   their cycles, then accumulates the straight-line paths backwards so
+   every block knows the budget from its first instruction to the end of
+   its path in a single pass. Subroutines called by JSR are not included */
+static void timing_build(timing_t *timing, flow_t *flow) {
+    const uint8_t    *image = flow->image;
+    const template_t *tpl;
+    uint32_t          addr, next, k, min, max, taken;
+    uint32_t          prev_next = UINT32_MAX;
+    int               prev_ends  = 1;
+    int               prev_stops = 1;
+    uint16_t          target;
+
+    /* Branch and jump targets start blocks */
+    for (addr = flow->begin; addr < flow->end; addr++) {
+        if (!BIT_TEST(flow->start, addr))
+            continue;
+        tpl = &g_templates[image[addr]];
+        if (tpl->flags & TEMPLATE_RELATIVE)
+            target = branch_target(tpl, &image[addr], addr);
+        else if (tpl->flags & TEMPLATE_JUMP)
+            target = image[addr + 1] | (((uint16_t)image[addr + 2]) << 8);
+        else
+            continue;
+        if ((target >= flow->begin) && (target < flow->end))
+            BIT_SET(flow->entry, target);
+    }
+
+    k = 0;
+    for (addr = flow->begin; addr < flow->end; addr++) {
+        if (!BIT_TEST(flow->start, addr))
+            continue;
+
+        tpl  = &g_templates[image[addr]];
+        next = addr + tpl->length;
+
+        // The linear sweep marks illegal opcodes too, they end the block
+        // and the path without cycles as in flow_trace
+        if (tpl->flags & TEMPLATE_INVALID) {
+            prev_ends  = 1;
+            prev_stops = 1;
+            continue;
+        }
+        instruction_cycles(image, addr, &min, &max, &taken);
+
+        if (prev_ends || (addr != prev_next) || BIT_TEST(flow->entry, addr)) {
+            if (timing->num_blocks)
+                timing->falls[k] = !prev_stops && (addr == prev_next);
+            k = timing->num_blocks++;
+            timing->block[addr] = k + 1;
+            timing->first[k]    = addr;
+        }
+
+        timing->last[k]      = addr;
+        timing->fall_min[k] += min;
+        timing->fall_max[k] += max;
+        timing->fall[k]      = max;
+        timing->taken[k]     = taken;
+
+        prev_ends  = (tpl->flags & (TEMPLATE_RELATIVE | TEMPLATE_STOP)) ? 1 : 0;
+        prev_stops = (tpl->flags & TEMPLATE_STOP) ? 1 : 0;
+        prev_next = next;
+    }
+    if (timing->num_blocks)
+        timing->falls[k] = 0;
+
+    for (k = 0; k < timing->num_blocks; k++) {
+        timing->min[k] = timing->fall_min[k];
+        timing->max[k] = timing->fall_max[k] - timing->fall[k] + ((timing->taken[k] > timing->fall[k]) ? timing->taken[k] : timing->fall[k]);
+    }
+
+    for (k = timing->num_blocks; k-- > 0; ) {
+        timing->path_min[k]  = timing->fall_min[k];
+        timing->path_max[k]  = timing->fall_max[k];
+        timing->path_last[k] = timing->last[k];
+        if (timing->falls[k]) {
+            timing->path_min[k] += timing->path_min[k + 1];
+            timing->path_max[k] += timing->path_max[k + 1];
+            timing->path_last[k] = timing->path_last[k + 1];
+        }
+    }
+}
+
+/* This function emits the cycle budget of block k, and of the straight-line
+   path starting there when the block is entered by a seed, jump or branch */
+static char *emit_block(char *out, const timing_t *timing, const flow_t *flow, uint32_t k) {
+    out = put_str(out, "; BLOCK $");
+    out = put_hex4(out, timing->first[k]);
+    out = put_str(out, "-$");
+    out = put_hex4(out, timing->last[k]);
+    out = put_str(out, " Cycles: ");
+    out = put_dec(out, timing->min[k]);
+    *out++ = '/';
+    out = put_dec(out, timing->max[k]);
+    *out++ = '\n';
+
+    if (BIT_TEST(flow->entry, timing->first[k]) && (timing->path_last[k] != timing->last[k])) {
+        out = put_str(out, "; PATH $");
+        out = put_hex4(out, timing->first[k]);
+        out = put_str(out, "-$");
+        out = put_hex4(out, timing->path_last[k]);
+        out = put_str(out, " Cycles: ");
+        out = put_dec(out, timing->path_min[k]);
+        *out++ = '/';
+        out = put_dec(out, timing->path_max[k]);
+        *out++ = '\n';
+    }
+    return out;
+}
+
+/* This function emits the cycles of one iteration when block k ends with a
+   backward branch or jump to a block whose straight-line path reaches k */
+static char *emit_loop(char *out, const timing_t *timing, const uint8_t *image, uint32_t k) {
+    const template_t *tpl  = &g_templates[image[timing->last[k]]];
+    uint32_t          addr = timing->last[k];
+    uint32_t          j, min, max;
+    uint16_t          target;
+
+    if (tpl->flags & TEMPLATE_RELATIVE)
+        target = branch_target(tpl, &image[addr], addr);
+    else if ((tpl->flags & TEMPLATE_JUMP) && (tpl->flags & TEMPLATE_STOP))
+        target = image[addr + 1] | (((uint16_t)image[addr + 2]) << 8);
+    else
+        return out;
+
+    if ((target > addr) || !timing->block[target])
+        return out;
+    j = timing->block[target] - 1;
+    if (timing->path_last[j] < addr)
+        return out;
+
+    // Path from j less the path after k, with the last branch taken
+    min = timing->path_min[j] - (timing->falls[k] ? timing->path_min[k + 1] : 0) - timing->fall[k] + timing->taken[k];
+    max = timing->path_max[j] - (timing->falls[k] ? timing->path_max[k + 1] : 0) - timing->fall[k] + timing->taken[k];
+
+    out = put_str(out, "; LOOP $");
+    out = put_hex4(out, target);
+    out = put_str(out, "-$");
+    out = put_hex4(out, addr);
+    out = put_str(out, " Cycles/iteration: ");
+    out = put_dec(out, min);
+    *out++ = '/';
+    out = put_dec(out, max);
+    *out++ = '\n';
+    return out;
+}
+
+/* These functions clear what the previous image left in the areas that
+   the build functions accumulate into */
+static void flow_reset(flow_t *flow) {
+    memset(flow->code, 0, sizeof(flow->code));
+    memset(flow->start, 0, sizeof(flow->start));
+    memset(flow->entry, 0, sizeof(flow->entry));
+    flow->num_work = 0;
+}
+
+static void xref_reset(xref_t *xref) {
+    memset(xref->first, 0, sizeof(xref->first));
+    memset(xref->label, 0, sizeof(xref->label));
+}
+
+static void timing_reset(timing_t *timing) {
+    uint32_t k;
+
+    for (k = 0; k < timing->num_blocks; k++) {
+        timing->block[timing->first[k]] = 0;
+        timing->fall_min[k] = 0;
+        timing->fall_max[k] = 0;
+    }
+    timing->num_blocks = 0;
+}
+
+static void image_work_free(image_work_t *work) {
+    free(work->timing);
+    free(work->xref);
+    free(work->flow);
+}
+
+/* This function disassembles the image as one 64K address space. With -r,
+   code is separated from data by recursive descent from the origin, the
+   NMI/RESET/IRQ vectors at $FFFA-$FFFF when loaded, and the user provided
+   entry points; otherwise the image is swept linearly. Bytes that are not
+   instructions are emitted as .byte lines. With -l, referenced addresses
+   get labels which replace them in the operands. With -t, every basic
+   block is preceded by its cycle budget. image holds max_num_bytes
+   bytes at org and MAX_INSTRUCTION_LENGTH bytes of zero padding. work
+   holds the areas kept across images, NULL to allocate them for this one */
+static void disassemble_image(const uint8_t *image, sweep_t *sweep, image_work_t *work) {
+    options_t    *options = sweep->options;
+    image_work_t  local   = { NULL, NULL, NULL };
+    flow_t       *flow;
+    xref_t       *xref    = NULL;
+    timing_t     *timing  = NULL;
+    char         *out;
+    uint32_t      addr, vector, block = 0;
+    uint16_t      pc;
+    int           i, num_bytes;
+
+    if (NULL == work)
+        work = &local;
+    if (NULL == work->flow)
+        work->flow = calloc(1, sizeof(flow_t));
+    else
+        flow_reset(work->flow);
+    if (options->labels && (NULL == work->xref))
+        work->xref = calloc(1, sizeof(xref_t));
+    else if (options->labels)
+        xref_reset(work->xref);
+    if (options->timing && (NULL == work->timing))
+        work->timing = calloc(1, sizeof(timing_t));
+    else if (options->timing)
+        timing_reset(work->timing);
+    if ((NULL == work->flow) || (options->labels && (NULL == work->xref)) || (options->timing && (NULL == work->timing))) {
+        usage_and_exit(3, "Could not allocate code/data bitmaps.");
+    }
+
+    flow = work->flow;
+    if (options->labels)
+        xref = work->xref;
+    if (options->timing)
+        timing = work->timing;
+
+    flow->image = image;
+    flow->begin = options->org;
+    flow->end   = options->org + options->max_num_bytes;
+
+    if (options->recursive) {
+        flow_push(flow, options->org);
+        for (vector = 0xFFFA; vector < 0x10000; vector += 2) {
+            if ((vector >= flow->begin) && ((vector + 1) < flow->end))
+                flow_push(flow, image[vector] | (((uint16_t)image[vector + 1]) << 8));
+        }
+        for (i = 0; i < options->num_entry_points; i++)
+            flow_push(flow, options->entry_points[i]);
+
+        flow_trace(flow);
+    } else {
+        flow_linear(flow);
+    }
+
+    if (xref)
+        xref_build(xref, flow);
+    if (timing)
+        timing_build(timing, flow);
+
+    out = sweep->out;
+    for (addr = flow->begin; addr < flow->end; ) {
+        if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+            out = sweep_reserve(sweep, out);
+
+        if (FORMAT_TEXT != options->format) {
+            // Records only cover the instructions
+            if (BIT_TEST(flow->start, addr)) {
+                pc  = addr;
+                out = emit_record(out, &image[addr], options, &pc);
+                addr += g_templates[image[addr]].length;
+            } else {
+                addr++;
+            }
+            continue;
+        }
+
+        if (timing && timing->block[addr]) {
+            block = timing->block[addr] - 1;
+            out = emit_block(out, timing, flow, block);
+        }
+        if (xref && xref->label[addr])
+            out = emit_label(sweep, out, xref, image, addr);
+
+        if (BIT_TEST(flow->start, addr)) {
+            pc  = addr;
+            out = disassemble(out, &image[addr], options, &pc, xref ? xref->label : NULL);
+            *out++ = '\n';
+            if (timing && (timing->last[block] == addr)) {
+                if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+                    out = sweep_reserve(sweep, out);
+                out = emit_loop(out, timing, image, block);
+            }
+            addr += g_templates[image[addr]].length;
+        } else {
+            // Data runs up to the next instruction or label
+            num_bytes = 1;
+            while (((addr + num_bytes) < flow->end) && (num_bytes < DATA_BYTES_PER_LINE) && !BIT_TEST(flow->start, addr + num_bytes)
+                && !(xref && xref->label[addr + num_bytes]))
+                num_bytes++;
+            out = emit_data(out, options, image, addr, num_bytes);
+            *out++ = '\n';
+            addr += num_bytes;
+        }
+    }
+    sweep->out = out;
+    sweep_flush(sweep);
+
+    image_work_free(&local);
+}
+
+static uint8_t *image_alloc(void) {
+    uint8_t *image = calloc(1, 0x10000 + MAX_INSTRUCTION_LENGTH);
+
+    if (NULL == image) {
+        usage_and_exit(3, "Could not allocate disassembly memory buffer.");
+    }
+    return image;
+}
+
+static int has_suffix(const char *name, const char *suffix) {
+    size_t name_len   = strlen(name);
+    size_t suffix_len = strlen(suffix);
+
+    return (name_len >= suffix_len) && (0 == strcmp(&name[name_len - suffix_len], suffix));
+}
+
+/* Length of a directory name without its trailing slashes, to join it to
+   a file name with "%.*s/%s" without doubling the '/' ("/" gives 0) */
+static int dir_length(const char *dir) {
+    size_t length = strlen(dir);
+
+    while ((length > 0) && ('/' == dir[length - 1]))
+        length--;
+    return (int)length;
+}
+
+/* This function mixes length bytes of data into a 64-bit hash, eight
+   bytes at a time */
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t length) {
+    const uint8_t *p = (const uint8_t *)data;
+    uint64_t       word;
+
+    while (length >= 8) {
+        memcpy(&word, p, 8);
+        hash  = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 29;
+        p      += 8;
+        length -= 8;
+    }
+    word = 0;
+    memcpy(&word, p, length);
+    hash  = (hash ^ word ^ ((uint64_t)length << 56)) * 0x9E3779B97F4A7C15ull;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/* This function hashes every option that changes the listing body, and
+   LISTING_VERSION so that a dcc6502 printing a different listing does not
+   reuse the cache or -I index of an older one. The file name and size only
+   appear in the header */
+static uint64_t options_key(options_t *options) {
+    unsigned long fields[24];
+    uint64_t      hash;
+    int           n = 0;
+
+    fields[n++] = options->org;
+    fields[n++] = options->start_offset;
+    fields[n++] = options->max_num_bytes;
+    fields[n++] = options->bank_size;
+    fields[n++] = options->hex_output;
+    fields[n++] = options->cycle_counting;
+    fields[n++] = options->nes_mode;
+    fields[n++] = options->apple2_output;
+    fields[n++] = options->omit_opcodes;
+    fields[n++] = options->recursive;
+    fields[n++] = options->labels;
+    fields[n++] = options->xref;
+    fields[n++] = options->timing;
+    fields[n++] = options->format;
+    fields[n++] = options->cpu;
+    fields[n++] = options->num_entry_points;
+    fields[n++] = LISTING_VERSION;
+
+    hash = hash_bytes(0, fields, n * sizeof(fields[0]));
+    if (g_cpu_key)
+        hash = hash_bytes(hash, &g_cpu_key, sizeof(g_cpu_key));
+    return hash_bytes(hash, options->entry_points, options->num_entry_points * sizeof(options->entry_points[0]));
+}
+
+/* This function returns the cache key of a listing: the bytes disassembled
+   and the options, the header is not cached */
+static uint64_t cache_key(options_t *options, const uint8_t *data) {
+    return hash_bytes(options_key(options), data, options->max_num_bytes);
+}
+
+static void cache_path(char *path, size_t size, options_t *options, uint64_t key, const char *suffix) {
+    snprintf(path, size, "%.*s/%016llX%s", dir_length(options->cache_dir), options->cache_dir, (unsigned long long)key, suffix);
+}
+
+#if HAVE_POSIX
+/* This function streams the cached listing of key to stream and marks it
+   as recently used. Returns 0 on a miss */
+static int cache_fetch(options_t *options, uint64_t key, char *output, FILE *stream) {
+    char   path[4096];
+    FILE  *file;
+    size_t got;
+
+    cache_path(path, sizeof(path), options, key, CACHE_SUFFIX);
+    file = fopen(path, "rb");
+    if (NULL == file) {
+        LOCK(&g_cache_stats.lock);
+        g_cache_stats.misses++;
+        UNLOCK(&g_cache_stats.lock);
+        return 0;
+    }
+
+    while ((got = fread(output, 1, OUTPUT_BUFFER_SIZE, file)) > 0)
+        flush_output(stream, output, got);
+    fclose(file);
+    utime(path, NULL);
+
+    LOCK(&g_cache_stats.lock);
+    g_cache_stats.hits++;
+    UNLOCK(&g_cache_stats.lock);
+    return 1;
+}
+
+/* This function starts a cache entry for key under a temporary name, so
+   that readers never see a partial listing. Returns 0 if it can not */
+static int cache_create(options_t *options, uint64_t key, cache_entry_t *entry) {
+    char          suffix[64];
+    unsigned long num_temp;
+
+    LOCK(&g_cache_stats.lock);
+    num_temp = g_cache_stats.num_temp++;
+    UNLOCK(&g_cache_stats.lock);
+
+    snprintf(suffix, sizeof(suffix), ".tmp%ld_%lu", (long)getpid(), num_temp);
+    cache_path(entry->path, sizeof(entry->path), options, key, CACHE_SUFFIX);
+    cache_path(entry->temp, sizeof(entry->temp), options, key, suffix);
+    entry->file = fopen(entry->temp, "wb");
+    return NULL != entry->file;
+}
+
+/* Cache entry found by cache_evict */
+typedef struct cache_file_s {
+    time_t        mtime;
+    unsigned long size;
+    char         *name;
+} cache_file_t;
+
+static int cache_file_compare(const void *a, const void *b) {
+    const cache_file_t *x = (const cache_file_t *)a;
+    const cache_file_t *y = (const cache_file_t *)b;
+
+    return (x->mtime > y->mtime) - (x->mtime < y->mtime);
+}
+
+/* This function deletes the least recently used entries once the cache
+   exceeds cache_size bytes, down to 90% of it so that the directory is not
+   scanned again for every new entry */
+static void cache_evict(options_t *options) {
+    DIR           *dir;
+    struct dirent *ent;
+    struct stat    st;
+    cache_file_t  *files    = NULL;
+    size_t         count    = 0;
+    size_t         capacity = 0;
+    size_t         i;
+    unsigned long  total    = 0;
+    char           path[4096];
+
+    dir = opendir(options->cache_dir);
+    if (NULL == dir)
+        return;
+
+    while (NULL != (ent = readdir(dir))) {
+        if (!has_suffix(ent->d_name, CACHE_SUFFIX))
+            continue;
+        snprintf(path, sizeof(path), "%.*s/%s", dir_length(options->cache_dir), options->cache_dir, ent->d_name);
+        if (stat(path, &st))
+            continue;
+
+        if (count == capacity) {
+            capacity = capacity ? (2 * capacity) : 256;
+            files    = realloc(files, capacity * sizeof(files[0]));
+            if (NULL == files) {
+                usage_and_exit(3, "Could not allocate cache index.");
+            }
+        }
+        files[count].mtime = st.st_mtime;
+        files[count].size  = st.st_size;
+        files[count].name  = strdup(ent->d_name);
+        total += st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    if (total > options->cache_size) {
+        qsort(files, count, sizeof(files[0]), cache_file_compare);
+        for (i = 0; (i < count) && (total > (options->cache_size - options->cache_size / 10)); i++) {
+            snprintf(path, sizeof(path), "%.*s/%s", dir_length(options->cache_dir), options->cache_dir, files[i].name);
+            if (0 == unlink(path)) {
+                LOCK(&g_cache_stats.lock);
+                g_cache_stats.evictions++;
+                UNLOCK(&g_cache_stats.lock);
+            }
+            total -= files[i].size;
+        }
+    }
+
+    LOCK(&g_cache_stats.lock);
+    g_cache_stats.total   = total;
+    g_cache_stats.scanned = 1;
+    UNLOCK(&g_cache_stats.lock);
+
+    for (i = 0; i < count; i++)
+        free(files[i].name);
+    free(files);
+}
+
+/* This function publishes a filled cache entry, or drops it if writing
+   failed, then evicts old entries */
+static void cache_commit(options_t *options, cache_entry_t *entry) {
+    long size   = ftell(entry->file);
+    int  failed = ferror(entry->file) || (size < 0);
+    int  full;
+
+    if (fclose(entry->file) || failed || rename(entry->temp, entry->path)) {
+        unlink(entry->temp);
+        return;
+    }
+
+    LOCK(&g_cache_stats.lock);
+    g_cache_stats.total += size;
+    full = !g_cache_stats.scanned || (g_cache_stats.total > options->cache_size);
+    UNLOCK(&g_cache_stats.lock);
+
+    if (full)
+        cache_evict(options);
+}
+
+/* This function prints the cache statistics of this run, and adds them to
+   the totals kept in the cache directory */
+static void cache_report(options_t *options) {
+    char          path[4096];
+    FILE         *file;
+    unsigned long hits = 0, misses = 0, evictions = 0;
+
+    snprintf(path, sizeof(path), "%.*s/stats", dir_length(options->cache_dir), options->cache_dir);
+    file = fopen(path, "r");
+    if (NULL != file) {
+        if (3 != fscanf(file, "hits %lu misses %lu evictions %lu", &hits, &misses, &evictions))
+            hits = misses = evictions = 0;
+        fclose(file);
+    }
+
+    hits      += g_cache_stats.hits;
+    misses    += g_cache_stats.misses;
+    evictions += g_cache_stats.evictions;
+    file = fopen(path, "w");
+    if (NULL != file) {
+        fprintf(file, "hits %lu misses %lu evictions %lu\n", hits, misses, evictions);
+        fclose(file);
+    }
+
+    fprintf(stderr, ";INFORMATION: Cache: %lu hits, %lu misses, %lu evicted (total %lu hits, %lu misses, %lu evicted)\n",
+        g_cache_stats.hits, g_cache_stats.misses, g_cache_stats.evictions, hits, misses, evictions);
+}
+#else
+static int cache_fetch(options_t *options, uint64_t key, char *output, FILE *stream) {
+    (void)options; (void)key; (void)output; (void)stream;
+    return 0;
+}
+
+static int cache_create(options_t *options, uint64_t key, cache_entry_t *entry) {
+    (void)options; (void)key; (void)entry;
+    return 0;
+}
+
+static void cache_commit(options_t *options, cache_entry_t *entry) {
+    (void)options; (void)entry;
+}
+
+static void cache_report(options_t *options) {
+    (void)options;
+}
+#endif
+
+/* Index file layout, native endian since it stays on the machine that
+   wrote it: magic, version, options_key, length, listing length, then the
+   bytes, the line offsets and the listing */
+
+/* This function loads the index of the previous run. Returns 0 if there is
+   none, or it was written with other options or for another length */
+static int index_load(options_t *options, index_t *index) {
+    FILE           *file;
+    long            size;
+    uint8_t        *buffer;
+    const uint32_t *line;
+    uint32_t        version, last = 0, i;
+
+    memset(index, 0, sizeof(*index));
+    file = fopen(options->index_path, "rb");
+    if (NULL == file)
+        return 0;
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < INDEX_HEADER_SIZE) {
+        fclose(file);
+        return 0;
+    }
+
+    buffer = malloc(size);
+    if ((NULL == buffer) || (1 != fread(buffer, size, 1, file))) {
+        free(buffer);
+        fclose(file);
+        return 0;
+    }
+    fclose(file);
+
+    memcpy(&version, &buffer[4], 4);
+    memcpy(&index->key, &buffer[8], 8);
+    memcpy(&index->length, &buffer[16], 4);
+    memcpy(&index->listing_len, &buffer[20], 4);
+    if (memcmp(buffer, INDEX_MAGIC, 4) || (INDEX_VERSION != version) ||
+        (index->key != options_key(options)) || (index->length != options->max_num_bytes) ||
+        ((unsigned long)size != INDEX_HEADER_SIZE + 5ul * index->length + 4 + index->listing_len)) {
+        free(buffer);
+        return 0;
+    }
+
+    /* index_copy trusts the line offsets: they must lie in the listing in
+       increasing order, the first byte starting an instruction and the last
+       offset closing the listing. A corrupt index is decoded anew */
+    line = (const uint32_t *)(void *)(buffer + INDEX_HEADER_SIZE);
+    for (i = 0; i <= index->length; i++) {
+        if (NO_LINE == line[i])
+            continue;
+        if ((line[i] < last) || (line[i] > index->listing_len))
+            break;
+        last = line[i];
+    }
+    if ((i <= index->length) || (index->length && (NO_LINE == line[0])) || (line[index->length] != index->listing_len)) {
+        free(buffer);
+        return 0;
+    }
+
+    index->file    = buffer;
+    index->line    = line;
+    index->bytes   = buffer + INDEX_HEADER_SIZE + 4ul * (index->length + 1);
+    index->listing = (const char *)(index->bytes + index->length);
+    return 1;
+}
+
+/* This function writes the index of this run for the next one, under a
+   temporary name first so an interrupted run leaves the old index whole */
+static void index_save(options_t *options, const uint8_t *bytes, const uint32_t *line, const char *listing, uint32_t listing_len) {
+    char     temp[4096];
+    uint8_t  header[INDEX_HEADER_SIZE];
+    uint32_t version = INDEX_VERSION;
+    uint32_t length  = options->max_num_bytes;
+    uint64_t key     = options_key(options);
+    FILE    *file;
+    int      ok;
+
+    memcpy(&header[0], INDEX_MAGIC, 4);
+    memcpy(&header[4], &version, 4);
+    memcpy(&header[8], &key, 8);
+    memcpy(&header[16], &length, 4);
+    memcpy(&header[20], &listing_len, 4);
+
+    snprintf(temp, sizeof(temp), "%s.tmp", options->index_path);
+    file = fopen(temp, "wb");
+    if (NULL == file) {
+        fprintf(stderr, ";WARNING: Could not write index %s\n", options->index_path);
+        return;
+    }
+
+    ok = (1 == fwrite(header, sizeof(header), 1, file)) &&
+         (length + 1 == fwrite(line, 4, length + 1, file)) &&
+         (length == fwrite(bytes, 1, length, file)) &&
+         (listing_len == fwrite(listing, 1, listing_len, file));
+    if (fclose(file) || !ok || rename(temp, options->index_path)) {
+        remove(temp);
+        fprintf(stderr, ";WARNING: Could not write index %s\n", options->index_path);
+    }
+}
+
+/* This function appends the previous listing of the bytes from begin to end,
+   both instruction starts of the previous run, and shifts their line offsets */
+static void index_copy(sweep_t *listing, const index_t *index, uint32_t *line, unsigned long begin, unsigned long end) {
+    size_t        len   = index->line[end] - index->line[begin];
+    uint32_t      shift = (listing->out - listing->output) - index->line[begin];
+    unsigned long offset;
+
+    for (offset = begin; offset < end; offset++) {
+        if (NO_LINE != index->line[offset])
+            line[offset] = index->line[offset] + shift;
+    }
+
+    while ((size_t)(listing->output_size - (listing->out - listing->output)) < len)
+        listing->out = sweep_reserve(listing, listing->out);
+    memcpy(listing->out, &index->listing[index->line[begin]], len);
+    listing->out += len;
+}
+
+/* This function decodes the instruction at offset into the listing, and
+   records where its lines start. Returns the offset of the next one */
+static unsigned long index_decode(sweep_t *listing, const uint8_t *bytes, uint32_t *line, unsigned long offset) {
+    line[offset]    = listing->out - listing->output;
+    listing->offset = offset;
+    return offset + sweep_range(listing, &bytes[offset], 1);
+}
+
+/* This function disassembles max_num_bytes bytes of data against the index
+   of the previous run. Each changed byte is re-decoded from the previous
+   instruction covering it until two instructions in a row start where they
+   did before; the listing of everything else is copied from the index.
+   Without a matching index everything is decoded. The index is rewritten */
+static void disassemble_incremental(const uint8_t *data, sweep_t *sweep) {
+    options_t     *options = sweep->options;
+    unsigned long  length  = options->max_num_bytes;
+    unsigned long  pos = 0, begin, prev, changed, num_ranges = 0, num_decoded = 0;
+    index_t        index;
+    sweep_t        listing;
+    uint8_t       *bytes;
+    uint32_t      *line;
+    char          *output;
+
+    bytes  = calloc(1, length + MAX_INSTRUCTION_LENGTH);
+    line   = malloc(4 * (length + 1));
+    output = malloc(OUTPUT_BUFFER_SIZE);
+    if ((NULL == bytes) || (NULL == line) || (NULL == output)) {
+        usage_and_exit(3, "Could not allocate instruction index.");
+    }
+    memcpy(bytes, data, length);
+    for (pos = 0; pos <= length; pos++)
+        line[pos] = NO_LINE;
+
+    /* The listing is collected in memory, it becomes the next index */
+    sweep_init(&listing, options, output, OUTPUT_BUFFER_SIZE, NULL);
+
+    if (!index_load(options, &index)) {
+        for (pos = 0; pos < length; )
+            pos = index_decode(&listing, bytes, line, pos);
+        num_decoded = length;
+        num_ranges  = (length > 0);
+    } else {
+        for (pos = 0; pos < length; ) {
+            for (changed = pos; (changed < length) && (bytes[changed] == index.bytes[changed]); changed++)
+                ;
+            if (changed == length)
+                break;
+            for (begin = changed; NO_LINE == index.line[begin]; begin--)
+                ;
+            index_copy(&listing, &index, line, pos, begin);
+
+            /* Resume the sweep state after the previous instruction */
+            for (prev = begin; (prev > 0) && (NO_LINE == line[prev - 1]); prev--)
+                ;
+            prev = prev ? (prev - 1) : 0;
+            listing.bank    = options->bank_size ? (prev / options->bank_size) : 0;
+            listing.last_pc = begin ? sweep_address(options, prev) : options->org;
+
+            /* Instructions after two that start where they did before decode
+               as before, or at the next changed byte */
+            pos = begin;
+            do {
+                prev = pos;
+                pos  = index_decode(&listing, bytes, line, pos);
+            } while ((pos < length) && ((NO_LINE == index.line[prev]) || (NO_LINE == index.line[pos]) || (pos <= changed)));
+
+            num_decoded += pos - begin;
+            num_ranges++;
+        }
+        if (pos < length)
+            index_copy(&listing, &index, line, pos, length);
+    }
+    line[length] = listing.out - listing.output;
+
+    sweep_write(sweep, listing.output, listing.out - listing.output);
+    index_save(options, bytes, line, listing.output, line[length]);
+
+    fprintf(stderr, ";INFORMATION: Re-decoded $%04lX of $%04lX bytes in %lu ranges\n", num_decoded, length, num_ranges);
+
+    free(index.file);
+    free(listing.output);
+    free(line);
+    free(bytes);
+}
+
+/* This function disassembles one input file through sweep, see disassemble_file */
+static unsigned long disassemble_sweep(options_t *options, sweep_t *sweep, char *output, uint8_t **window) {
+    FILE          *stream = sweep->stream;
+    const uint8_t *mapped;     /* Input file mapped in memory */
+    uint8_t       *image;      /* 64K image of -r, -l or -t */
+    FILE          *input_file; /* Input file */
+    long           file_size;
+    unsigned long  size;
+    cache_entry_t  entry;      /* Result cache entry being filled */
+    uint64_t       key;        /* Result cache key */
+
+    /* Fast path: decode straight from the mapped file */
+    if (strcmp(options->filename, "-") && map_file(options->filename, &mapped, &size)) {
+        clamp_length(options, size);
+        emit_header(stream, options, size);
+
+        if (NULL != options->cache_dir) {
+            key = cache_key(options, &mapped[options->start_offset]);
+            if (cache_fetch(options, key, output, stream)) {
+                unmap_file(mapped, size);
+                return options->max_num_bytes;
+            }
+            if (cache_create(options, key, &entry))
+                sweep->cache = entry.file;
+        }
+
+        if (options->image) {
+            image = image_alloc();
+            memcpy(&image[options->org], &mapped[options->start_offset], options->max_num_bytes);
+            disassemble_image(image, sweep, NULL);
+            free(image);
+        } else if (NULL != options->index_path) {
+            disassemble_incremental(&mapped[options->start_offset], sweep);
+        } else if (options->max_num_bytes) {
+            if ((options->num_threads > 1) && !options->batch && !LONG_ADDRESSES(options))
+                disassemble_parallel(&mapped[options->start_offset], sweep);
+            else
+                disassemble_mapped(&mapped[options->start_offset], sweep);
+        }
+        unmap_file(mapped, size);
+
+        if (NULL != sweep->cache)
+            cache_commit(options, &entry);
+        return options->max_num_bytes;
+    }
+
+    if (NULL == *window) {
+        *window = calloc(1, STREAM_WINDOW_SIZE + MAX_INSTRUCTION_LENGTH); // fix array out-of-bounds buffer overflow
+        if (NULL == *window) {
+            usage_and_exit(3, "Could not allocate disassembly memory buffer.");
+        }
+    }
+
+    if (0 == strcmp(options->filename, "-")) {
+        input_file = stdin;
+    } else {
+        input_file = fopen(options->filename, "rb");
+    }
+
+    if (NULL == input_file) {
+        return UNKNOWN_SIZE;
+    }
+
+    /* Pipes have no size and can not seek, skip the starting offset by reading */
+    size = UNKNOWN_SIZE;
+    if (0 == fseek(input_file, 0, SEEK_END)) {
+        file_size = ftell(input_file);
+        fseek(input_file, 0, SEEK_SET);
+        if (file_size >= 0)
+            size = (unsigned long)file_size;
+    }
+    clamp_length(options, size);
+
+    if (UNKNOWN_SIZE == size) {
+        skip_input(input_file, options->start_offset, *window);
+    } else {
+        fseek(input_file, (long int) options->start_offset, SEEK_SET);
+    }
+
+    /* Disassemble contents of file */
+    if (options->image) {
+        image = image_alloc();
+        options->max_num_bytes = fread(&image[options->org], 1, options->max_num_bytes, input_file);
+        emit_header(stream, options, size);
+        disassemble_image(image, sweep, NULL);
+        free(image);
+        sweep->offset = options->max_num_bytes;
+    } else {
+        emit_header(stream, options, size);
+        disassemble_stream(input_file, sweep, *window);
+    }
+
+    if (input_file != stdin)
+        fclose(input_file);
+
+    return sweep->offset;
+}
+
+/* This function disassembles one input file to stream. output must hold
+   OUTPUT_BUFFER_SIZE bytes; the read path window is allocated on first use
+   and kept in *window for the next file. Returns the number of input bytes
+   disassembled, or UNKNOWN_SIZE if the file could not be opened */
+static unsigned long disassemble_file(options_t *options, FILE *stream, char *output, uint8_t **window) {
+    sweep_t        sweep; /* Linear sweep state */
+    unsigned long  done;
+
+    sweep_init(&sweep, options, output, OUTPUT_BUFFER_SIZE, stream);
+    if (LONG_ADDRESSES(options)) {
+        sweep.widths = calloc(1, WIDTH_MAP_SIZE);
+        if (NULL == sweep.widths) {
+            usage_and_exit(3, "Could not allocate the 65816 register width map.");
+        }
+    }
+
+    done = disassemble_sweep(options, &sweep, output, window);
+    free(sweep.widths);
+    return done;
+}
+
+/* This function reads the bytes of one image of a diff, and decodes them
+   by linear sweep. Returns 0 if the file could not be read */
+static int diff_load(options_t *options, diff_side_t *side, const char *filename) {
+    options_t     file_options = *options;
+    FILE         *input_file;
+    long          file_size;
+    unsigned long offset;
+    uint64_t      key;
+    uint8_t       length, i;
+
+    memset(side, 0, sizeof(*side));
+    side->filename = filename;
+
+    input_file = fopen(filename, "rb");
+    if (NULL == input_file)
+        return 0;
+    if ((0 != fseek(input_file, 0, SEEK_END)) || ((file_size = ftell(input_file)) < 0)) {
+        fclose(input_file);
+        return 0;
+    }
+
+    side->size = (unsigned long)file_size;
+    clamp_length(&file_options, side->size);
+    side->length = file_options.max_num_bytes;
+
+    side->data   = calloc(1, side->length + MAX_INSTRUCTION_LENGTH);
+    side->offset = malloc(sizeof(uint32_t) * (side->length + 1));
+    side->key    = malloc(sizeof(uint64_t) * (side->length + 1));
+    side->match  = malloc(sizeof(int32_t) * (side->length + 1));
+    if ((NULL == side->data) || (NULL == side->offset) || (NULL == side->key) || (NULL == side->match)) {
+        usage_and_exit(3, "Could not allocate diff memory.");
+    }
+
+    fseek(input_file, (long)options->start_offset, SEEK_SET);
+    side->length = fread(side->data, 1, side->length, input_file);
+    fclose(input_file);
+
+    for (offset = 0; offset < side->length; offset += length) {
+        // Up to MAX_INSTRUCTION_LENGTH (7) bytes and the length fit in 64 bits
+        length = g_templates[side->data[offset]].length;
+        key    = (uint64_t)length << 56;
+        for (i = 0; i < length; i++)
+            key |= (uint64_t)side->data[offset + i] << (8 * i);
+
+        side->offset[side->count] = offset;
+        side->key[side->count]    = key;
+        side->match[side->count]  = -1;
+        side->count++;
+    }
+    side->offset[side->count] = side->length;
+    return 1;
+}
+
+static void diff_free(diff_side_t *side) {
+    free(side->data);
+    free(side->offset);
+    free(side->key);
+    free(side->match);
+}
+
+static void diff_match(diff_t *diff, uint32_t a, uint32_t b) {
+    diff->side[0].match[a] = b;
+    diff->side[1].match[b] = a;
+}
+
+/* This function finds the anchors of a gap: instructions that occur exactly
+   once in the gap of each image, JMP and JSR only when jumps_only is set.
+   Of these it keeps the longest sequence in the same order in both images,
+   by patience sorting. Returns the number of anchors, whose pairs of
+   instruction indices are stored in *anchors, to be freed by the caller */
+static uint32_t diff_anchors(diff_t *diff, const uint32_t begin[2], const uint32_t end[2], int jumps_only, uint32_t **anchors) {
+    diff_side_t *side;
+    diff_slot_t *slot;
+    uint32_t     mask, i, k, h, num_pairs = 0, num_piles = 0, lo, hi, mid, last;
+    uint32_t    *pairs, *piles, *prev;
+
+    for (mask = 1; mask < 2 * ((end[0] - begin[0]) + (end[1] - begin[1])); mask <<= 1)
+        ;
+    mask -= 1;
+    memset(diff->slots, 0, sizeof(diff_slot_t) * (mask + 1));
+
+    for (k = 0; k < 2; k++) {
+        side = &diff->side[k];
+        for (i = begin[k]; i < end[k]; i++) {
+            if (jumps_only && !(g_templates[side->data[side->offset[i]]].flags & TEMPLATE_JUMP))
+                continue;
+            h = (uint32_t)(side->key[i] ^ (side->key[i] >> 32)) * 0x9E3779B1u;
+            for (h ^= h >> 16; ; h++) {
+                slot = &diff->slots[h & mask];
+                if ((0 == slot->key) || (side->key[i] == slot->key))
+                    break;
+            }
+            slot->key = side->key[i];
+            slot->count[k]++;
+            slot->index[k] = i;
+        }
+    }
+
+    /* Unique pairs in the order of the old image */
+    pairs = malloc(sizeof(uint32_t) * 2 * (end[0] - begin[0]));
+    piles = malloc(sizeof(uint32_t) * (end[0] - begin[0]));
+    prev  = malloc(sizeof(uint32_t) * (end[0] - begin[0]));
+    if ((NULL == pairs) || (NULL == piles) || (NULL == prev)) {
+        usage_and_exit(3, "Could not allocate diff memory.");
+    }
+    side = &diff->side[0];
+    for (i = begin[0]; i < end[0]; i++) {
+        if (jumps_only && !(g_templates[side->data[side->offset[i]]].flags & TEMPLATE_JUMP))
+            continue;
+        h = (uint32_t)(side->key[i] ^ (side->key[i] >> 32)) * 0x9E3779B1u;
+        for (h ^= h >> 16; diff->slots[h & mask].key != side->key[i]; h++)
+            ;
+        slot = &diff->slots[h & mask];
+        if ((1 == slot->count[0]) && (1 == slot->count[1])) {
+            pairs[2 * num_pairs + 0] = i;
+            pairs[2 * num_pairs + 1] = slot->index[1];
+            num_pairs++;
+        }
+    }
+
+    /* Longest increasing sequence of the new image indices: piles[n] is the
+       pair ending the best sequence of length n + 1 found so far */
+    for (k = 0; k < num_pairs; k++) {
+        lo = 0;
+        hi = num_piles;
+        while (lo < hi) {
+            mid = (lo + hi) / 2;
+            if (pairs[2 * piles[mid] + 1] < pairs[2 * k + 1])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        prev[k]   = lo ? piles[lo - 1] : (uint32_t)-1;
+        piles[lo] = k;
+        if (lo == num_piles)
+            num_piles++;
+    }
+
+    /* Walk the sequence back, then compact its pairs in place */
+    last = num_piles ? piles[num_piles - 1] : 0;
+    for (k = num_piles; k-- > 0; last = prev[last]) {
+        piles[k] = last;
+    }
+    for (k = 0; k < num_piles; k++) {
+        pairs[2 * k + 0] = pairs[2 * piles[k] + 0];
+        pairs[2 * k + 1] = pairs[2 * piles[k] + 1];
+    }
+
+    free(piles);
+    free(prev);
+    *anchors = pairs;
+    return num_piles;
+}
+
+/* This function aligns a gap by the longest common subsequence of its
+   instructions, when it is small enough; larger gaps stay changed */
+static void diff_lcs(diff_t *diff, const uint32_t begin[2], const uint32_t end[2]) {
+    const uint64_t *key_a = diff->side[0].key;
+    const uint64_t *key_b = diff->side[1].key;
+    uint32_t        n = end[0] - begin[0], m = end[1] - begin[1], i, j;
+    uint16_t       *lcs;
+
+    if ((unsigned long)(n + 1) * (m + 1) > DIFF_LCS_LIMIT)
+        return;
+
+    /* lcs[i][j] is the length of the longest common subsequence of the gap suffixes */
+    lcs = calloc((size_t)(n + 1) * (m + 1), sizeof(uint16_t));
+    if (NULL == lcs) {
+        usage_and_exit(3, "Could not allocate diff memory.");
+    }
+    for (i = n; i-- > 0; ) {
+        for (j = m; j-- > 0; ) {
+            if (key_a[begin[0] + i] == key_b[begin[1] + j])
+                lcs[i * (m + 1) + j] = lcs[(i + 1) * (m + 1) + j + 1] + 1;
+            else if (lcs[(i + 1) * (m + 1) + j] >= lcs[i * (m + 1) + j + 1])
+                lcs[i * (m + 1) + j] = lcs[(i + 1) * (m + 1) + j];
+            else
+                lcs[i * (m + 1) + j] = lcs[i * (m + 1) + j + 1];
+        }
+    }
+
+    for (i = 0, j = 0; (i < n) && (j < m); ) {
+        if (key_a[begin[0] + i] == key_b[begin[1] + j]) {
+            diff_match(diff, begin[0] + i++, begin[1] + j++);
+        } else if (lcs[(i + 1) * (m + 1) + j] >= lcs[i * (m + 1) + j + 1]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    free(lcs);
+}
+
+/* This function aligns the instructions of a gap of both images: common
+   leading and trailing instructions match, then the gap is split at its
+   anchors, identical JMP and JSR instructions first, and each part is
+   aligned in turn. A gap without anchors goes to diff_lcs */
+static void diff_align(diff_t *diff, uint32_t begin_a, uint32_t end_a, uint32_t begin_b, uint32_t end_b, int jumps_only) {
+    const uint64_t *key_a = diff->side[0].key;
+    const uint64_t *key_b = diff->side[1].key;
+    uint32_t        begin[2], end[2], num_anchors, k, *anchors;
+
+    while ((begin_a < end_a) && (begin_b < end_b) && (key_a[begin_a] == key_b[begin_b]))
+        diff_match(diff, begin_a++, begin_b++);
+    while ((begin_a < end_a) && (begin_b < end_b) && (key_a[end_a - 1] == key_b[end_b - 1]))
+        diff_match(diff, --end_a, --end_b);
+    if ((begin_a == end_a) || (begin_b == end_b))
+        return;
+
+    begin[0] = begin_a; end[0] = end_a;
+    begin[1] = begin_b; end[1] = end_b;
+    num_anchors = diff_anchors(diff, begin, end, jumps_only, &anchors);
+    if (0 == num_anchors) {
+        free(anchors);
+        if (jumps_only)
+            diff_align(diff, begin_a, end_a, begin_b, end_b, 0);
+        else
+            diff_lcs(diff, begin, end);
+        return;
+    }
+
+    for (k = 0; k < num_anchors; k++) {
+        diff_match(diff, anchors[2 * k + 0], anchors[2 * k + 1]);
+        diff_align(diff, begin_a, anchors[2 * k + 0], begin_b, anchors[2 * k + 1], jumps_only);
+        begin_a = anchors[2 * k + 0] + 1;
+        begin_b = anchors[2 * k + 1] + 1;
+    }
+    diff_align(diff, begin_a, end_a, begin_b, end_b, jumps_only);
+    free(anchors);
+}
+
+/* This function emits the instructions of one image in a changed region */
+static char *emit_diff_lines(sweep_t *sweep, char *out, const diff_side_t *side, uint32_t begin, uint32_t end, const char *prefix) {
+    options_t *options = sweep->options;
+    uint16_t   pc;
+
+    for (; begin < end; begin++) {
+        if ((size_t)(out - sweep->output) > (sweep->output_size - MAX_LINE_LENGTH))
+            out = sweep_reserve(sweep, out);
+
+        pc  = sweep_address(options, side->offset[begin]);
+        out = put_str(out, prefix);
+        out = disassemble(out, &side->data[side->offset[begin]], options, &pc, NULL);
+        *out++ = '\n';
+    }
+    return out;
+}
+
+/* This function emits the range header of one image in a changed region:
+   the address of its first byte and its length in bytes */
+static char *emit_diff_range(char *out, options_t *options, const diff_side_t *side, uint32_t begin, uint32_t end, char sign) {
+    *out++ = sign;
+    *out++ = '$';
+    out = put_hex4(out, sweep_address(options, side->offset[begin]));
+    *out++ = ',';
+    return put_dec(out, side->offset[end] - side->offset[begin]);
+}
+
+/* This function compares the image of FILENAME with the old image of
+   diff_path, aligned at instruction granularity, and lists the changed
+   regions, each as a "@@ -OLD,LENGTH +NEW,LENGTH @@" line followed by the
+   old instructions prefixed by "-" and the new ones by "+" */
+static int disassemble_diff(options_t *options) {
+    diff_t        diff;
+    diff_side_t  *old_side = &diff.side[0];
+    diff_side_t  *new_side = &diff.side[1];
+    sweep_t       sweep;
+    char         *output, *out;
+    uint32_t      a, b, begin_a, begin_b, num_regions = 0, num_changed = 0;
+    double        start = elapsed_seconds();
+
+    if (!diff_load(options, old_side, options->diff_path) || !diff_load(options, new_side, options->filename)) {
+        version();
+        fprintf(stderr, "File not found or invalid filename : %s\n", old_side->data ? options->filename : options->diff_path);
+        exit(2);
+    }
+
+    for (diff.num_slots = 1; diff.num_slots < 2 * (old_side->count + new_side->count); diff.num_slots <<= 1)
+        ;
+    diff.slots = malloc(sizeof(diff_slot_t) * diff.num_slots);
+    output     = malloc(OUTPUT_BUFFER_SIZE);
+    if ((NULL == diff.slots) || (NULL == output)) {
+        usage_and_exit(3, "Could not allocate diff memory.");
+    }
+
+    diff_align(&diff, 0, old_side->count, 0, new_side->count, 1);
+
+    fprintf(stdout, "; Diff generated by DCC6502 version %s\n", VERSION_INFO);
+    fprintf(stdout, "; For more info about DCC6502, see %s\n", GIT_LOCATION);
+    fprintf(stdout, "; --- %s, File Size: $%04lX (%lu)\n", old_side->filename, old_side->size, old_side->size);
+    fprintf(stdout, "; +++ %s, File Size: $%04lX (%lu)\n", new_side->filename, new_side->size, new_side->size);
+    fprintf(stdout, ";---------------------------------------------------------------------------\n");
+
+    sweep_init(&sweep, options, output, OUTPUT_BUFFER_SIZE, stdout);
+    out = output;
+    for (a = 0, b = 0; (a < old_side->count) || (b < new_side->count); ) {
+        if ((a < old_side->count) && (b < new_side->count) && (old_side->match[a] == (int32_t)b)) {
+            a++;
+            b++;
+            continue;
+        }
+
+        /* Alignment is monotonic: past the changed instructions of both
+           images, the next ones are aligned with each other */
+        for (begin_a = a; (a < old_side->count) && (old_side->match[a] < 0); a++)
+            ;
+        for (begin_b = b; (b < new_side->count) && (new_side->match[b] < 0); b++)
+            ;
+
+        if ((size_t)(out - output) > (sweep.output_size - MAX_LINE_LENGTH))
+            out = sweep_reserve(&sweep, out);
+        out = put_str(out, "@@ ");
+        out = emit_diff_range(out, options, old_side, begin_a, a, '-');
+        *out++ = ' ';
+        out = emit_diff_range(out, options, new_side, begin_b, b, '+');
+        out = put_str(out, " @@\n");
+        out = emit_diff_lines(&sweep, out, old_side, begin_a, a, "-");
+        out = emit_diff_lines(&sweep, out, new_side, begin_b, b, "+");
+
+        num_regions++;
+        num_changed += (a - begin_a) + (b - begin_b);
+    }
+    sweep_write(&sweep, output, out - output);
+
+    fprintf(stderr, ";INFORMATION: %lu changed regions, %lu of %lu instructions changed in %.3f s\n",
+        (unsigned long)num_regions, (unsigned long)num_changed,
+        (unsigned long)(old_side->count + new_side->count), elapsed_seconds() - start);
+
+    free(output);
+    free(diff.slots);
+    diff_free(old_side);
+    diff_free(new_side);
+    return 0;
+}
+
+static void file_list_add(file_list_t *list, const char *name, size_t relative) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? (2 * list->capacity) : 64;
+        list->names    = realloc(list->names, list->capacity * sizeof(list->names[0]));
+        list->relative = realloc(list->relative, list->capacity * sizeof(list->relative[0]));
+        if ((NULL == list->names) || (NULL == list->relative)) {
+            usage_and_exit(3, "Could not allocate file list.");
+        }
+    }
+
+    list->relative[list->count] = relative;
+    list->names[list->count]    = strdup(name);
+    if (NULL == list->names[list->count]) {
+        usage_and_exit(3, "Could not allocate file list.");
+    }
+    list->count++;
+}
+
+/* Add a file, or every file below a directory, relative being the offset
+   of their path below the directory given on the command line. Listings
+   written by a previous batch run are skipped */
+static void file_list_walk_below(file_list_t *list, const char *path, size_t relative) {
+#if HAVE_POSIX
+    struct dirent *entry;
+    struct stat    st;
+    DIR           *dir;
+    char          *child;
+
+    if ((0 == stat(path, &st)) && S_ISDIR(st.st_mode)) {
+        dir = opendir(path);
+        if (NULL == dir) {
+            fprintf(stderr, ";WARNING: Could not read directory : %s\n", path);
+            return;
+        }
+
+        while (NULL != (entry = readdir(dir))) {
+            if ((entry->d_name[0] == '.') || has_suffix(entry->d_name, LISTING_SUFFIX))
+                continue;
+
+            child = malloc(strlen(path) + strlen(entry->d_name) + 2);
+            if (NULL == child) {
+                usage_and_exit(3, "Could not allocate file list.");
+            }
+            sprintf(child, "%.*s/%s", dir_length(path), path, entry->d_name);
+            file_list_walk_below(list, child, relative);
+            free(child);
+        }
+        closedir(dir);
+        return;
+    }
+#endif
+    file_list_add(list, path, relative);
+}
+
+/* Add a file, known under -O by its name, or every file below a directory,
+   known by their path below it */
+static void file_list_walk(file_list_t *list, const char *path) {
+    const char *slash    = strrchr(path, '/');
+    size_t      relative = slash ? (size_t)(slash + 1 - path) : 0;
+#if HAVE_POSIX
+    struct stat st;
+
+    if ((0 == stat(path, &st)) && S_ISDIR(st.st_mode))
+        relative = dir_length(path) + 1;
+#endif
+    file_list_walk_below(list, path, relative);
+}
+
+/* Add every file named in a manifest, one per line. Blank lines and lines
+   starting with '#' are ignored */
+static void file_list_read_manifest(file_list_t *list, const char *manifest) {
+    char  line[4096];
+    FILE *input_file;
+    char *end;
+
+    input_file = fopen(manifest, "r");
+    if (NULL == input_file) {
+        version();
+        fprintf(stderr, "File not found or invalid manifest : %s\n", manifest);
+        exit(2);
+    }
+
+    while (fgets(line, sizeof(line), input_file)) {
+        end = &line[strlen(line)];
+        while ((end > line) && isspace((unsigned char)end[-1]))
+            *--end = '\0';
+
+        if ((line[0] != '\0') && (line[0] != '#'))
+            file_list_walk(list, line);
+    }
+
+    fclose(input_file);
+}
+
+/* Name of the listing written for an input file in batch mode: next to
+   the input, or in the output directory when one is given, at the path
+   of the input relative to the directory it was found in */
+static char *listing_name(options_t *options, const char *filename, size_t relative) {
+    char *name;
+
+    if (NULL != options->output_dir) {
+        name = malloc(strlen(options->output_dir) + strlen(&filename[relative]) + sizeof(LISTING_SUFFIX) + 1);
+        if (NULL != name)
+            sprintf(name, "%.*s/%s%s", dir_length(options->output_dir), options->output_dir, &filename[relative], LISTING_SUFFIX);
+    } else {
+        name = malloc(strlen(filename) + sizeof(LISTING_SUFFIX));
+        if (NULL != name)
+            sprintf(name, "%s%s", filename, LISTING_SUFFIX);
+    }
+    return name;
+}
+
+/* This function creates the missing directories of the path name from its
+   offset from on, so that a listing can be written below -O */
+static void make_parents(char *name, size_t from) {
+#if HAVE_POSIX
+    char *slash;
+
+    for (slash = strchr(&name[from], '/'); NULL != slash; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(name, 0777);
+        *slash = '/';
+    }
+#else
+    (void)name;
+    (void)from;
+#endif
+}
+
+/* Listing written for an input, sorted to find the collisions under -O */
+typedef struct listing_s {
+    char       *name;
+    const char *input;
+} listing_t;
+
+static int compare_listings(const void *a, const void *b) {
+    return strcmp(((const listing_t *)a)->name, ((const listing_t *)b)->name);
+}
+
+/* This function checks that no two files of the list write the same -O
+   listing, as the files found below two directories given on the command
+   line may share a path. Returns 0, or -1 after reporting the collisions */
+static int listing_collisions(options_t *options, file_list_t *files) {
+    listing_t *listings;
+    size_t     i;
+    int        status = 0;
+
+    listings = calloc(files->count ? files->count : 1, sizeof(listings[0]));
+    if (NULL == listings) {
+        usage_and_exit(3, "Could not allocate file list.");
+    }
+    for (i = 0; i < files->count; i++) {
+        listings[i].name  = listing_name(options, files->names[i], files->relative[i]);
+        listings[i].input = files->names[i];
+        if (NULL == listings[i].name) {
+            usage_and_exit(3, "Could not allocate file list.");
+        }
+    }
+
+    qsort(listings, files->count, sizeof(listings[0]), compare_listings);
+    for (i = 1; i < files->count; i++) {
+        if (strcmp(listings[i - 1].name, listings[i].name))
+            continue;
+        fprintf(stderr, ";WARNING: %s and %s would both be written to %s\n", listings[i - 1].input, listings[i].input, listings[i].name);
+        status = -1;
+    }
+
+    for (i = 0; i < files->count; i++)
+        free(listings[i].name);
+    free(listings);
+    return status;
+}
+
+/* Worker of the batch thread pool: takes the next file off the shared list
+   until the list is exhausted. Each worker owns its buffers and a copy of
+   the options */
+static void *batch_worker(void *arg) {
+    batch_t      *batch  = arg;
+    options_t     options;
+    char         *output;
+    uint8_t      *window = NULL;
+    char         *name;
+    FILE         *stream;
+    size_t        index;
+    unsigned long num_bytes;
+
+    output = malloc(OUTPUT_BUFFER_SIZE);
+    if (NULL == output) {
+        usage_and_exit(3, "Could not allocate output buffer.");
+    }
+
+    for (;;) {
+        LOCK(&batch->lock);
+        index = batch->next++;
+        UNLOCK(&batch->lock);
+        if (index >= batch->files->count)
+            break;
+
+        options          = *batch->options;
+        options.filename = batch->files->names[index];
+
+        name = listing_name(&options, options.filename, batch->files->relative[index]);
+        if ((NULL != name) && (NULL != options.output_dir))
+            make_parents(name, dir_length(options.output_dir) + 1);
+        stream = name ? fopen(name, "wb") : NULL;
+        if (NULL == stream) {
+            fprintf(stderr, ";WARNING: Could not create listing for : %s\n", options.filename);
+            num_bytes = UNKNOWN_SIZE;
+        } else {
+            num_bytes = disassemble_file(&options, stream, output, &window);
+            fclose(stream);
+            if (UNKNOWN_SIZE == num_bytes) {
+                fprintf(stderr, ";WARNING: File not found or invalid filename : %s\n", options.filename);
+                remove(name);
+            }
+        }
+        free(name);
+
+        LOCK(&batch->lock);
+        if (UNKNOWN_SIZE == num_bytes) {
+            batch->num_failed++;
+        } else {
+            batch->num_files++;
+            batch->num_bytes += num_bytes;
+        }
+        UNLOCK(&batch->lock);
+    }
+
+    free(window);
+    free(output);
+    return NULL;
+}
+
+/* This function disassembles every file of the list across the worker
+   threads, writing one listing per file, and reports the throughput */
+static int disassemble_batch(options_t *options, file_list_t *files) {
+    batch_t   batch;
+    double    start, seconds;
+    int       num_threads = options->num_threads;
+
+    if ((NULL != options->output_dir) && listing_collisions(options, files)) {
+        fprintf(stderr, "Several inputs have the same listing under -O, give their common parent directory\n");
+        return 2;
+    }
+
+    memset(&batch, 0, sizeof(batch));
+    batch.options = options;
+    batch.files   = files;
+
+    if ((size_t)num_threads > files->count)
+        num_threads = files->count ? (int)files->count : 1;
+
+    start = elapsed_seconds();
+    LOCK_INIT(&batch.lock);
+    num_threads = run_workers(num_threads, batch_worker, &batch);
+    LOCK_DESTROY(&batch.lock);
+    seconds = elapsed_seconds() - start;
+    if (seconds <= 0.0)
+        seconds = 1e-9;
+
+    fprintf(stderr, ";INFORMATION: Disassembled %lu files ($%lX bytes) with %d threads in %.3f s\n",
+        batch.num_files, batch.num_bytes, num_threads, seconds);
+    fprintf(stderr, ";             %.1f files/s, %.2f MB/s\n",
+        batch.num_files / seconds, batch.num_bytes / (seconds * 1024.0 * 1024.0));
+    if (batch.num_failed)
+        fprintf(stderr, ";WARNING: %lu files could not be disassembled\n", batch.num_failed);
+
+    return batch.num_failed ? 2 : 0;
+}
+
+/* This function parses a search pattern: instructions separated by blanks
+   or commas, each an opcode in hex optionally followed by its operand bytes
+   in hex, or ?? for any byte. Left out operand bytes match anything, their
+   number is given by the addressing mode of the opcode */
+static void pattern_parse(pattern_t *pattern, const char *text) {
+    char     digits[3] = { 0 };
+    uint32_t num_digits, length, i;
+
+    memset(pattern, 0, sizeof(*pattern));
+    for (;;) {
+        while (isspace((unsigned char)*text) || (',' == *text))
+            text++;
+        if ('\0' == *text)
+            break;
+
+        for (num_digits = 0; text[num_digits] && !isspace((unsigned char)text[num_digits]) && (',' != text[num_digits]); num_digits++)
+            ;
+        if (!isxdigit((unsigned char)text[0]) || !isxdigit((unsigned char)text[1])) {
+            usage_and_exit(1, "Invalid -g pattern, each instruction starts with its opcode in hex");
+        }
+        memcpy(digits, text, 2);
+        length = g_templates[strtoul(digits, NULL, 16)].length;
+        if ((num_digits != 2) && (num_digits != 2 * length)) {
+            usage_and_exit(1, "Invalid -g pattern, the operand bytes do not match the opcode");
+        }
+        if (pattern->length + length > MAX_PATTERN_LENGTH) {
+            usage_and_exit(1, "Invalid -g pattern, too long");
+        }
+
+        /* Left out and ?? bytes stay 0 in both bytes and mask */
+        for (i = 0; i < num_digits; i += 2) {
+            if (('?' == text[i]) && ('?' == text[i + 1]))
+                continue;
+            if (!isxdigit((unsigned char)text[i]) || !isxdigit((unsigned char)text[i + 1])) {
+                usage_and_exit(1, "Invalid -g pattern, bytes are two hex digits or ??");
+            }
+            memcpy(digits, &text[i], 2);
+            pattern->bytes[pattern->length + i / 2] = (uint8_t)strtoul(digits, NULL, 16);
+            pattern->mask[pattern->length + i / 2]  = 0xFF;
+            pattern->last = pattern->length + i / 2;
+        }
+
+        text += num_digits;
+        pattern->length += length;
+        pattern->num_instructions++;
+    }
+
+    if (0 == pattern->num_instructions) {
+        usage_and_exit(1, "Invalid -g pattern, no instruction");
+    }
+}
+
+static int pattern_match(const pattern_t *pattern, const uint8_t *data) {
+    uint32_t i;
+
+    for (i = 0; i < pattern->length; i++) {
+        if ((data[i] & pattern->mask[i]) != pattern->bytes[i])
+            return 0;
+    }
+    return 1;
+}
+
+/* This function returns the offset of the first match of pattern in the
+   length bytes of data at or after pos, or length if there is none */
+static size_t pattern_find_scalar(const pattern_t *pattern, const uint8_t *data, size_t length, size_t pos) {
+    const uint8_t *hit;
+
+    while (pos + pattern->length <= length) {
+        hit = memchr(&data[pos], pattern->bytes[0], length - pattern->length + 1 - pos);
+        if (NULL == hit)
+            break;
+        pos = hit - data;
+        if (pattern_match(pattern, hit))
+            return pos;
+        pos++;
+    }
+    return length;
+}
+
+#if HAVE_SIMD
+/* Vector scans compare a block of positions at once against the first byte
+   and the last byte that must match, and verify the candidates. The tail
+   shorter than a block goes to the scalar scan */
+static size_t pattern_find_sse2(const pattern_t *pattern, const uint8_t *data, size_t length, size_t pos) {
+    const __m128i first = _mm_set1_epi8((char)pattern->bytes[0]);
+    const __m128i last  = _mm_set1_epi8((char)pattern->bytes[pattern->last]);
+    unsigned int  mask, bit;
+
+    for (; pos + pattern->length + 15 <= length; pos += 16) {
+        mask = _mm_movemask_epi8(_mm_and_si128(
+            _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(const void *)&data[pos])),
+            _mm_cmpeq_epi8(last,  _mm_loadu_si128((const __m128i *)(const void *)&data[pos + pattern->last]))));
+        for (; mask; mask &= mask - 1) {
+            bit = __builtin_ctz(mask);
+            if (pattern_match(pattern, &data[pos + bit]))
+                return pos + bit;
+        }
+    }
+    return pattern_find_scalar(pattern, data, length, pos);
+}
+
+__attribute__((target("avx2")))
+static size_t pattern_find_avx2(const pattern_t *pattern, const uint8_t *data, size_t length, size_t pos) {
+    const __m256i first = _mm256_set1_epi8((char)pattern->bytes[0]);
+    const __m256i last  = _mm256_set1_epi8((char)pattern->bytes[pattern->last]);
+    unsigned int  mask, bit;
+
+    for (; pos + pattern->length + 31 <= length; pos += 32) {
+        mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(const void *)&data[pos])),
+            _mm256_cmpeq_epi8(last,  _mm256_loadu_si256((const __m256i *)(const void *)&data[pos + pattern->last]))));
+        for (; mask; mask &= mask - 1) {
+            bit = __builtin_ctz(mask);
+            if (pattern_match(pattern, &data[pos + bit]))
+                return pos + bit;
+        }
+    }
+    return pattern_find_sse2(pattern, data, length, pos);
+}
+#endif
+
+typedef size_t (*pattern_find_t)(const pattern_t *pattern, const uint8_t *data, size_t length, size_t pos);
+
+/* Pick the widest scan the CPU runs */
+static pattern_find_t pattern_engine(const char **name) {
+#if HAVE_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "AVX2";
+        return pattern_find_avx2;
+    }
+    *name = "SSE2";
+    return pattern_find_sse2;
+#else
+    *name = "scalar";
+    return pattern_find_scalar;
+#endif
+}
+
+/* Read a whole input that can not be mapped, e.g. a pipe or an empty file */
+static uint8_t *read_all(FILE *input_file, unsigned long *size) {
+    uint8_t *data = NULL, *grown;
+    size_t   capacity = 0, got;
+
+    *size = 0;
+    do {
+        if (*size == capacity) {
+            capacity = capacity ? (2 * capacity) : STREAM_WINDOW_SIZE;
+            grown    = realloc(data, capacity);
+            if (NULL == grown) {
+                usage_and_exit(3, "Could not allocate input buffer.");
+            }
+            data = grown;
+        }
+        got    = fread(&data[*size], 1, capacity - *size, input_file);
+        *size += got;
+    } while (got);
+    return data;
+}
 
-    if (NULL == input_file) {
+/* This function loads a whole input: regular files are mapped, other
+   inputs read, - is standard input. Returns NULL if it could not be opened;
+   *mapped tells input_free how to release it */
+static const uint8_t *input_load(const char *filename, unsigned long *size, int *mapped) {
+    const uint8_t *bytes;
+    FILE          *input_file;
+
+    *mapped = map_file(filename, &bytes, size);
+    if (*mapped)
+        return bytes;
+
+    input_file = strcmp(filename, "-") ? fopen(filename, "rb") : stdin;
+    if (NULL == input_file)
+        return NULL;
+    bytes = read_all(input_file, size);
+    if (input_file != stdin)
+        fclose(input_file);
+    return bytes;
+}
+
+static void input_free(const uint8_t *bytes, unsigned long size, int mapped) {
+    if (mapped)
+        unmap_file(bytes, size);
+    else
+        free((void *)bytes);
+}
+
+/* This function lists the matches of g_pattern in one file into sweep,
+   each as a comment line with the file name and offset followed by the
+   disassembled instructions. Returns the number of matches, or
+   UNKNOWN_SIZE if the file could not be opened */
+static unsigned long search_file(sweep_t *sweep, pattern_find_t find) {
+    options_t     *options = sweep->options;
+    uint8_t        code[MAX_PATTERN_LENGTH + MAX_INSTRUCTION_LENGTH] = { 0 };
+    const uint8_t *bytes;
+    unsigned long  size, num_hits = 0, end;
+    size_t         pos, i, need;
+    char          *out;
+    uint16_t       pc;
+    int            mapped;
+
+    bytes = input_load(options->filename, &size, &mapped);
+    if (NULL == bytes)
+        return UNKNOWN_SIZE;
+
+    clamp_length(options, size);
+    end  = options->start_offset + options->max_num_bytes;
+    need = strlen(options->filename) + MAX_LINE_LENGTH * (g_pattern.num_instructions + 1);
+
+    out = sweep->out;
+    for (pos = options->start_offset; (pos = find(&g_pattern, bytes, end, pos)) < end; pos++) {
+        while ((size_t)(sweep->output_size - (out - sweep->output)) < need)
+            out = sweep_reserve(sweep, out);
+
+        out = put_str(out, "; ");
+        out = put_str(out, options->filename);
+        out = put_str(out, " offset $");
+        out = put_hex4(out, (uint16_t)(pos >> 16));
+        out = put_hex4(out, (uint16_t)pos);
+        *out++ = '\n';
+
+        /* The snippet is decoded from a padded copy, the match may end the file */
+        memcpy(code, &bytes[pos], g_pattern.length);
+        pc = sweep_address(options, pos - options->start_offset);
+        for (i = 0; i < g_pattern.length; i += g_templates[code[i]].length) {
+            out = disassemble(out, &code[i], options, &pc, NULL);
+            *out++ = '\n';
+        }
+        num_hits++;
+    }
+    sweep->out = out;
+
+    input_free(bytes, size, mapped);
+    return num_hits;
+}
+
+/* Put a JSON string, escaping quotes, backslashes and control characters */
+static char *put_json_str(char *output, const char *str) {
+    *output++ = '"';
+    for (; *str; str++) {
+        if (('"' == *str) || ('\\' == *str)) {
+            *output++ = '\\';
+            *output++ = *str;
+        } else if ((unsigned char)*str < 0x20) {
+            output = put_str(output, "\\u00");
+            output = put_hex2(output, (uint8_t)*str);
+        } else {
+            *output++ = *str;
+        }
+    }
+    *output++ = '"';
+    return output;
+}
+
+/* This function counts the instructions of one file by linear sweep, with
+   no formatting: per opcode, and branches whose target is on another page.
+   The addressing mode, illegal and cycle totals are derived from the opcode
+   counts, and from the length of the HuC6280 block transfers. The summary
+   is put into sweep as one JSON line. Returns the number of instructions,
+   illegal bytes excluded as in the JSON line, or UNKNOWN_SIZE if the file
+   could not be opened */
+static unsigned long stats_file(sweep_t *sweep) {
+    options_t      *options = sweep->options;
+    const opcode_t *entry;
+    const uint8_t  *bytes, *data;
+    unsigned long   counts[NUMBER_OPCODES] = { 0 };
+    unsigned long   modes[32] = { 0 };
+    uint8_t         lengths[NUMBER_OPCODES], relative[NUMBER_OPCODES], blocks[NUMBER_OPCODES], taken[NUMBER_OPCODES];
+    unsigned long   size, pos, length, num_instructions = 0, num_illegal = 0, num_branches = 0, num_crosses = 0;
+    unsigned long   block_bytes = 0, taken_crosses = 0;
+    unsigned long   cross;
+    unsigned long   cycles_min = 0, cycles_max = 0;
+    uint32_t        used_modes = 0;
+    uint16_t        pc;
+    uint8_t         opcode;
+    char           *out;
+    int             mapped, i;
+
+    bytes = input_load(options->filename, &size, &mapped);
+    if (NULL == bytes)
+        return UNKNOWN_SIZE;
+
+    clamp_length(options, size);
+    data   = &bytes[options->start_offset];
+    length = options->max_num_bytes;
+
+    /* Compact copies of the template fields the loop reads */
+    for (i = 0; i < NUMBER_OPCODES; i++) {
+        lengths[i]  = g_templates[i].length;
+        relative[i] = (g_templates[i].flags & TEMPLATE_RELATIVE) && (g_dcc.table[i].cycles_exceptions & CYCLE_PAGE);
+        blocks[i]   = !(g_dcc.table[i].cycles_exceptions & BAD) && (BLKTR == g_dcc.table[i].addressing);
+        taken[i]    = relative[i] && !(g_dcc.table[i].cycles_exceptions & CYCLE_BRANCH);
+    }
+
+    /* Branch free: the last byte of every instruction is read as a branch
+       offset and bytes 5 and 6 as a block length, so the last bytes of the
+       longest instruction are left to the tail. A zero length moves 64K */
+    for (pos = 0; pos + MAX_INSTRUCTION_LENGTH - 1 < length; pos += lengths[opcode]) {
+        opcode = data[pos];
+        counts[opcode]++;
+        pc = sweep_address(options, pos) + lengths[opcode];
+        cross          = relative[opcode] & ((uint16_t)((pc + (int8_t)data[pos + lengths[opcode] - 1]) ^ pc) > 0xFF);
+        num_crosses   += cross;
+        taken_crosses += taken[opcode] & cross;
+        block_bytes += blocks[opcode] * ((((data[pos + 5] | (data[pos + 6] << 8)) - 1) & 0xffffu) + 1);
+    }
+    for (; pos < length; pos += lengths[opcode]) {
+        opcode = data[pos];
+        counts[opcode]++;
+        pc = sweep_address(options, pos) + lengths[opcode];
+        if (relative[opcode] && (pos + lengths[opcode] <= length)) {
+            cross          = (uint16_t)((pc + (int8_t)data[pos + lengths[opcode] - 1]) ^ pc) > 0xFF;
+            num_crosses   += cross;
+            taken_crosses += taken[opcode] & cross;
+        }
+        if (blocks[opcode] && (pos + lengths[opcode] <= length))
+            block_bytes += (((data[pos + 5] | (data[pos + 6] << 8)) - 1) & 0xffffu) + 1;
+    }
+
+    input_free(bytes, size, mapped);
+
+    for (opcode = 0, i = 0; i < NUMBER_OPCODES; i++, opcode++) {
+        entry = &g_dcc.table[opcode];
+        if (entry->cycles_exceptions & BAD) {
+            num_illegal += counts[opcode];
+            continue;
+        }
+        used_modes |= 1u << entry->addressing;
+        modes[entry->addressing] += counts[opcode];
+        num_instructions         += counts[opcode];
+        cycles_min               += counts[opcode] * entry->cycles;
+        cycles_max               += counts[opcode] * entry->cycles;
+        /* The page penalty of relative branches is the measured crossings */
+        if (entry->cycles_exceptions & CYCLE_BRANCH) {
+            num_branches += counts[opcode];
+            cycles_max   += counts[opcode];
+        } else if ((entry->cycles_exceptions & CYCLE_PAGE) && !relative[opcode]) {
+            cycles_max   += counts[opcode];
+        }
+        if (entry->cycles_exceptions & CYCLE_BRANCH2) {
+            num_branches += counts[opcode];
+            cycles_max   += 2 * counts[opcode];
+        }
+    }
+    cycles_max += num_crosses;
+    cycles_min += taken_crosses; /* BRA always pays its crossing */
+    cycles_min += DCC6502_BLOCK_CYCLES * block_bytes;
+    cycles_max += DCC6502_BLOCK_CYCLES * block_bytes;
+
+    while ((size_t)(sweep->output_size - (sweep->out - sweep->output)) < (8 * strlen(options->filename) + 64 * (NUMBER_OPCODES + 32)))
+        sweep->out = sweep_reserve(sweep, sweep->out);
+
+    out = put_str(sweep->out, "{\"file\":");
+    out = put_json_str(out, options->filename);
+    out = put_str(out, ",\"bytes\":");
+    out = put_dec(out, length);
+    out = put_str(out, ",\"instructions\":");
+    out = put_dec(out, num_instructions);
+    out = put_str(out, ",\"illegal\":");
+    out = put_dec(out, num_illegal);
+    out = put_str(out, ",\"branches\":");
+    out = put_dec(out, num_branches);
+    out = put_str(out, ",\"branch_page_crosses\":");
+    out = put_dec(out, num_crosses);
+    out = put_str(out, ",\"cycles_min\":");
+    out = put_dec(out, cycles_min);
+    out = put_str(out, ",\"cycles_max\":");
+    out = put_dec(out, cycles_max);
+    out = put_str(out, ",\"modes\":{");
+    for (i = 0; i < 32; i++) {
+        if (!(used_modes & (1u << i)))
+            continue;
+        out = put_json_str(out, dcc6502_addressing((addressing_mode_e)i)->name);
+        *out++ = ':';
+        out = put_dec(out, modes[i]);
+        *out++ = ',';
+    }
+    if (',' == out[-1])
+        out--;
+    out = put_str(out, "},\"opcodes\":[");
+    for (i = 0; i < NUMBER_OPCODES; i++) {
+        out = put_dec(out, counts[i]);
+        *out++ = ',';
+    }
+    out[-1] = ']';
+    *out++  = '}';
+    *out++  = '\n';
+    sweep->out = out;
+
+    return num_instructions;
+}
+
+/* Worker of the search and statistics thread pool: takes the next file off
+   the shared list, and writes its results in one piece once it is scanned */
+static void *scan_worker(void *arg) {
+    batch_t       *batch = arg;
+    options_t      options;
+    sweep_t        sweep;
+    pattern_find_t find;
+    const char    *engine;
+    size_t         index;
+    unsigned long  num_hits;
+
+    find = pattern_engine(&engine);
+    sweep_init(&sweep, batch->options, malloc(OUTPUT_BUFFER_SIZE), OUTPUT_BUFFER_SIZE, NULL);
+    if (NULL == sweep.output) {
+        usage_and_exit(3, "Could not allocate output buffer.");
+    }
+
+    for (;;) {
+        LOCK(&batch->lock);
+        index = batch->next++;
+        UNLOCK(&batch->lock);
+        if (index >= batch->files->count)
+            break;
+
+        options          = *batch->options;
+        options.filename = batch->files->names[index];
+        sweep.options    = &options;
+        sweep.out        = sweep.output;
+
+        num_hits = (NULL != options.pattern) ? search_file(&sweep, find) : stats_file(&sweep);
+        if (UNKNOWN_SIZE == num_hits)
+            fprintf(stderr, ";WARNING: File not found or invalid filename : %s\n", options.filename);
+
+        LOCK(&batch->lock);
+        flush_output(stdout, sweep.output, sweep.out - sweep.output);
+        if (UNKNOWN_SIZE == num_hits) {
+            batch->num_failed++;
+        } else {
+            batch->num_files++;
+            batch->num_hits  += num_hits;
+            batch->num_bytes += options.max_num_bytes;
+        }
+        UNLOCK(&batch->lock);
+    }
+
+    free(sweep.output);
+    return NULL;
+}
+
+/* This function searches every file of the list for g_pattern, or counts
+   their instructions, across the worker threads. With several threads the
+   files are listed in the order they finish */
+static int scan_batch(options_t *options, file_list_t *files) {
+    batch_t     batch;
+    double      start, seconds;
+    const char *engine;
+    int         num_threads = options->num_threads;
+
+    memset(&batch, 0, sizeof(batch));
+    batch.options = options;
+    batch.files   = files;
+
+    if ((size_t)num_threads > files->count)
+        num_threads = files->count ? (int)files->count : 1;
+
+    pattern_engine(&engine);
+    start = elapsed_seconds();
+    LOCK_INIT(&batch.lock);
+    num_threads = run_workers(num_threads, scan_worker, &batch);
+    LOCK_DESTROY(&batch.lock);
+    seconds = elapsed_seconds() - start;
+    if (seconds <= 0.0)
+        seconds = 1e-9;
+
+    if (NULL != options->pattern)
+        fprintf(stderr, ";INFORMATION: Found %lu matches in %lu files ($%lX bytes) with %d %s threads in %.3f s, %.2f MB/s\n",
+            batch.num_hits, batch.num_files, batch.num_bytes, num_threads, engine, seconds, batch.num_bytes / (seconds * 1024.0 * 1024.0));
+    else
+        fprintf(stderr, ";INFORMATION: Counted %lu instructions in %lu files ($%lX bytes) with %d threads in %.3f s, %.2f MB/s\n",
+            batch.num_hits, batch.num_files, batch.num_bytes, num_threads, seconds, batch.num_bytes / (seconds * 1024.0 * 1024.0));
+    if (batch.num_failed)
+        fprintf(stderr, ";WARNING: %lu files could not be searched\n", batch.num_failed);
+
+    return batch.num_failed ? 2 : 0;
+}
+
+/* N-gram index of the instruction shapes of a ROM library, native endian:
+
+    0  4 magic "DCNX"
+    4  4 version
+    8  4 instructions per n-gram
+   12  4 number of files
+   16  4 number of n-grams
+   20  4 number of postings
+   24    n-grams, uint64 ascending
+         start of the postings of each n-gram, uint32, and the end
+         postings: ids of the files containing each n-gram, uint32 ascending
+         start of the name of each file, uint32, and the end
+         names, NUL terminated
+
+   The shape of an instruction is its mnemonic id and addressing mode from
+   the opcode table, an n-gram the shapes of NGRAM_LENGTH instructions in a
+   row of the linear sweep. Illegal opcodes break the sequence */
+#define NGRAM_SHAPE(opcode) (((uint64_t)g_dcc.mnemonic[opcode] << 6) | g_dcc.table[opcode].addressing)
+#define NGRAM_MASK          ((1ull << (NGRAM_SHAPE_BITS * NGRAM_LENGTH)) - 1)
+
+/* This function appends the n-grams of the length bytes of data, each
+   shifted above the file id, to grams */
+static size_t ngram_collect(const uint8_t *data, unsigned long length, uint32_t file, uint64_t *grams) {
+    unsigned long pos;
+    uint64_t      key = 0;
+    size_t        count = 0;
+    uint8_t       opcode;
+    int           run = 0;
+
+    for (pos = 0; pos < length; pos += g_templates[opcode].length) {
+        opcode = data[pos];
+        if ((g_dcc.table[opcode].cycles_exceptions & BAD) || (pos + g_templates[opcode].length > length)) {
+            run = 0;
+            continue;
+        }
+
+        key = ((key << NGRAM_SHAPE_BITS) | NGRAM_SHAPE(opcode)) & NGRAM_MASK;
+        if (++run >= NGRAM_LENGTH)
+            grams[count++] = (key << NGRAM_FILE_BITS) | file;
+    }
+    return count;
+}
+
+/* LSD radix sort of count values, 16 bits per pass. scratch holds count values */
+static void radix_sort(uint64_t *values, uint64_t *scratch, size_t count) {
+    size_t   *histogram, i, sum, n;
+    uint64_t *swap;
+    int       shift;
+
+    histogram = malloc(sizeof(size_t) << 16);
+    if (NULL == histogram) {
+        usage_and_exit(3, "Could not allocate index memory.");
+    }
+
+    for (shift = 0; shift < 64; shift += 16) {
+        memset(histogram, 0, sizeof(size_t) << 16);
+        for (i = 0; i < count; i++)
+            histogram[(values[i] >> shift) & 0xFFFF]++;
+        for (i = 0, sum = 0; i < (1 << 16); i++) {
+            n            = histogram[i];
+            histogram[i] = sum;
+            sum         += n;
+        }
+        for (i = 0; i < count; i++)
+            scratch[histogram[(values[i] >> shift) & 0xFFFF]++] = values[i];
+
+        swap    = values;
+        values  = scratch;
+        scratch = swap;
+    }
+    free(histogram);
+}
+
+static int write_array(FILE *file, const void *data, size_t size, size_t count) {
+    return count == fwrite(data, size, count, file);
+}
+
+/* This function writes the n-gram index of every file of the list to
+   ngram_output: the n-grams of all files as (n-gram, file) pairs are sorted
+   once, duplicates dropped, and the runs of equal n-grams become posting
+   lists */
+static int ngram_build(options_t *options, file_list_t *files) {
+    options_t      file_options;
+    const uint8_t *bytes;
+    FILE          *index_file;
+    uint64_t      *grams = NULL, *keys;
+    uint32_t      *starts, *postings, *names, header[6];
+    unsigned long  size, num_failed = 0, num_bytes = 0;
+    size_t         count = 0, capacity = 0, num_keys = 0, num_postings = 0, i, name_len = 0;
+    uint32_t       file, num_files;
+    double         start = elapsed_seconds();
+    int            ok, mapped;
+
+    if (files->count >= (1ul << NGRAM_FILE_BITS)) {
+        usage_and_exit(1, "Too many files for one index.");
+    }
+    num_files = (uint32_t)files->count;
+
+    for (file = 0; file < num_files; file++) {
+        file_options          = *options;
+        file_options.filename = files->names[file];
+        bytes = input_load(file_options.filename, &size, &mapped);
+        if (NULL == bytes) {
+            fprintf(stderr, ";WARNING: File not found or invalid filename : %s\n", file_options.filename);
+            num_failed++;
+            continue;
+        }
+
+        clamp_length(&file_options, size);
+        if (count + file_options.max_num_bytes > capacity) {
+            capacity = 2 * (count + file_options.max_num_bytes);
+            grams    = realloc(grams, sizeof(uint64_t) * capacity);
+            if (NULL == grams) {
+                usage_and_exit(3, "Could not allocate index memory.");
+            }
+        }
+        count     += ngram_collect(&bytes[file_options.start_offset], file_options.max_num_bytes, file, &grams[count]);
+        num_bytes += file_options.max_num_bytes;
+
+        input_free(bytes, size, mapped);
+    }
+
+    /* Sorted pairs: keys and postings are filled front to back, in the
+       scratch buffer of the sort */
+    keys = malloc(sizeof(uint64_t) * (count + 1));
+    if (NULL == keys) {
+        usage_and_exit(3, "Could not allocate index memory.");
+    }
+    radix_sort(grams, keys, count);
+
+    starts   = malloc(sizeof(uint32_t) * (count + 1));
+    postings = malloc(sizeof(uint32_t) * (count + 1));
+    names    = malloc(sizeof(uint32_t) * (num_files + 1));
+    if ((NULL == starts) || (NULL == postings) || (NULL == names)) {
+        usage_and_exit(3, "Could not allocate index memory.");
+    }
+    for (i = 0; i < count; i++) {
+        if (i && (grams[i] == grams[i - 1]))
+            continue;
+        if (!num_keys || ((grams[i] >> NGRAM_FILE_BITS) != keys[num_keys - 1])) {
+            keys[num_keys]   = grams[i] >> NGRAM_FILE_BITS;
+            starts[num_keys] = (uint32_t)num_postings;
+            num_keys++;
+        }
+        postings[num_postings++] = (uint32_t)(grams[i] & ((1u << NGRAM_FILE_BITS) - 1));
+    }
+    starts[num_keys] = (uint32_t)num_postings;
+
+    for (file = 0, name_len = 0; file < num_files; file++) {
+        names[file] = (uint32_t)name_len;
+        name_len   += strlen(files->names[file]) + 1;
+    }
+    names[num_files] = (uint32_t)name_len;
+
+    memcpy(&header[0], NGRAM_MAGIC, 4);
+    header[1] = NGRAM_VERSION;
+    header[2] = NGRAM_LENGTH;
+    header[3] = num_files;
+    header[4] = (uint32_t)num_keys;
+    header[5] = (uint32_t)num_postings;
+
+    index_file = fopen(options->ngram_output, "wb");
+    if (NULL == index_file) {
         version();
-        fprintf(stderr, "File not found or invalid filename : %s\n", options.filename);
+        fprintf(stderr, "Could not create index : %s\n", options->ngram_output);
         exit(2);
     }
+    ok = write_array(index_file, header, sizeof(header), 1) &&
+         write_array(index_file, keys, sizeof(uint64_t), num_keys) &&
+         write_array(index_file, starts, sizeof(uint32_t), num_keys + 1) &&
+         write_array(index_file, postings, sizeof(uint32_t), num_postings) &&
+         write_array(index_file, names, sizeof(uint32_t), num_files + 1);
+    for (file = 0; ok && (file < num_files); file++)
+        ok = write_array(index_file, files->names[file], 1, strlen(files->names[file]) + 1);
+    if (fclose(index_file) || !ok) {
+        remove(options->ngram_output);
+        version();
+        fprintf(stderr, "Could not write index : %s\n", options->ngram_output);
+        exit(2);
+    }
+
+    fprintf(stderr, ";INFORMATION: Indexed %lu n-grams, %lu postings of %lu files ($%lX bytes) in %.3f s\n",
+        (unsigned long)num_keys, (unsigned long)num_postings, (unsigned long)num_files - num_failed, num_bytes, elapsed_seconds() - start);
+    if (num_failed)
+        fprintf(stderr, ";WARNING: %lu files could not be indexed\n", num_failed);
 
-    fseek( input_file, 0, SEEK_END );
-    size_t size = ftell( input_file );
-    fseek( input_file, 0, SEEK_SET );
-    fseek( input_file, (long int) options.start_offset, SEEK_CUR );
+    free(grams);
+    free(keys);
+    free(starts);
+    free(postings);
+    free(names);
+    return num_failed ? 2 : 0;
+}
+
+/* This function lists the files of the ngram_index index containing every
+   n-gram of the shape of g_pattern, by intersecting their posting lists */
+static int ngram_query(options_t *options) {
+    const uint8_t  *index;
+    const uint64_t *keys;
+    const uint32_t *header, *starts, *postings, *names;
+    const char     *text;
+    uint64_t        gram = 0;
+    uint32_t        matches[MAX_PATTERN_LENGTH][2], *result = NULL, num_result = 0, lo, hi, mid, i, j, k, n, num_grams = 0;
+    unsigned long   size;
+    double          start = elapsed_seconds();
+    int             mapped;
+
+    if (g_pattern.num_instructions < NGRAM_LENGTH) {
+        usage_and_exit(1, "-Q needs a -g pattern of at least 3 instructions");
+    }
 
-    if (size > 0x10000) {
-        size = 0x10000;
-        fprintf(stderr, ";WARNING: File size > $10000 (65,536) bytes.\n");
-        fprintf(stderr, ";         Clamping to $%05X.\n", (uint32_t) size);
+    index = input_load(options->ngram_index, &size, &mapped);
+    if (NULL == index) {
+        version();
+        fprintf(stderr, "File not found or invalid index : %s\n", options->ngram_index);
+        exit(2);
     }
 
-    if (!options.user_length) {
-        options.max_num_bytes = size;
+    header = (const uint32_t *)(const void *)index;
+    if ((size < NGRAM_HEADER_SIZE) || memcmp(index, NGRAM_MAGIC, 4) || (NGRAM_VERSION != header[1]) || (NGRAM_LENGTH != header[2]) ||
+        (size < NGRAM_HEADER_SIZE + 8ul * header[4] + 4ul * (header[4] + 1) + 4ul * header[5] + 4ul * (header[3] + 1))) {
+        version();
+        fprintf(stderr, "Invalid index : %s\n", options->ngram_index);
+        exit(2);
     }
+    keys     = (const uint64_t *)(const void *)(index + NGRAM_HEADER_SIZE);
+    starts   = (const uint32_t *)(keys + header[4]);
+    postings = starts + header[4] + 1;
+    names    = postings + header[5];
+    text     = (const char *)(names + header[3] + 1);
 
-    if ((options.start_offset + options.max_num_bytes) > size) {
-        options.max_num_bytes = size - options.start_offset;
+    /* Posting list range of each n-gram of the pattern, empty if absent */
+    for (i = 0, n = 0; i < g_pattern.length; i += g_templates[g_pattern.bytes[i]].length) {
+        gram = ((gram << NGRAM_SHAPE_BITS) | NGRAM_SHAPE(g_pattern.bytes[i])) & NGRAM_MASK;
+        if (++n < NGRAM_LENGTH)
+            continue;
 
-        fprintf(stderr, ";INFORMATION: Starting offset + disassembly length > file size!\n");
-        fprintf(stderr, ";             Clamping disassembly length to $%05X.\n", (uint32_t) options.max_num_bytes);
+        for (lo = 0, hi = header[4]; lo < hi; ) {
+            mid = lo + (hi - lo) / 2;
+            if (keys[mid] < gram)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        matches[num_grams][0] = ((lo < header[4]) && (keys[lo] == gram)) ? starts[lo] : 0;
+        matches[num_grams][1] = ((lo < header[4]) && (keys[lo] == gram)) ? starts[lo + 1] : 0;
+        num_grams++;
     }
 
-    // If file offset > file length nothing to do
-    if (options.start_offset > size) {
-        fprintf(stderr, ";INFORMATION: Starting position > file size.\n");
-        fprintf(stderr, ";             Skipping file since nothing to do.\n");
-        options.max_num_bytes = 0;
-        goto done_file;
+    /* Intersect, starting from the shortest list */
+    for (i = 1, k = 0; i < num_grams; i++) {
+        if ((matches[i][1] - matches[i][0]) < (matches[k][1] - matches[k][0]))
+            k = i;
     }
+    result = malloc(sizeof(uint32_t) * (matches[k][1] - matches[k][0] + 1));
+    if (NULL == result) {
+        usage_and_exit(3, "Could not allocate index memory.");
+    }
+    for (num_result = 0, j = matches[k][0]; j < matches[k][1]; j++)
+        result[num_result++] = postings[j];
 
-    // If user offset + user length > (0xFFFF+1) then clamp
-    if ((options.org + options.max_num_bytes) > 0x10000) {
-        options.max_num_bytes = 0x10000 - options.org;
-        fprintf(stderr, ";WARNING: Start + Length > $FFFF (65,535) bytes.\n");
-        fprintf(stderr, ";         Clamping to $%05X.\n", (uint32_t) options.max_num_bytes );
+    for (i = 0; i < num_grams; i++) {
+        if (i == k)
+            continue;
+        for (j = 0, n = 0, lo = matches[i][0]; (j < num_result) && (lo < matches[i][1]); ) {
+            if (postings[lo] < result[j]) {
+                lo++;
+            } else if (postings[lo] > result[j]) {
+                j++;
+            } else {
+                result[n++] = result[j++];
+                lo++;
+            }
+        }
+        num_result = n;
     }
 
-    fread(&buffer[ options.org ], options.max_num_bytes, 1, input_file);
+    for (j = 0; j < num_result; j++)
+        fprintf(stdout, "%s\n", &text[names[result[j]]]);
 
-done_file:
-    fclose(input_file);
+    fprintf(stderr, ";INFORMATION: %lu of %lu files contain the shape, in %.3f ms\n",
+        (unsigned long)num_result, (unsigned long)header[3], (elapsed_seconds() - start) * 1e3);
+
+    free(result);
+    input_free(index, size, mapped);
+    return 0;
+}
+
+/* Daemon mode protocol, all fields little endian. A connection carries
+   any number of requests, each answered in order:
+
+   Request                              Response
+    0  4 magic "DCQ1"                    0  4 status, DAEMON_STATUS_*
+    4  4 length of the code, <= 64K      4  4 length of the listing
+    8  2 origin                          8  4 decode time in microseconds
+   10  2 mask of DAEMON_FLAG_*          12    listing
+   12  1 format_e
+   13  3 reserved, zero
+   16    code
 
-    /* Disassemble contents of buffer */
-    pc  = options.org;
-    end = options.org + options.max_num_bytes;
-    emit_header(&options, size);
+   The listing is the one of the command line, without the file header */
+#define DAEMON_MAGIC         "DCQ1"
+#define DAEMON_REQUEST_SIZE  16
+#define DAEMON_RESPONSE_SIZE 12
+#define DAEMON_MAX_CODE      0x10000
 
-    while (pc < end) {
-        disassemble(tmpstr, buffer, &options, &pc);
-        fprintf(stdout, "%s\n", tmpstr);
+#define DAEMON_FLAG_HEX       (1 << 0) // -d
+#define DAEMON_FLAG_CYCLES    (1 << 1) // -c
+#define DAEMON_FLAG_NES       (1 << 2) // -n
+#define DAEMON_FLAG_APPLE     (1 << 3) // -a
+#define DAEMON_FLAG_OMIT      (1 << 4) // -s
+#define DAEMON_FLAG_RECURSIVE (1 << 5) // -r
+#define DAEMON_FLAG_LABELS    (1 << 6) // -l
+#define DAEMON_FLAG_XREF      (1 << 7) // -x
+#define DAEMON_FLAG_TIMING    (1 << 8) // -t
+
+#define DAEMON_STATUS_OK          0
+#define DAEMON_STATUS_BAD_REQUEST 1
+
+#if HAVE_POSIX
+static int read_full(int fd, void *buffer, size_t size) {
+    uint8_t *p = buffer;
+    ssize_t  got;
+
+    while (size) {
+        got = read(fd, p, size);
+        if ((got < 0) && (EINTR == errno))
+            continue;
+        if (got <= 0)
+            return 0;
+        p    += got;
+        size -= got;
+    }
+    return 1;
+}
+
+static int write_full(int fd, const void *buffer, size_t size) {
+    const uint8_t *p = buffer;
+    ssize_t        put;
+
+    while (size) {
+        put = write(fd, p, size);
+        if ((put < 0) && (EINTR == errno))
+            continue;
+        if (put <= 0)
+            return 0;
+        p    += put;
+        size -= put;
+    }
+    return 1;
+}
+
+static void put_le32(uint8_t *output, uint32_t value) {
+    output[0] = value & 0xff;
+    output[1] = (value >> 8) & 0xff;
+    output[2] = (value >> 16) & 0xff;
+    output[3] = value >> 24;
+}
+
+/* This function serves one request of the connection fd. code holds
+   DAEMON_MAX_CODE + MAX_INSTRUCTION_LENGTH bytes, *listing the
+   *listing_size bytes output buffer and work the -r/-l/-t areas, all kept
+   across requests so that steady state serving does not allocate. Returns
+   0 once the connection is closed or broken */
+static int daemon_serve(daemon_t *daemon, int fd, uint8_t *code, char **listing, size_t *listing_size, image_work_t *work) {
+    uint8_t       request[DAEMON_REQUEST_SIZE];
+    uint8_t       response[DAEMON_RESPONSE_SIZE];
+    options_t     options = *daemon->options;
+    sweep_t       sweep;
+    unsigned long length;
+    unsigned int  flags;
+    uint8_t      *data;
+    double        start, seconds;
+    int           status = DAEMON_STATUS_OK;
+
+    if (!read_full(fd, request, sizeof(request)))
+        return 0;
+
+    length = request[4] | (request[5] << 8) | ((unsigned long)request[6] << 16) | ((unsigned long)request[7] << 24);
+    flags  = request[10] | (request[11] << 8);
+    if (memcmp(request, DAEMON_MAGIC, 4) || (length > DAEMON_MAX_CODE) || (request[12] > FORMAT_CSV))
+        return 0;
+
+    options.org            = request[8] | (request[9] << 8);
+    options.format         = (format_e)request[12];
+    options.hex_output     = (flags & DAEMON_FLAG_HEX) ? 1 : 0;
+    options.cycle_counting = (flags & DAEMON_FLAG_CYCLES) ? 1 : 0;
+    options.nes_mode       = (flags & DAEMON_FLAG_NES) ? 1 : 0;
+    options.apple2_output  = (flags & DAEMON_FLAG_APPLE) ? 1 : 0;
+    options.omit_opcodes   = (flags & DAEMON_FLAG_OMIT) ? 1 : 0;
+    options.recursive      = (flags & DAEMON_FLAG_RECURSIVE) ? 1 : 0;
+    options.labels         = (flags & (DAEMON_FLAG_LABELS | DAEMON_FLAG_XREF)) ? 1 : 0;
+    options.xref           = (flags & DAEMON_FLAG_XREF) ? 1 : 0;
+    options.timing         = (flags & DAEMON_FLAG_TIMING) ? 1 : 0;
+    options.image          = options.recursive || options.labels || options.timing;
+    options.num_entry_points = 0;
+    options.max_num_bytes  = length;
+    options.start_offset   = 0;
+    options.bank_size      = 0;
+    options.batch          = 1;
+
+    /* The 64K image modes place the code at its origin */
+    data = options.image ? &code[options.org] : code;
+    if (options.image && ((options.org + length) > DAEMON_MAX_CODE)) {
+        status = DAEMON_STATUS_BAD_REQUEST;
+        data   = code;
+    }
+    if (!read_full(fd, data, length))
+        return 0;
+
+    start = elapsed_seconds();
+    sweep_init(&sweep, &options, *listing, *listing_size, NULL);
+    if (DAEMON_STATUS_OK == status) {
+        if (FORMAT_TEXT == options.format)
+            sweep.out = emit_org(sweep.out, &options, 0, options.org);
+        if (options.image) {
+            memset(&code[options.org + length], 0, MAX_INSTRUCTION_LENGTH);
+            disassemble_image(code, &sweep, work);
+        } else if (length) {
+            disassemble_mapped(code, &sweep);
+        }
+    }
+    *listing      = sweep.output;
+    *listing_size = sweep.output_size;
+    seconds = elapsed_seconds() - start;
+
+    put_le32(&response[0], status);
+    put_le32(&response[4], sweep.out - sweep.output);
+    put_le32(&response[8], (uint32_t)(seconds * 1e6));
+    if (!write_full(fd, response, sizeof(response)) || !write_full(fd, sweep.output, sweep.out - sweep.output))
+        return 0;
+
+    LOCK(&daemon->lock);
+    daemon->num_requests++;
+    daemon->total_seconds += seconds;
+    if (seconds > daemon->max_seconds)
+        daemon->max_seconds = seconds;
+    fprintf(stderr, ";INFORMATION: Request %lu: $%04lX bytes in %.0f us (average %.0f us, max %.0f us)\n",
+        daemon->num_requests, length, seconds * 1e6,
+        daemon->total_seconds * 1e6 / daemon->num_requests, daemon->max_seconds * 1e6);
+    UNLOCK(&daemon->lock);
+
+    return 1;
+}
+
+static void *daemon_worker(void *arg) {
+    daemon_t     *daemon = (daemon_t *)arg;
+    uint8_t      *code;
+    char         *listing;
+    size_t        listing_size = OUTPUT_BUFFER_SIZE;
+    image_work_t  work;
+    int           fd;
+
+    code        = calloc(1, DAEMON_MAX_CODE + MAX_INSTRUCTION_LENGTH);
+    listing     = malloc(listing_size);
+    work.flow   = calloc(1, sizeof(flow_t));
+    work.xref   = calloc(1, sizeof(xref_t));
+    work.timing = calloc(1, sizeof(timing_t));
+    if ((NULL == code) || (NULL == listing) || (NULL == work.flow) || (NULL == work.xref) || (NULL == work.timing)) {
+        usage_and_exit(3, "Could not allocate daemon buffers.");
+    }
+
+    for (;;) {
+        fd = accept(daemon->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if ((EINTR == errno) || (ECONNABORTED == errno))
+                continue;
+            break;
+        }
+
+        while (daemon_serve(daemon, fd, code, &listing, &listing_size, &work))
+            ;
+        close(fd);
+    }
+
+    image_work_free(&work);
+    free(listing);
+    free(code);
+    return NULL;
+}
+
+/* This function serves disassembly requests on a Unix socket until killed,
+   one connection per thread. Each thread preallocates its code and listing
+   buffers, so requests skip process startup and the per-file allocations */
+static int disassemble_daemon(options_t *options) {
+    struct sockaddr_un address;
+    daemon_t           daemon;
+
+    if (strlen(options->socket_path) >= sizeof(address.sun_path)) {
+        usage_and_exit(1, "Socket path too long");
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, options->socket_path);
+
+    memset(&daemon, 0, sizeof(daemon));
+    daemon.options   = options;
+    daemon.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(options->socket_path);
+    if ((daemon.listen_fd < 0) || bind(daemon.listen_fd, (struct sockaddr *)&address, sizeof(address)) || listen(daemon.listen_fd, 64)) {
+        fprintf(stderr, "Could not listen on %s : %s\n", options->socket_path, strerror(errno));
+        return 2;
+    }
+
+    // A client closing early must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, ";INFORMATION: Serving %s with %d threads\n", options->socket_path, options->num_threads);
+    LOCK_INIT(&daemon.lock);
+    run_workers(options->num_threads, daemon_worker, &daemon);
+    LOCK_DESTROY(&daemon.lock);
+
+    close(daemon.listen_fd);
+    unlink(options->socket_path);
+    return 0;
+}
+#else
+static int disassemble_daemon(options_t *options) {
+    (void)options;
+    usage_and_exit(1, "Daemon mode needs Unix sockets");
+    return 1;
+}
+#endif
+
+/* CPU definitions replace the built-in opcode tables. A definition is a text
+   file with one line per opcode, '#' starts a comment:
+
+       OPCODE MNEMONIC MODE LENGTH CYCLES [page] [branch] [branch2] [65c02] [undoc] [m] [x] [rmw]
+
+   e.g. "BD LDA abx 3 4 page". MODE is one of g_cpu_modes, LENGTH must match
+   it, page/branch/branch2/m/x/rmw add the cycle penalties of CYCLE_PAGE/
+   CYCLE_BRANCH/CYCLE_BRANCH2/CYCLE_M/CYCLE_X/CYCLE_RMW and 65c02/undoc set
+   the _65C02/UNDOC flags.
+   Illegal opcodes have the mnemonic ??? and length 1, unlisted opcodes are
+   illegal. The first run compiles the text into CPUFILE.tbl: a header of
+   magic, version, size and time of the text and a hash of the records, then
+   one cpu_record_t per opcode. Later runs map that file and only check it */
+
+static void cpu_error(const char *path, int line, const char *message) {
+    fprintf(stderr, "%s:%d: %s\n", path, line, message);
+    exit(1);
+}
+
+/* This function parses the text definition at path into records, it exits
+   on the first error */
+static void cpu_compile(const char *path, cpu_record_t *records) {
+    char          text[256], *token[14], *p, *end;
+    int           defined[NUMBER_OPCODES];
+    int           line = 0, num_tokens, illegal, i, mode;
+    unsigned long opcode, length, cycles;
+    size_t        size;
+    FILE         *file;
+
+    /* Zeroed so that the NUL padding of the mnemonics, written to the
+       compiled table, is reproducible */
+    memset(records, 0, NUMBER_OPCODES * sizeof(*records));
+    for (i = 0; i < NUMBER_OPCODES; i++) {
+        memcpy(records[i].mnemonic, "???", sizeof("???"));
+        records[i].addressing = IMMED;
+        records[i].cycles     = 2;
+        records[i].reserved   = 0;
+        records[i].exceptions = BAD;
+        defined[i]            = 0;
+    }
+
+    file = fopen(path, "r");
+    if (NULL == file) {
+        version();
+        fprintf(stderr, "File not found or invalid: \"%s\"\n", path);
+        exit(2);
+    }
+
+    while (NULL != fgets(text, sizeof(text), file)) {
+        line++;
+        if ((NULL == strchr(text, '\n')) && !feof(file))
+            cpu_error(path, line, "Line too long");
+        if (NULL != (p = strchr(text, '#')))
+            *p = '\0';
+
+        num_tokens = 0;
+        for (p = strtok(text, " \t\r\n"); NULL != p; p = strtok(NULL, " \t\r\n")) {
+            if (num_tokens == (int)(sizeof(token) / sizeof(token[0])))
+                cpu_error(path, line, "Too many fields");
+            token[num_tokens++] = p;
+        }
+        if (0 == num_tokens)
+            continue;
+        if (num_tokens < 5)
+            cpu_error(path, line, "Expected OPCODE MNEMONIC MODE LENGTH CYCLES [page] [branch] [branch2] [65c02] [undoc] [m] [x] [rmw]");
+
+        opcode = strtoul(token[0], &end, 16);
+        if ((2 != strlen(token[0])) || ('\0' != *end) || !isxdigit((unsigned char)token[0][0]))
+            cpu_error(path, line, "Invalid opcode, expected two hex digits");
+        if (defined[opcode])
+            cpu_error(path, line, "Opcode defined twice");
+        defined[opcode] = 1;
+
+        illegal = !strcmp(token[1], "???");
+        size    = strlen(token[1]);
+        if ((size >= CPU_MNEMONIC_SIZE) || (!illegal && !isalpha((unsigned char)token[1][0])))
+            cpu_error(path, line, "Invalid mnemonic");
+        /* The decoder reports mnemonics by id in the library's name table, a
+           name missing from it would be formatted as ??? and share the id of
+           illegal opcodes in -f bin records and -N shapes */
+        for (i = 1; !illegal && strcmp(dcc6502_mnemonic(i), "???") && strcmp(dcc6502_mnemonic(i), token[1]); i++)
+            ;
+        if (!illegal && !strcmp(dcc6502_mnemonic(i), "???"))
+            cpu_error(path, line, "Unknown mnemonic, expected one of the 6502, 65C02, 65816 or HuC6280 instruction sets");
+
+        for (mode = 0; (NULL != g_cpu_modes[mode]) && strcmp(g_cpu_modes[mode], token[2]); mode++)
+            ;
+        if (NULL == g_cpu_modes[mode])
+            cpu_error(path, line, "Unknown addressing mode");
+
+        if (!str_arg_to_ulong(token[3], &length) || (length != (illegal ? 1 : dcc6502_addressing(mode)->length)))
+            cpu_error(path, line, "Length does not match the addressing mode");
+        if (!str_arg_to_ulong(token[4], &cycles) || (cycles < 1) || (cycles > 255))
+            cpu_error(path, line, "Invalid cycles");
+
+        memset(records[opcode].mnemonic, 0, CPU_MNEMONIC_SIZE);
+        memcpy(records[opcode].mnemonic, token[1], size); /* Checked shorter than CPU_MNEMONIC_SIZE */
+        records[opcode].addressing = (uint8_t)mode;
+        records[opcode].cycles     = (uint8_t)cycles;
+        records[opcode].exceptions = illegal ? BAD : 0;
+        for (i = 5; i < num_tokens; i++) {
+            if (!strcmp(token[i], "page"))
+                records[opcode].exceptions |= CYCLE_PAGE;
+            else if (!strcmp(token[i], "branch"))
+                records[opcode].exceptions |= CYCLE_BRANCH;
+            else if (!strcmp(token[i], "branch2"))
+                records[opcode].exceptions |= CYCLE_BRANCH2;
+            else if (!strcmp(token[i], "65c02"))
+                records[opcode].exceptions |= _65C02;
+            else if (!strcmp(token[i], "undoc"))
+                records[opcode].exceptions |= UNDOC;
+            else if (!strcmp(token[i], "m"))
+                records[opcode].exceptions |= CYCLE_M;
+            else if (!strcmp(token[i], "x"))
+                records[opcode].exceptions |= CYCLE_X;
+            else if (!strcmp(token[i], "rmw"))
+                records[opcode].exceptions |= CYCLE_RMW;
+            else
+                cpu_error(path, line, "Unknown flag, expected page, branch, branch2, 65c02, undoc, m, x or rmw");
+        }
+    }
+    fclose(file);
+}
+
+/* This function writes the header of a table compiled from a text
+   definition of the given size and time */
+static void cpu_header(uint8_t *header, const struct stat *source, const cpu_record_t *records) {
+    uint32_t version = CPU_VERSION;
+    uint64_t size    = (uint64_t)source->st_size;
+    uint64_t time    = (uint64_t)source->st_mtime;
+    uint64_t key     = hash_bytes(0, records, NUMBER_OPCODES * sizeof(records[0]));
+
+    memcpy(&header[0], CPU_MAGIC, 4);
+    memcpy(&header[4], &version, 4);
+    memcpy(&header[8], &size, 8);
+    memcpy(&header[16], &time, 8);
+    memcpy(&header[24], &key, 8);
+}
+
+/* This function maps the compiled table of source. Returns NULL when it is
+   missing, stale or damaged and the text must be compiled again */
+static const cpu_record_t *cpu_map(const char *table, const struct stat *source) {
+    const cpu_record_t *records;
+    const uint8_t      *data;
+    uint8_t             header[CPU_HEADER_SIZE];
+    unsigned long       size;
+    int                 i;
+
+    if (!map_file(table, &data, &size))
+        return NULL;
+
+    records = (const cpu_record_t *)(const void *)(data + CPU_HEADER_SIZE);
+    if (size == CPU_HEADER_SIZE + NUMBER_OPCODES * sizeof(cpu_record_t)) {
+        cpu_header(header, source, records);
+        for (i = 0; i < NUMBER_OPCODES; i++) {
+            if (('\0' != records[i].mnemonic[CPU_MNEMONIC_SIZE - 1]) || (records[i].addressing > TSTAX) ||
+                (records[i].exceptions & ~(CYCLE_MASK | _65C02 | BAD | UNDOC | CYCLE_M | CYCLE_X | CYCLE_RMW)))
+                break;
+        }
+        if ((NUMBER_OPCODES == i) && !memcmp(header, data, CPU_HEADER_SIZE))
+            return records;
+    }
+
+    unmap_file(data, size);
+    return NULL;
+}
+
+/* This function writes the compiled table, under a temporary name first so
+   other runs never map a partial table */
+static void cpu_save(const char *table, const struct stat *source, const cpu_record_t *records) {
+    char     temp[4096 + sizeof(".tmp")];
+    uint8_t  header[CPU_HEADER_SIZE];
+    FILE    *file;
+    int      ok;
+
+    cpu_header(header, source, records);
+    snprintf(temp, sizeof(temp), "%s.tmp", table);
+    file = fopen(temp, "wb");
+    if (NULL == file) {
+        fprintf(stderr, ";WARNING: Could not write CPU table %s\n", table);
+        return;
+    }
+
+    ok = (1 == fwrite(header, sizeof(header), 1, file)) &&
+         (NUMBER_OPCODES == fwrite(records, sizeof(records[0]), NUMBER_OPCODES, file));
+    if (fclose(file) || !ok || rename(temp, table)) {
+        remove(temp);
+        fprintf(stderr, ";WARNING: Could not write CPU table %s\n", table);
+    }
+}
+
+/* This function selects the instruction set of the CPU definition at path:
+   the compiled table is mapped, or compiled and written when it is missing
+   or older than the text. The mapping stays for the whole run, the opcode
+   table points at its mnemonics */
+static void cpu_load(const char *path) {
+    static cpu_record_t  compiled[NUMBER_OPCODES];
+    const cpu_record_t  *records;
+    char                 table[4096];
+    struct stat          source;
+    int                  i;
+
+    if (0 != stat(path, &source)) {
+        version();
+        fprintf(stderr, "File not found or invalid: \"%s\"\n", path);
+        exit(2);
     }
 
-    free(buffer);
+    snprintf(table, sizeof(table), "%s%s", path, CPU_SUFFIX);
+    records = cpu_map(table, &source);
+    if (NULL == records) {
+        cpu_compile(path, compiled);
+        cpu_save(table, &source, compiled);
+        records = compiled;
+    }
+
+    for (i = 0; i < NUMBER_OPCODES; i++) {
+        g_cpu_table[i].mnemonic          = records[i].mnemonic;
+        g_cpu_table[i].addressing        = (addressing_mode_e)records[i].addressing;
+        g_cpu_table[i].cycles            = records[i].cycles;
+        g_cpu_table[i].cycles_exceptions = records[i].exceptions;
+    }
+    g_cpu_key = hash_bytes(0, records, NUMBER_OPCODES * sizeof(records[0]));
+    dcc6502_init_table(&g_dcc, g_cpu_table);
+}
+
+int main(int argc, char *argv[]) {
+    char         *output;        /* Output buffer */
+    uint8_t      *window = NULL; /* Input window of the read path */
+    file_list_t   files;         /* Input files of batch mode */
+    struct stat   st;
+    options_t     options;       /* Command-line options parsing results */
+    int           i, status;
+
+    parse_args(argc, argv, &options);
+    if (NULL != options.cpu_path)
+        cpu_load(options.cpu_path);
+    else
+        dcc6502_init(&g_dcc, options.cpu);
+    build_templates(&options);
+
+    if (NULL != options.socket_path) {
+        return disassemble_daemon(&options);
+    }
+
+    if (NULL != options.diff_path) {
+        return disassemble_diff(&options);
+    }
+
+    if (NULL != options.ngram_index) {
+        pattern_parse(&g_pattern, options.pattern);
+        return ngram_query(&options);
+    }
+
+    if (NULL != options.cache_dir) {
+#if HAVE_POSIX
+        mkdir(options.cache_dir, 0777);
+#endif
+        LOCK_INIT(&g_cache_stats.lock);
+    }
+
+    /* Several files, a manifest or a directory: one listing per file */
+    if ((NULL != options.pattern) || options.stats || (NULL != options.ngram_output) || (options.num_files > 1) || (NULL != options.manifest) ||
+        ((1 == options.num_files) && (0 == stat(options.filename, &st)) && S_ISDIR(st.st_mode))) {
+        memset(&files, 0, sizeof(files));
+        for (i = 0; i < options.num_files; i++)
+            file_list_walk(&files, options.filenames[i]);
+        if (NULL != options.manifest)
+            file_list_read_manifest(&files, options.manifest);
+
+        options.batch = 1;
+        if ((NULL != options.pattern) || options.stats) {
+            if (NULL != options.pattern)
+                pattern_parse(&g_pattern, options.pattern);
+            status = scan_batch(&options, &files);
+        } else if (NULL != options.ngram_output) {
+            status = ngram_build(&options, &files);
+        } else {
+            status = disassemble_batch(&options, &files);
+        }
+        if (NULL != options.cache_dir)
+            cache_report(&options);
+
+        for (i = 0; (size_t)i < files.count; i++)
+            free(files.names[i]);
+        free(files.names);
+        free(files.relative);
+        return status;
+    }
+
+    output = malloc(OUTPUT_BUFFER_SIZE);
+    if (NULL == output) {
+        usage_and_exit(3, "Could not allocate output buffer.");
+    }
+
+    if (UNKNOWN_SIZE == disassemble_file(&options, stdout, output, &window)) {
+        version();
+        fprintf(stderr, "File not found or invalid filename : %s\n", options.filename);
+        exit(2);
+    }
+
+    if (NULL != options.cache_dir)
+        cache_report(&options);
+
+    free(output);
+    free(window);
 
     return 0;
 }
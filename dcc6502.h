@@ -0,0 +1,234 @@
+/**********************************************************************************
+ * dcc6502.h -> Public interface of libdcc6502:                                   *
+ * Disassembler and Cycle Counter for the 6502 microprocessor                     *
+ *                                                                                *
+ * This code is offered under the MIT License (MIT)                               *
+ *                                                                                *
+ * Copyright (c) 1998-2014 Tennessee Carmel-Veilleux <veilleux@tentech.ca>        *
+ * Copyright (c) 2017      Michael Pohoreski <michaelangel007@sharedcraft.com>    *
+ *                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ * of this software and associated documentation files (the "Software"), to deal  *
+ * in the Software without restriction, including without limitation the rights   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ * copies of the Software, and to permit persons to whom the Software is          *
+ * furnished to do so, subject to the following conditions:                       *
+ *                                                                                *
+ * The above copyright notice and this permission notice shall be included in all *
+ * copies or substantial portions of the Software.                                *
+ *                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ * SOFTWARE.                                                                      *
+ **********************************************************************************/
+#ifndef DCC6502_H
+#define DCC6502_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUMBER_OPCODES 256
+#define MAX_INSTRUCTION_LENGTH 7
+
+/* Exceptions for cycle counting */
+#define CYCLE_PAGE      (1 << 0) // Cross page boundary, +1 cycle
+#define CYCLE_BRANCH    (1 << 1) // Branch taken, +1 cycle
+#define _65C02          (1 << 2) // 65C02 only instruction
+#define BAD             (1 << 3) // Illegal 6502 instruction
+#define UNDOC           (1 << 4) // Undocumented NMOS 6502 instruction
+#define CYCLE_M         (1 << 5) // 65816: +1 cycle with a 16-bit accumulator, immediate operand sized by M
+#define CYCLE_X         (1 << 6) // 65816: +1 cycle with 16-bit index registers, immediate operand sized by X
+#define CYCLE_RMW       (1 << 7) // 65816: +2 cycles with a 16-bit accumulator, read-modify-write
+#define CYCLE_BRANCH2   (1 << 8) // HuC6280: branch taken, +2 cycles
+#define CYCLE_MASK      (CYCLE_PAGE | CYCLE_BRANCH | CYCLE_BRANCH2)
+
+/* HuC6280 block transfers take their base cycles plus this many per byte */
+#define DCC6502_BLOCK_CYCLES 6
+
+/* The 6502's 13 addressing modes, then those added by the 65C02, the 65816 and the HuC6280 */
+typedef enum {
+    IMMED = 0, /* Immediate */
+    ABSOL,     /* Absolute */
+    ZEROP,     /* Zero Page */
+    IMPLI,     /* Implied */
+    INDIA,     /* Indirect Absolute */
+    ABSIX,     /* Absolute indexed with X */
+    ABSIY,     /* Absolute indexed with Y */
+    ZEPIX,     /* Zero page indexed with X */
+    ZEPIY,     /* Zero page indexed with Y */
+    INDIN,     /* Indexed indirect (with X) */
+    ININD,     /* Indirect indexed (with Y) */
+    RELAT,     /* Relative */
+    ACCUM,     /* Accumulator */
+    ZEPIN,     /* Zero page indirect */
+    INDAX,     /* Absolute indexed indirect (with X), JMP ($1234,X) */
+    ZEREL,     /* Zero page and relative, BBR0 $12,$1234 */
+    ABSLO,     /* Absolute long, LDA $123456 */
+    ABLIX,     /* Absolute long indexed with X, LDA $123456,X */
+    INDLO,     /* Zero page indirect long, LDA [$12] */
+    INLIY,     /* Zero page indirect long indexed with Y, LDA [$12],Y */
+    STREL,     /* Stack relative, LDA $12,S */
+    SRIIY,     /* Stack relative indirect indexed with Y, LDA ($12,S),Y */
+    RELLO,     /* Relative long, BRL $1234 */
+    BLKMV,     /* Block move, source then destination bank, MVN $12,$34 */
+    INDLA,     /* Absolute indirect long, JML [$1234] */
+    BLKTR,     /* Block transfer, source, destination and length, TII $1234,$5678,$0010 */
+    TSTZP,     /* Immediate and zero page, TST #$12,$34 */
+    TSTAB,     /* Immediate and absolute, TST #$12,$3456 */
+    TSTZX,     /* Immediate and zero page indexed with X, TST #$12,$34,X */
+    TSTAX      /* Immediate and absolute indexed with X, TST #$12,$3456,X */
+} addressing_mode_e;
+
+typedef struct opcode_s {
+    const char       *mnemonic;          /* Mnemonic text, "???" for illegal opcodes */
+    addressing_mode_e addressing;        /* Addressing mode */
+    unsigned int      cycles;            /* Number of cycles */
+    unsigned int      cycles_exceptions; /* Mask of cycle-counting exceptions */
+} opcode_t;
+
+typedef struct addressing_s {
+    unsigned int length;  /* Instruction length in bytes */
+    const char  *prefix;  /* Operand text before the digits */
+    unsigned int digits;  /* Number of operand hex digits */
+    const char  *suffix;  /* Operand text after the digits */
+    const char  *name;    /* Name of the addressing mode, for cross-references */
+} addressing_t;
+
+/* Instruction sets */
+typedef enum {
+    DCC6502_CPU_6502 = 0, /* NMOS 6502 */
+    DCC6502_CPU_65C02,    /* CMOS 65C02 */
+    DCC6502_CPU_6502_UNDOC, /* NMOS 6502 with the stable undocumented opcodes */
+    DCC6502_CPU_65816,    /* WDC 65816, 24-bit addresses */
+    DCC6502_CPU_HUC6280   /* Hudson HuC6280 of the PC Engine */
+} dcc6502_cpu_e;
+
+/* 65816 processor state followed from instruction to instruction by
+   dcc6502_track: the bits of P that size immediate operands, and the
+   emulation flag XCE swaps with the carry */
+#define DCC6502_P_C      0x001 /* Carry, valid with DCC6502_P_CKNOWN */
+#define DCC6502_P_X      0x010 /* 8-bit index registers */
+#define DCC6502_P_M      0x020 /* 8-bit accumulator and memory */
+#define DCC6502_P_E      0x100 /* Emulation mode, M and X stay set */
+#define DCC6502_P_CKNOWN 0x200 /* The carry was set by the previous instruction */
+#define DCC6502_P_RESET  (DCC6502_P_E | DCC6502_P_M | DCC6502_P_X)
+
+/* Decoder state, filled by dcc6502_init. It holds no pointer to heap memory
+   and may live on the stack; several threads may share one decoder */
+typedef struct dcc6502_s {
+    const opcode_t *table;                    /* Opcode table of the instruction set */
+    uint8_t         mnemonic[NUMBER_OPCODES]; /* Mnemonic id of each opcode */
+} dcc6502_t;
+
+/* One decoded instruction */
+typedef struct dcc6502_insn_s {
+    uint32_t          address;    /* Address of the opcode, the bank in bits 16-23 */
+    uint32_t          operand;    /* Operand as encoded: byte, word, long or signed branch offset, 0 if none.
+                                     ZEREL: the zero page byte, then the offset in the high byte.
+                                     BLKMV: the destination bank, then the source bank.
+                                     BLKTR: the source, then the destination in the high word.
+                                     TST modes: the immediate byte, then the address */
+    uint32_t          target;     /* Resolved operand: the branch target for relative branches,
+                                     the address of TST, the destination of block transfers */
+    uint8_t           opcode;     /* Opcode, index in the opcode table */
+    uint8_t           length;     /* Length in bytes, 1 for illegal opcodes */
+    uint8_t           bytes[MAX_INSTRUCTION_LENGTH]; /* Raw bytes, zero past length */
+    uint8_t           mnemonic;   /* Mnemonic id, see dcc6502_mnemonic */
+    uint32_t          cycles_min; /* Cycles without page crossing, or with the branch not taken */
+    uint32_t          cycles_max; /* Cycles with page crossing, or with the branch taken */
+    uint16_t          flags;      /* Mask of CYCLE_PAGE, CYCLE_BRANCH, _65C02, BAD, UNDOC, CYCLE_M, CYCLE_X,
+                                     CYCLE_RMW, CYCLE_BRANCH2 */
+    addressing_mode_e addressing; /* Addressing mode */
+} dcc6502_insn_t;
+
+/* Binary record output: a DCC6502_HEADER_SIZE header followed by one
+   DCC6502_RECORD_SIZE record per instruction, all fields little endian.
+
+   Header                          Record
+    0  4 magic "DCCR"               0  2 address
+    4  2 version                    2  3 raw bytes, zero past length
+    6  2 record size                5  1 length
+    8  2 origin                     6  1 opcode, index in the opcode table
+   10  1 dcc6502_cpu_e              7  1 addressing_mode_e
+   11  1 origin bank (v2)           8  2 resolved operand (branch target)
+   12  4 reserved, zero            10  1 min cycles, 255 if more
+                                   11  1 max cycles, 255 if more
+                                   12  1 flags, cycles_exceptions bits 0-7
+                                   13  1 mnemonic id
+                                   14  1 fourth raw byte (v2)
+                                   15  1 address bank (v2)
+                                   16  3 fifth to seventh raw bytes (v3)
+                                   19  1 flags, cycles_exceptions bits 8-15 (v3)
+                                   20  4 min cycles (v3)
+                                   24  4 max cycles (v3)
+                                   28  4 reserved, zero
+
+   Readers must check the version and skip record size bytes per record,
+   later versions only append fields. Version 2 uses the bytes reserved by
+   version 1 for the 65816, they stay zero for the 8-bit instruction sets.
+   Version 3 appends the rest of the 7 byte HuC6280 block transfers and
+   their cycles, which exceed a byte */
+#define DCC6502_RECORD_MAGIC   "DCCR"
+#define DCC6502_RECORD_VERSION 3
+#define DCC6502_HEADER_SIZE    16
+#define DCC6502_RECORD_SIZE    32
+
+/* Called for every instruction of a range, return non-zero to stop */
+typedef int (*dcc6502_callback_t)(const dcc6502_insn_t *insn, void *user);
+
+/* Prepare a decoder for an instruction set */
+void dcc6502_init(dcc6502_t *dcc, dcc6502_cpu_e cpu);
+
+/* Prepare a decoder for a caller provided opcode table of NUMBER_OPCODES
+   entries, e.g. one loaded from a CPU definition file. The table must outlive
+   the decoder. Mnemonics missing from the name table get id 0 */
+void dcc6502_init_table(dcc6502_t *dcc, const opcode_t *table);
+
+/* Decode the instruction at code, located at address. Returns its length,
+   or 0 when it does not fit in the avail bytes of code */
+size_t dcc6502_decode(const dcc6502_t *dcc, const uint8_t *code, size_t avail, uint16_t address, dcc6502_insn_t *insn);
+
+/* Same as dcc6502_decode, at a 24-bit address and with the DCC6502_P_*
+   state p sizing the 65816 immediate operands */
+size_t dcc6502_decode_p(const dcc6502_t *dcc, const uint8_t *code, size_t avail, uint32_t address, unsigned int p, dcc6502_insn_t *insn);
+
+/* Returns the DCC6502_P_* state after insn executed in state p: REP, SEP
+   and XCE change the register widths, CLC and SEC feed XCE */
+unsigned int dcc6502_track(const dcc6502_insn_t *insn, unsigned int p);
+
+/* Decode the instructions of the length bytes of code, located at org, and
+   pass each to callback. Addresses wrap around within their 64K bank, the
+   65816 register widths are tracked from DCC6502_P_RESET. Stops at a
+   truncated last instruction or when callback returns non-zero. Performs no
+   heap allocation. Returns the number of bytes decoded */
+size_t dcc6502_disassemble(const dcc6502_t *dcc, const uint8_t *code, size_t length, uint32_t org, dcc6502_callback_t callback, void *user);
+
+/* Write the assembly text of insn, e.g. "LDA $1234,X", NUL terminated into
+   size bytes of output. Returns the length of the text */
+size_t dcc6502_format(const dcc6502_insn_t *insn, char *output, size_t size);
+
+/* Write the binary header of a record stream. Returns DCC6502_HEADER_SIZE */
+size_t dcc6502_record_header(uint8_t *output, uint32_t org, dcc6502_cpu_e cpu);
+
+/* Write the binary record of insn. Returns DCC6502_RECORD_SIZE */
+size_t dcc6502_record(const dcc6502_insn_t *insn, uint8_t *output);
+
+/* Name of a mnemonic id. Ids are stable across versions */
+const char *dcc6502_mnemonic(unsigned int id);
+
+/* Operand layout of an addressing mode */
+const addressing_t *dcc6502_addressing(addressing_mode_e mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DCC6502_H */
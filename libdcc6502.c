@@ -0,0 +1,1694 @@
+/**********************************************************************************
+ * libdcc6502.c -> Decoding core of:                                              *
+ * Disassembler and Cycle Counter for the 6502 microprocessor                     *
+ *                                                                                *
+ * This code is offered under the MIT License (MIT)                               *
+ *                                                                                *
+ * Copyright (c) 1998-2014 Tennessee Carmel-Veilleux <veilleux@tentech.ca>        *
+ * Copyright (c) 2017      Michael Pohoreski <michaelangel007@sharedcraft.com>    *
+ *                                                                                *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy   *
+ * of this software and associated documentation files (the "Software"), to deal  *
+ * in the Software without restriction, including without limitation the rights   *
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      *
+ * copies of the Software, and to permit persons to whom the Software is          *
+ * furnished to do so, subject to the following conditions:                       *
+ *                                                                                *
+ * The above copyright notice and this permission notice shall be included in all *
+ * copies or substantial portions of the Software.                                *
+ *                                                                                *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     *
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       *
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    *
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         *
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  *
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  *
+ * SOFTWARE.                                                                      *
+ **********************************************************************************/
+#include <string.h>
+
+#include "dcc6502.h"
+
+/* Mnemonics, indexed by mnemonic id. New mnemonics are appended so that
+   ids stay stable */
+static const char *g_mnemonics[] = {
+    "???",
+    "ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI", "BNE", "BPL",
+    "BRK", "BVC", "BVS", "CLC", "CLD", "CLI", "CLV", "CMP", "CPX", "CPY",
+    "DEC", "DEX", "DEY", "EOR", "INC", "INX", "INY", "JMP", "JSR", "LDA",
+    "LDX", "LDY", "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL",
+    "ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI", "STA", "STX", "STY",
+    "TAX", "TAY", "TSX", "TXA", "TXS", "TYA",
+    "BRA", "PHX", "PHY", "PLX", "PLY", "STP", "STZ", "TRB", "TSB", "WAI",
+    "BBR0", "BBR1", "BBR2", "BBR3", "BBR4", "BBR5", "BBR6", "BBR7",
+    "BBS0", "BBS1", "BBS2", "BBS3", "BBS4", "BBS5", "BBS6", "BBS7",
+    "RMB0", "RMB1", "RMB2", "RMB3", "RMB4", "RMB5", "RMB6", "RMB7",
+    "SMB0", "SMB1", "SMB2", "SMB3", "SMB4", "SMB5", "SMB6", "SMB7",
+    "ALR", "ANC", "ARR", "DCP", "ISC", "LAX", "RLA", "RRA", "SAX", "SBX", "SLO", "SRE",
+    "BRL", "COP", "JML", "JSL", "MVN", "MVP", "PEA", "PEI", "PER", "PHB", "PHD", "PHK", "PLB",
+    "PLD", "REP", "RTL", "SEP", "TCD", "TCS", "TDC", "TSC", "TXY", "TYX", "WDM", "XBA", "XCE",
+    "BSR", "CLA", "CLX", "CLY", "CSH", "CSL", "SAY", "SET", "ST0", "ST1", "ST2", "SXY", "TAI",
+    "TAM", "TDD", "TIA", "TII", "TIN", "TMA", "TST",
+    NULL
+};
+
+/* Ids in g_mnemonics of the instructions followed by dcc6502_track */
+enum {
+    MNEMONIC_CLC = 14,
+    MNEMONIC_SEC = 45,
+    MNEMONIC_REP = 125,
+    MNEMONIC_SEP = 127,
+    MNEMONIC_XCE = 136
+};
+
+/* Opcode table */
+static const opcode_t g_6502_opcodes[NUMBER_OPCODES] = {
+    {"BRK", IMPLI, 7, 0                        }, /* 00 BRK */
+    {"ORA", INDIN, 6, 0                        }, /* 01 ORA */
+    {"???", 0    , 2, BAD                      }, /* 02     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 03     illegal 6502 */
+    {"???", 0    , 3, BAD                      }, /* 04     illegal 6502 */
+    {"ORA", ZEROP, 3, 0                        }, /* 05 ORA */
+    {"ASL", ZEROP, 5, 0                        }, /* 06 ASL */
+    {"???", 0    , 5, BAD                      }, /* 07     illegal 6502 */
+    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
+    {"ORA", IMMED, 2, 0                        }, /* 09 ORA */
+    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
+    {"???", 0    , 2, BAD                      }, /* 0B     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 0C     illegal 6502 */
+    {"ORA", ABSOL, 4, 0                        }, /* 0D ORA */
+    {"ASL", ABSOL, 6, 0                        }, /* 0E ASL */
+    {"???", 0    , 6, BAD                      }, /* 0F     illegal 6502 */
+    {"BPL", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 10 BPL */
+    {"ORA", ININD, 5, CYCLE_PAGE               }, /* 11 ORA */
+    {"???", 0    , 2, BAD                      }, /* 12     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 13     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 14     illegal 6502 */
+    {"ORA", ZEPIX, 4, 0                        }, /* 15 ORA */
+    {"ASL", ZEPIX, 6, 0                        }, /* 16 ASL */
+    {"???", 0    , 6, BAD                      }, /* 17     illegal 6502 */
+    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
+    {"ORA", ABSIY, 4, CYCLE_PAGE               }, /* 19 ORA */
+    {"???", 0    , 2, BAD                      }, /* 1A     illegal 6502 */
+    {"???", 0    , 7, BAD                      }, /* 1B     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 1C     illegal 6502 */
+    {"ORA", ABSIX, 4, CYCLE_PAGE               }, /* 1D ORA */
+    {"ASL", ABSIX, 7, 0                        }, /* 1E ASL */
+    {"???", 0    , 7, BAD                      }, /* 1F     illegal 6502 */
+    {"JSR", ABSOL, 6, 0                        }, /* 20 JSR */
+    {"AND", INDIN, 6, 0                        }, /* 21 AND */
+    {"???", 0    , 2, BAD                      }, /* 22     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 23     illegal 6502 */
+    {"BIT", ZEROP, 3, 0                        }, /* 24 BIT */
+    {"AND", ZEROP, 3, 0                        }, /* 25 AND */
+    {"ROL", ZEROP, 5, 0                        }, /* 26 ROL */
+    {"???", 0    , 5, BAD                      }, /* 27     illegal 6502 */
+    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
+    {"AND", IMMED, 2, 0                        }, /* 29 AND */
+    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
+    {"???", 0    , 2, BAD                      }, /* 2B     illegal 6502 */
+    {"BIT", ABSOL, 4, 0                        }, /* 2C BIT */
+    {"AND", ABSOL, 4, 0                        }, /* 2D AND */
+    {"ROL", ABSOL, 6, 0                        }, /* 2E ROL */
+    {"???", 0    , 6, BAD                      }, /* 2F     illegal 6502 */
+    {"BMI", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 30 BMI */
+    {"AND", ININD, 5, CYCLE_PAGE               }, /* 31 AND */
+    {"???", 0    , 2, BAD                      }, /* 32     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 33     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 34     illegal 6502 */
+    {"AND", ZEPIX, 4, 0                        }, /* 35 AND */
+    {"ROL", ZEPIX, 6, 0                        }, /* 36 ROL */
+    {"???", 0    , 6, BAD                      }, /* 37     illegal 6502 */
+    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
+    {"AND", ABSIY, 4, CYCLE_PAGE               }, /* 39 AND */
+    {"???", 0    , 2, BAD                      }, /* 3A     illegal 6502 */
+    {"???", 0    , 7, BAD                      }, /* 3B     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 3C     illegal 6502 */
+    {"AND", ABSIX, 4, CYCLE_PAGE               }, /* 3D AND */
+    {"ROL", ABSIX, 7, 0                        }, /* 3E ROL */
+    {"???", 0    , 7, BAD                      }, /* 3F     illegal 6502 */
+    {"RTI", IMPLI, 6, 0                        }, /* 40 RTI */
+    {"EOR", INDIN, 6, 0                        }, /* 41 EOR */
+    {"???", 0    , 2, BAD                      }, /* 42     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 43     illegal 6502 */
+    {"???", 0    , 3, BAD                      }, /* 44     illegal 6502 */
+    {"EOR", ZEROP, 3, 0                        }, /* 45 EOR */
+    {"LSR", ZEROP, 5, 0                        }, /* 46 LSR */
+    {"???", 0    , 5, BAD                      }, /* 47     illegal 6502 */
+    {"PHA", IMPLI, 3, 0                        }, /* 48 PHA */
+    {"EOR", IMMED, 2, 0                        }, /* 49 EOR */
+    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
+    {"???", 0    , 2, BAD                      }, /* 4B     illegal 6502 */
+    {"JMP", ABSOL, 3, 0                        }, /* 4C JMP */
+    {"EOR", ABSOL, 4, 0                        }, /* 4D EOR */
+    {"LSR", ABSOL, 6, 0                        }, /* 4E LSR */
+    {"???", 0    , 6, BAD                      }, /* 4F     illegal 6502 */
+    {"BVC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 50 BVC */
+    {"EOR", ININD, 5, CYCLE_PAGE               }, /* 51 EOR */
+    {"???", 0    , 2, BAD                      }, /* 52     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 53     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 54     illegal 6502 */
+    {"EOR", ZEPIX, 4, 0                        }, /* 55 EOR */
+    {"LSR", ZEPIX, 6, 0                        }, /* 56 LSR */
+    {"???", 0    , 6, BAD                      }, /* 57     illegal 6502 */
+    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
+    {"EOR", ABSIY, 4, CYCLE_PAGE               }, /* 59 EOR */
+    {"???", 0    , 2, BAD                      }, /* 5A     illegal 6502 */
+    {"???", 0    , 7, BAD                      }, /* 5B     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 5C     illegal 6502 */
+    {"EOR", ABSIX, 4, CYCLE_PAGE               }, /* 5D EOR */
+    {"LSR", ABSIX, 7, 0                        }, /* 5E LSR */
+    {"???", 0    , 7, BAD                      }, /* 5F     illegal 6502 */
+    {"RTS", IMPLI, 6, 0                        }, /* 60 RTS */
+    {"ADC", INDIN, 6, 0                        }, /* 61 ADC */
+    {"???", 0    , 2, BAD                      }, /* 62     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 63     illegal 6502 */
+    {"???", 0    , 3, BAD                      }, /* 64     illegal 6502 */
+    {"ADC", ZEROP, 3, 0                        }, /* 65 ADC */
+    {"ROR", ZEROP, 5, 0                        }, /* 66 ROR */
+    {"???", 0    , 5, BAD                      }, /* 67     illegal 6502 */
+    {"PLA", IMPLI, 4, 0                        }, /* 68 PLA */
+    {"ADC", IMMED, 2, 0                        }, /* 69 ADC */
+    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
+    {"???", 0    , 2, BAD                      }, /* 6B     illegal 6502 */
+    {"JMP", INDIA, 5, 0                        }, /* 6C JMP */
+    {"ADC", ABSOL, 4, 0                        }, /* 6D ADC */
+    {"ROR", ABSOL, 6, 0                        }, /* 6E ROR */
+    {"???", 0    , 6, BAD                      }, /* 6F     illegal 6502 */
+    {"BVS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 70 BVS */
+    {"ADC", ININD, 5, CYCLE_PAGE               }, /* 71 ADC */
+    {"???", 0    , 2, BAD                      }, /* 72     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* 73     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 74     illegal 6502 */
+    {"ADC", ZEPIX, 4, 0                        }, /* 75 ADC */
+    {"ROR", ZEPIX, 6, 0                        }, /* 76 ROR */
+    {"???", 0    , 6, BAD                      }, /* 77     illegal 6502 */
+    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
+    {"ADC", ABSIY, 4, CYCLE_PAGE               }, /* 79 ADC */
+    {"???", 0    , 2, BAD                      }, /* 7A     illegal 6502 */
+    {"???", 0    , 7, BAD                      }, /* 7B     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* 7C     illegal 6502 */
+    {"ADC", ABSIX, 4, CYCLE_PAGE               }, /* 7D ADC */
+    {"ROR", ABSIX, 7, 0                        }, /* 7E ROR */
+    {"???", 0    , 7, BAD                      }, /* 7F     illegal 6502 */
+    {"???", 0    , 2, BAD                      }, /* 80     illegal 6502 */
+    {"STA", INDIN, 6, 0                        }, /* 81 STA */
+    {"???", 0    , 2, BAD                      }, /* 82     illegal 6502 */
+    {"???", 0    , 6, BAD                      }, /* 83     illegal 6502 */
+    {"STY", ZEROP, 3, 0                        }, /* 84 STY */
+    {"STA", ZEROP, 3, 0                        }, /* 85 STA */
+    {"STX", ZEROP, 3, 0                        }, /* 86 STX */
+    {"???", 0    , 3, BAD                      }, /* 87     illegal 6502 */
+    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
+    {"???", 0    , 2, BAD                      }, /* 89     illegal 6502 */
+    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
+    {"???", 0    , 2, BAD                      }, /* 8B     illegal 6502 */
+    {"STY", ABSOL, 4, 0                        }, /* 8C STY */
+    {"STA", ABSOL, 4, 0                        }, /* 8D STA */
+    {"STX", ABSOL, 4, 0                        }, /* 8E STX */
+    {"???", 0    , 4, BAD                      }, /* 8F     illegal 6502 */
+    {"BCC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 90 BCC */
+    {"STA", ININD, 6, 0                        }, /* 91 STA */
+    {"???", 0    , 2, BAD                      }, /* 92     illegal 6502 */
+    {"???", 0    , 6, BAD                      }, /* 93     illegal 6502 */
+    {"STY", ZEPIX, 4, 0                        }, /* 94 STY */
+    {"STA", ZEPIX, 4, 0                        }, /* 95 STA */
+    {"STX", ZEPIY, 4, 0                        }, /* 96 STX */
+    {"???", 0    , 4, BAD                      }, /* 97     illegal 6502 */
+    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
+    {"STA", ABSIY, 5, 0                        }, /* 99 STA */
+    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
+    {"???", 0    , 5, BAD                      }, /* 9B     illegal 6502 */
+    {"???", 0    , 5, BAD                      }, /* 9C     illegal 6502 */
+    {"STA", ABSIX, 5, 0                        }, /* 9D STA */
+    {"???", 0    , 5, BAD                      }, /* 9E     illegal 6502 */
+    {"???", 0    , 5, BAD                      }, /* 9F     illegal 6502 */
+    {"LDY", IMMED, 2, 0                        }, /* A0 LDY */
+    {"LDA", INDIN, 6, 0                        }, /* A1 LDA */
+    {"LDX", IMMED, 2, 0                        }, /* A2 LDX */
+    {"???", 0    , 6, BAD                      }, /* A3     illegal 6502 */
+    {"LDY", ZEROP, 3, 0                        }, /* A4 LDY */
+    {"LDA", ZEROP, 3, 0                        }, /* A5 LDA */
+    {"LDX", ZEROP, 3, 0                        }, /* A6 LDX */
+    {"???", 0    , 3, BAD                      }, /* A7     illegal 6502 */
+    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
+    {"LDA", IMMED, 2, 0                        }, /* A9 LDA */
+    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
+    {"???", 0    , 2, BAD                      }, /* AB     illegal 6502 */
+    {"LDY", ABSOL, 4, 0                        }, /* AC LDY */
+    {"LDA", ABSOL, 4, 0                        }, /* AD LDA */
+    {"LDX", ABSOL, 4, 0                        }, /* AE LDX */
+    {"???", 0    , 4, BAD                      }, /* AF     illegal 6502 */
+    {"BCS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* B0 BCS */
+    {"LDA", ININD, 5, CYCLE_PAGE               }, /* B1 LDA */
+    {"???", 0    , 2, BAD                      }, /* B2     illegal 6502 */
+    {"???", 0    , 5, BAD                      }, /* B3     illegal 6502 */
+    {"LDY", ZEPIX, 4, 0                        }, /* B4 LDY */
+    {"LDA", ZEPIX, 4, 0                        }, /* B5 LDA */
+    {"LDX", ZEPIY, 4, 0                        }, /* B6 LDX */
+    {"???", 0    , 4, BAD                      }, /* B7     illegal 6502 */
+    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
+    {"LDA", ABSIY, 4, CYCLE_PAGE               }, /* B9 LDA */
+    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
+    {"???", 0    , 4, BAD                      }, /* BB     illegal 6502 */
+    {"LDY", ABSIX, 4, CYCLE_PAGE               }, /* BC LDY */
+    {"LDA", ABSIX, 4, CYCLE_PAGE               }, /* BD LDA */
+    {"LDX", ABSIY, 4, CYCLE_PAGE               }, /* BE LDX */
+    {"???", 0    , 4, BAD                      }, /* BF     illegal 6502 */
+    {"CPY", IMMED, 2, 0                        }, /* C0 CPY */
+    {"CMP", INDIN, 6, 0                        }, /* C1 CMP */
+    {"???", 0    , 2, BAD                      }, /* C2     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* C3     illegal 6502 */
+    {"CPY", ZEROP, 3, 0                        }, /* C4 CPY */
+    {"CMP", ZEROP, 3, 0                        }, /* C5 CMP */
+    {"DEC", ZEROP, 5, 0                        }, /* C6 DEC */
+    {"???", 0    , 5, BAD                      }, /* C7     illegal 6502 */
+    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
+    {"CMP", IMMED, 2, 0                        }, /* C9 CMP */
+    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
+    {"???", 0    , 2, BAD                      }, /* CB     illegal 6502 */
+    {"CPY", ABSOL, 4, 0                        }, /* CC CPY */
+    {"CMP", ABSOL, 4, 0                        }, /* CD CMP */
+    {"DEC", ABSOL, 6, 0                        }, /* CE DEC */
+    {"???", 0    , 6, BAD                      }, /* CF     illegal 6502 */
+    {"BNE", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* D0 BNE */
+    {"CMP", ININD, 5, CYCLE_PAGE               }, /* D1 CMP */
+    {"???", 0    , 2, BAD                      }, /* D2     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* D3     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* D4     illegal 6502 */
+    {"CMP", ZEPIX, 4, 0                        }, /* D5 CMP */
+    {"DEC", ZEPIX, 6, 0                        }, /* D6 DEC */
+    {"???", 0    , 6, BAD                      }, /* D7     illegal 6502 */
+    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
+    {"CMP", ABSIY, 4, CYCLE_PAGE               }, /* D9 CMP */
+    {"???", 0    , 2, BAD                      }, /* DA     illegal 6502 */
+    {"???", 0    , 7, BAD                      }, /* DB     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* DC     illegal 6502 */
+    {"CMP", ABSIX, 4, CYCLE_PAGE               }, /* DD CMP */
+    {"DEC", ABSIX, 7, 0                        }, /* DE DEC */
+    {"???", 0    , 7, BAD                      }, /* DF     illegal 6502 */
+    {"CPX", IMMED, 2, 0                        }, /* E0 CPX */
+    {"SBC", INDIN, 6, 0                        }, /* E1 SBC */
+    {"???", 0    , 2, BAD                      }, /* E2     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* E3     illegal 6502 */
+    {"CPX", ZEROP, 3, 0                        }, /* E4 CPX */
+    {"SBC", ZEROP, 3, 0                        }, /* E5 SBC */
+    {"INC", ZEROP, 5, 0                        }, /* E6 INC */
+    {"???", 0    , 5, BAD                      }, /* E7     illegal 6502 */
+    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
+    {"SBC", IMMED, 2, 0                        }, /* E9 SBC */
+    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
+    {"???", 0    , 2, BAD                      }, /* EB     illegal 6502 */
+    {"CPX", ABSOL, 4, 0                        }, /* EC CPX */
+    {"SBC", ABSOL, 4, 0                        }, /* ED SBC */
+    {"INC", ABSOL, 6, 0                        }, /* EE INC */
+    {"???", 0    , 6, BAD                      }, /* EF     illegal 6502 */
+    {"BEQ", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* F0 BEQ */
+    {"SBC", ININD, 5, CYCLE_PAGE               }, /* F1 SBC */
+    {"???", 0    , 2, BAD                      }, /* F2     illegal 6502 */
+    {"???", 0    , 8, BAD                      }, /* F3     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* F4     illegal 6502 */
+    {"SBC", ZEPIX, 4, 0                        }, /* F5 SBC */
+    {"INC", ZEPIX, 6, 0                        }, /* F6 INC */
+    {"???", 0    , 6, BAD                      }, /* F7     illegal 6502 */
+    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
+    {"SBC", ABSIY, 4, CYCLE_PAGE               }, /* F9 SBC */
+    {"???", 0    , 2, BAD                      }, /* FA     illegal 6502 */
+    {"???", 0    , 7, BAD                      }, /* FB     illegal 6502 */
+    {"???", 0    , 4, BAD                      }, /* FC     illegal 6502 */
+    {"SBC", ABSIX, 4, CYCLE_PAGE               }, /* FD SBC */
+    {"INC", ABSIX, 7, 0                        }, /* FE INC */
+    {"???", 0    , 7, BAD                      }  /* FF     illegal 6502 */
+}; // 6502
+
+static const opcode_t g_6502u_opcodes[NUMBER_OPCODES] = {
+    {"BRK", IMPLI, 7, 0                        }, /* 00 BRK */
+    {"ORA", INDIN, 6, 0                        }, /* 01 ORA */
+    {"???", 0    , 2, BAD                      }, /* 02     illegal 6502 */
+    {"SLO", INDIN, 8, UNDOC                    }, /* 03 SLO undocumented */
+    {"NOP", ZEROP, 3, UNDOC                    }, /* 04 NOP undocumented */
+    {"ORA", ZEROP, 3, 0                        }, /* 05 ORA */
+    {"ASL", ZEROP, 5, 0                        }, /* 06 ASL */
+    {"SLO", ZEROP, 5, UNDOC                    }, /* 07 SLO undocumented */
+    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
+    {"ORA", IMMED, 2, 0                        }, /* 09 ORA */
+    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
+    {"ANC", IMMED, 2, UNDOC                    }, /* 0B ANC undocumented */
+    {"NOP", ABSOL, 4, UNDOC                    }, /* 0C NOP undocumented */
+    {"ORA", ABSOL, 4, 0                        }, /* 0D ORA */
+    {"ASL", ABSOL, 6, 0                        }, /* 0E ASL */
+    {"SLO", ABSOL, 6, UNDOC                    }, /* 0F SLO undocumented */
+    {"BPL", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 10 BPL */
+    {"ORA", ININD, 5, CYCLE_PAGE               }, /* 11 ORA */
+    {"???", 0    , 2, BAD                      }, /* 12     illegal 6502 */
+    {"SLO", ININD, 8, UNDOC                    }, /* 13 SLO undocumented */
+    {"NOP", ZEPIX, 4, UNDOC                    }, /* 14 NOP undocumented */
+    {"ORA", ZEPIX, 4, 0                        }, /* 15 ORA */
+    {"ASL", ZEPIX, 6, 0                        }, /* 16 ASL */
+    {"SLO", ZEPIX, 6, UNDOC                    }, /* 17 SLO undocumented */
+    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
+    {"ORA", ABSIY, 4, CYCLE_PAGE               }, /* 19 ORA */
+    {"NOP", IMPLI, 2, UNDOC                    }, /* 1A NOP undocumented */
+    {"SLO", ABSIY, 7, UNDOC                    }, /* 1B SLO undocumented */
+    {"NOP", ABSIX, 4, CYCLE_PAGE | UNDOC       }, /* 1C NOP undocumented */
+    {"ORA", ABSIX, 4, CYCLE_PAGE               }, /* 1D ORA */
+    {"ASL", ABSIX, 7, 0                        }, /* 1E ASL */
+    {"SLO", ABSIX, 7, UNDOC                    }, /* 1F SLO undocumented */
+    {"JSR", ABSOL, 6, 0                        }, /* 20 JSR */
+    {"AND", INDIN, 6, 0                        }, /* 21 AND */
+    {"???", 0    , 2, BAD                      }, /* 22     illegal 6502 */
+    {"RLA", INDIN, 8, UNDOC                    }, /* 23 RLA undocumented */
+    {"BIT", ZEROP, 3, 0                        }, /* 24 BIT */
+    {"AND", ZEROP, 3, 0                        }, /* 25 AND */
+    {"ROL", ZEROP, 5, 0                        }, /* 26 ROL */
+    {"RLA", ZEROP, 5, UNDOC                    }, /* 27 RLA undocumented */
+    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
+    {"AND", IMMED, 2, 0                        }, /* 29 AND */
+    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
+    {"ANC", IMMED, 2, UNDOC                    }, /* 2B ANC undocumented */
+    {"BIT", ABSOL, 4, 0                        }, /* 2C BIT */
+    {"AND", ABSOL, 4, 0                        }, /* 2D AND */
+    {"ROL", ABSOL, 6, 0                        }, /* 2E ROL */
+    {"RLA", ABSOL, 6, UNDOC                    }, /* 2F RLA undocumented */
+    {"BMI", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 30 BMI */
+    {"AND", ININD, 5, CYCLE_PAGE               }, /* 31 AND */
+    {"???", 0    , 2, BAD                      }, /* 32     illegal 6502 */
+    {"RLA", ININD, 8, UNDOC                    }, /* 33 RLA undocumented */
+    {"NOP", ZEPIX, 4, UNDOC                    }, /* 34 NOP undocumented */
+    {"AND", ZEPIX, 4, 0                        }, /* 35 AND */
+    {"ROL", ZEPIX, 6, 0                        }, /* 36 ROL */
+    {"RLA", ZEPIX, 6, UNDOC                    }, /* 37 RLA undocumented */
+    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
+    {"AND", ABSIY, 4, CYCLE_PAGE               }, /* 39 AND */
+    {"NOP", IMPLI, 2, UNDOC                    }, /* 3A NOP undocumented */
+    {"RLA", ABSIY, 7, UNDOC                    }, /* 3B RLA undocumented */
+    {"NOP", ABSIX, 4, CYCLE_PAGE | UNDOC       }, /* 3C NOP undocumented */
+    {"AND", ABSIX, 4, CYCLE_PAGE               }, /* 3D AND */
+    {"ROL", ABSIX, 7, 0                        }, /* 3E ROL */
+    {"RLA", ABSIX, 7, UNDOC                    }, /* 3F RLA undocumented */
+    {"RTI", IMPLI, 6, 0                        }, /* 40 RTI */
+    {"EOR", INDIN, 6, 0                        }, /* 41 EOR */
+    {"???", 0    , 2, BAD                      }, /* 42     illegal 6502 */
+    {"SRE", INDIN, 8, UNDOC                    }, /* 43 SRE undocumented */
+    {"NOP", ZEROP, 3, UNDOC                    }, /* 44 NOP undocumented */
+    {"EOR", ZEROP, 3, 0                        }, /* 45 EOR */
+    {"LSR", ZEROP, 5, 0                        }, /* 46 LSR */
+    {"SRE", ZEROP, 5, UNDOC                    }, /* 47 SRE undocumented */
+    {"PHA", IMPLI, 3, 0                        }, /* 48 PHA */
+    {"EOR", IMMED, 2, 0                        }, /* 49 EOR */
+    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
+    {"ALR", IMMED, 2, UNDOC                    }, /* 4B ALR undocumented */
+    {"JMP", ABSOL, 3, 0                        }, /* 4C JMP */
+    {"EOR", ABSOL, 4, 0                        }, /* 4D EOR */
+    {"LSR", ABSOL, 6, 0                        }, /* 4E LSR */
+    {"SRE", ABSOL, 6, UNDOC                    }, /* 4F SRE undocumented */
+    {"BVC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 50 BVC */
+    {"EOR", ININD, 5, CYCLE_PAGE               }, /* 51 EOR */
+    {"???", 0    , 2, BAD                      }, /* 52     illegal 6502 */
+    {"SRE", ININD, 8, UNDOC                    }, /* 53 SRE undocumented */
+    {"NOP", ZEPIX, 4, UNDOC                    }, /* 54 NOP undocumented */
+    {"EOR", ZEPIX, 4, 0                        }, /* 55 EOR */
+    {"LSR", ZEPIX, 6, 0                        }, /* 56 LSR */
+    {"SRE", ZEPIX, 6, UNDOC                    }, /* 57 SRE undocumented */
+    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
+    {"EOR", ABSIY, 4, CYCLE_PAGE               }, /* 59 EOR */
+    {"NOP", IMPLI, 2, UNDOC                    }, /* 5A NOP undocumented */
+    {"SRE", ABSIY, 7, UNDOC                    }, /* 5B SRE undocumented */
+    {"NOP", ABSIX, 4, CYCLE_PAGE | UNDOC       }, /* 5C NOP undocumented */
+    {"EOR", ABSIX, 4, CYCLE_PAGE               }, /* 5D EOR */
+    {"LSR", ABSIX, 7, 0                        }, /* 5E LSR */
+    {"SRE", ABSIX, 7, UNDOC                    }, /* 5F SRE undocumented */
+    {"RTS", IMPLI, 6, 0                        }, /* 60 RTS */
+    {"ADC", INDIN, 6, 0                        }, /* 61 ADC */
+    {"???", 0    , 2, BAD                      }, /* 62     illegal 6502 */
+    {"RRA", INDIN, 8, UNDOC                    }, /* 63 RRA undocumented */
+    {"NOP", ZEROP, 3, UNDOC                    }, /* 64 NOP undocumented */
+    {"ADC", ZEROP, 3, 0                        }, /* 65 ADC */
+    {"ROR", ZEROP, 5, 0                        }, /* 66 ROR */
+    {"RRA", ZEROP, 5, UNDOC                    }, /* 67 RRA undocumented */
+    {"PLA", IMPLI, 4, 0                        }, /* 68 PLA */
+    {"ADC", IMMED, 2, 0                        }, /* 69 ADC */
+    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
+    {"ARR", IMMED, 2, UNDOC                    }, /* 6B ARR undocumented */
+    {"JMP", INDIA, 5, 0                        }, /* 6C JMP */
+    {"ADC", ABSOL, 4, 0                        }, /* 6D ADC */
+    {"ROR", ABSOL, 6, 0                        }, /* 6E ROR */
+    {"RRA", ABSOL, 6, UNDOC                    }, /* 6F RRA undocumented */
+    {"BVS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 70 BVS */
+    {"ADC", ININD, 5, CYCLE_PAGE               }, /* 71 ADC */
+    {"???", 0    , 2, BAD                      }, /* 72     illegal 6502 */
+    {"RRA", ININD, 8, UNDOC                    }, /* 73 RRA undocumented */
+    {"NOP", ZEPIX, 4, UNDOC                    }, /* 74 NOP undocumented */
+    {"ADC", ZEPIX, 4, 0                        }, /* 75 ADC */
+    {"ROR", ZEPIX, 6, 0                        }, /* 76 ROR */
+    {"RRA", ZEPIX, 6, UNDOC                    }, /* 77 RRA undocumented */
+    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
+    {"ADC", ABSIY, 4, CYCLE_PAGE               }, /* 79 ADC */
+    {"NOP", IMPLI, 2, UNDOC                    }, /* 7A NOP undocumented */
+    {"RRA", ABSIY, 7, UNDOC                    }, /* 7B RRA undocumented */
+    {"NOP", ABSIX, 4, CYCLE_PAGE | UNDOC       }, /* 7C NOP undocumented */
+    {"ADC", ABSIX, 4, CYCLE_PAGE               }, /* 7D ADC */
+    {"ROR", ABSIX, 7, 0                        }, /* 7E ROR */
+    {"RRA", ABSIX, 7, UNDOC                    }, /* 7F RRA undocumented */
+    {"NOP", IMMED, 2, UNDOC                    }, /* 80 NOP undocumented */
+    {"STA", INDIN, 6, 0                        }, /* 81 STA */
+    {"NOP", IMMED, 2, UNDOC                    }, /* 82 NOP undocumented */
+    {"SAX", INDIN, 6, UNDOC                    }, /* 83 SAX undocumented */
+    {"STY", ZEROP, 3, 0                        }, /* 84 STY */
+    {"STA", ZEROP, 3, 0                        }, /* 85 STA */
+    {"STX", ZEROP, 3, 0                        }, /* 86 STX */
+    {"SAX", ZEROP, 3, UNDOC                    }, /* 87 SAX undocumented */
+    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
+    {"NOP", IMMED, 2, UNDOC                    }, /* 89 NOP undocumented */
+    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
+    {"???", 0    , 2, BAD                      }, /* 8B     illegal 6502 */
+    {"STY", ABSOL, 4, 0                        }, /* 8C STY */
+    {"STA", ABSOL, 4, 0                        }, /* 8D STA */
+    {"STX", ABSOL, 4, 0                        }, /* 8E STX */
+    {"SAX", ABSOL, 4, UNDOC                    }, /* 8F SAX undocumented */
+    {"BCC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 90 BCC */
+    {"STA", ININD, 6, 0                        }, /* 91 STA */
+    {"???", 0    , 2, BAD                      }, /* 92     illegal 6502 */
+    {"???", 0    , 6, BAD                      }, /* 93     illegal 6502 */
+    {"STY", ZEPIX, 4, 0                        }, /* 94 STY */
+    {"STA", ZEPIX, 4, 0                        }, /* 95 STA */
+    {"STX", ZEPIY, 4, 0                        }, /* 96 STX */
+    {"SAX", ZEPIY, 4, UNDOC                    }, /* 97 SAX undocumented */
+    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
+    {"STA", ABSIY, 5, 0                        }, /* 99 STA */
+    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
+    {"???", 0    , 5, BAD                      }, /* 9B     illegal 6502 */
+    {"???", 0    , 5, BAD                      }, /* 9C     illegal 6502 */
+    {"STA", ABSIX, 5, 0                        }, /* 9D STA */
+    {"???", 0    , 5, BAD                      }, /* 9E     illegal 6502 */
+    {"???", 0    , 5, BAD                      }, /* 9F     illegal 6502 */
+    {"LDY", IMMED, 2, 0                        }, /* A0 LDY */
+    {"LDA", INDIN, 6, 0                        }, /* A1 LDA */
+    {"LDX", IMMED, 2, 0                        }, /* A2 LDX */
+    {"LAX", INDIN, 6, UNDOC                    }, /* A3 LAX undocumented */
+    {"LDY", ZEROP, 3, 0                        }, /* A4 LDY */
+    {"LDA", ZEROP, 3, 0                        }, /* A5 LDA */
+    {"LDX", ZEROP, 3, 0                        }, /* A6 LDX */
+    {"LAX", ZEROP, 3, UNDOC                    }, /* A7 LAX undocumented */
+    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
+    {"LDA", IMMED, 2, 0                        }, /* A9 LDA */
+    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
+    {"???", 0    , 2, BAD                      }, /* AB     illegal 6502 */
+    {"LDY", ABSOL, 4, 0                        }, /* AC LDY */
+    {"LDA", ABSOL, 4, 0                        }, /* AD LDA */
+    {"LDX", ABSOL, 4, 0                        }, /* AE LDX */
+    {"LAX", ABSOL, 4, UNDOC                    }, /* AF LAX undocumented */
+    {"BCS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* B0 BCS */
+    {"LDA", ININD, 5, CYCLE_PAGE               }, /* B1 LDA */
+    {"???", 0    , 2, BAD                      }, /* B2     illegal 6502 */
+    {"LAX", ININD, 5, CYCLE_PAGE | UNDOC       }, /* B3 LAX undocumented */
+    {"LDY", ZEPIX, 4, 0                        }, /* B4 LDY */
+    {"LDA", ZEPIX, 4, 0                        }, /* B5 LDA */
+    {"LDX", ZEPIY, 4, 0                        }, /* B6 LDX */
+    {"LAX", ZEPIY, 4, UNDOC                    }, /* B7 LAX undocumented */
+    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
+    {"LDA", ABSIY, 4, CYCLE_PAGE               }, /* B9 LDA */
+    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
+    {"???", 0    , 4, BAD                      }, /* BB     illegal 6502 */
+    {"LDY", ABSIX, 4, CYCLE_PAGE               }, /* BC LDY */
+    {"LDA", ABSIX, 4, CYCLE_PAGE               }, /* BD LDA */
+    {"LDX", ABSIY, 4, CYCLE_PAGE               }, /* BE LDX */
+    {"LAX", ABSIY, 4, CYCLE_PAGE | UNDOC       }, /* BF LAX undocumented */
+    {"CPY", IMMED, 2, 0                        }, /* C0 CPY */
+    {"CMP", INDIN, 6, 0                        }, /* C1 CMP */
+    {"NOP", IMMED, 2, UNDOC                    }, /* C2 NOP undocumented */
+    {"DCP", INDIN, 8, UNDOC                    }, /* C3 DCP undocumented */
+    {"CPY", ZEROP, 3, 0                        }, /* C4 CPY */
+    {"CMP", ZEROP, 3, 0                        }, /* C5 CMP */
+    {"DEC", ZEROP, 5, 0                        }, /* C6 DEC */
+    {"DCP", ZEROP, 5, UNDOC                    }, /* C7 DCP undocumented */
+    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
+    {"CMP", IMMED, 2, 0                        }, /* C9 CMP */
+    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
+    {"SBX", IMMED, 2, UNDOC                    }, /* CB SBX undocumented */
+    {"CPY", ABSOL, 4, 0                        }, /* CC CPY */
+    {"CMP", ABSOL, 4, 0                        }, /* CD CMP */
+    {"DEC", ABSOL, 6, 0                        }, /* CE DEC */
+    {"DCP", ABSOL, 6, UNDOC                    }, /* CF DCP undocumented */
+    {"BNE", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* D0 BNE */
+    {"CMP", ININD, 5, CYCLE_PAGE               }, /* D1 CMP */
+    {"???", 0    , 2, BAD                      }, /* D2     illegal 6502 */
+    {"DCP", ININD, 8, UNDOC                    }, /* D3 DCP undocumented */
+    {"NOP", ZEPIX, 4, UNDOC                    }, /* D4 NOP undocumented */
+    {"CMP", ZEPIX, 4, 0                        }, /* D5 CMP */
+    {"DEC", ZEPIX, 6, 0                        }, /* D6 DEC */
+    {"DCP", ZEPIX, 6, UNDOC                    }, /* D7 DCP undocumented */
+    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
+    {"CMP", ABSIY, 4, CYCLE_PAGE               }, /* D9 CMP */
+    {"NOP", IMPLI, 2, UNDOC                    }, /* DA NOP undocumented */
+    {"DCP", ABSIY, 7, UNDOC                    }, /* DB DCP undocumented */
+    {"NOP", ABSIX, 4, CYCLE_PAGE | UNDOC       }, /* DC NOP undocumented */
+    {"CMP", ABSIX, 4, CYCLE_PAGE               }, /* DD CMP */
+    {"DEC", ABSIX, 7, 0                        }, /* DE DEC */
+    {"DCP", ABSIX, 7, UNDOC                    }, /* DF DCP undocumented */
+    {"CPX", IMMED, 2, 0                        }, /* E0 CPX */
+    {"SBC", INDIN, 6, 0                        }, /* E1 SBC */
+    {"NOP", IMMED, 2, UNDOC                    }, /* E2 NOP undocumented */
+    {"ISC", INDIN, 8, UNDOC                    }, /* E3 ISC undocumented */
+    {"CPX", ZEROP, 3, 0                        }, /* E4 CPX */
+    {"SBC", ZEROP, 3, 0                        }, /* E5 SBC */
+    {"INC", ZEROP, 5, 0                        }, /* E6 INC */
+    {"ISC", ZEROP, 5, UNDOC                    }, /* E7 ISC undocumented */
+    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
+    {"SBC", IMMED, 2, 0                        }, /* E9 SBC */
+    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
+    {"SBC", IMMED, 2, UNDOC                    }, /* EB SBC undocumented */
+    {"CPX", ABSOL, 4, 0                        }, /* EC CPX */
+    {"SBC", ABSOL, 4, 0                        }, /* ED SBC */
+    {"INC", ABSOL, 6, 0                        }, /* EE INC */
+    {"ISC", ABSOL, 6, UNDOC                    }, /* EF ISC undocumented */
+    {"BEQ", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* F0 BEQ */
+    {"SBC", ININD, 5, CYCLE_PAGE               }, /* F1 SBC */
+    {"???", 0    , 2, BAD                      }, /* F2     illegal 6502 */
+    {"ISC", ININD, 8, UNDOC                    }, /* F3 ISC undocumented */
+    {"NOP", ZEPIX, 4, UNDOC                    }, /* F4 NOP undocumented */
+    {"SBC", ZEPIX, 4, 0                        }, /* F5 SBC */
+    {"INC", ZEPIX, 6, 0                        }, /* F6 INC */
+    {"ISC", ZEPIX, 6, UNDOC                    }, /* F7 ISC undocumented */
+    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
+    {"SBC", ABSIY, 4, CYCLE_PAGE               }, /* F9 SBC */
+    {"NOP", IMPLI, 2, UNDOC                    }, /* FA NOP undocumented */
+    {"ISC", ABSIY, 7, UNDOC                    }, /* FB ISC undocumented */
+    {"NOP", ABSIX, 4, CYCLE_PAGE | UNDOC       }, /* FC NOP undocumented */
+    {"SBC", ABSIX, 4, CYCLE_PAGE               }, /* FD SBC */
+    {"INC", ABSIX, 7, 0                        }, /* FE INC */
+    {"ISC", ABSIX, 7, UNDOC                    }  /* FF ISC undocumented */
+}; // 6502 with the stable undocumented opcodes
+
+static const opcode_t g_65C02_opcodes[NUMBER_OPCODES] = {
+    {"BRK", IMPLI, 7, 0                        }, /* 00 BRK */
+    {"ORA", INDIN, 6, 0                        }, /* 01 ORA */
+    {"NOP", IMMED, 2, 0                        }, /* 02 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* 03     illegal 6502 */
+    {"TSB", ZEROP, 5, _65C02                   }, /* 04 TSB */
+    {"ORA", ZEROP, 3, 0                        }, /* 05 ORA */
+    {"ASL", ZEROP, 5, 0                        }, /* 06 ASL */
+    {"RMB0", ZEROP, 5, _65C02                  }, /* 07 RMB0 */
+    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
+    {"ORA", IMMED, 2, 0                        }, /* 09 ORA */
+    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
+    {"???", 0    , 1, BAD                      }, /* 0B     illegal 6502 */
+    {"TSB", ABSOL, 6, _65C02                   }, /* 0C TSB */
+    {"ORA", ABSOL, 4, 0                        }, /* 0D ORA */
+    {"ASL", ABSOL, 6, 0                        }, /* 0E ASL */
+    {"BBR0", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 0F BBR0 */
+    {"BPL", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 10 BPL */
+    {"ORA", ININD, 5, CYCLE_PAGE               }, /* 11 ORA */
+    {"ORA", ZEPIN, 5, _65C02                   }, /* 12 ORA */
+    {"???", 0    , 1, BAD                      }, /* 13     illegal 6502 */
+    {"TRB", ZEROP, 5, _65C02                   }, /* 14 TRB */
+    {"ORA", ZEPIX, 4, 0                        }, /* 15 ORA */
+    {"ASL", ZEPIX, 6, 0                        }, /* 16 ASL */
+    {"RMB1", ZEROP, 5, _65C02                  }, /* 17 RMB1 */
+    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
+    {"ORA", ABSIY, 4, CYCLE_PAGE               }, /* 19 ORA */
+    {"INC", ACCUM, 2, _65C02                   }, /* 1A INC */
+    {"???", 0    , 1, BAD                      }, /* 1B     illegal 6502 */
+    {"TRB", ABSOL, 6, _65C02                   }, /* 1C TRB */
+    {"ORA", ABSIX, 4, CYCLE_PAGE               }, /* 1D ORA */
+    {"ASL", ABSIX, 6, CYCLE_PAGE               }, /* 1E ASL */
+    {"BBR1", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 1F BBR1 */
+    {"JSR", ABSOL, 6, 0                        }, /* 20 JSR */
+    {"AND", INDIN, 6, 0                        }, /* 21 AND */
+    {"NOP", IMMED, 2, 0                        }, /* 22 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* 23     illegal 6502 */
+    {"BIT", ZEROP, 3, 0                        }, /* 24 BIT */
+    {"AND", ZEROP, 3, 0                        }, /* 25 AND */
+    {"ROL", ZEROP, 5, 0                        }, /* 26 ROL */
+    {"RMB2", ZEROP, 5, _65C02                  }, /* 27 RMB2 */
+    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
+    {"AND", IMMED, 2, 0                        }, /* 29 AND */
+    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
+    {"???", 0    , 1, BAD                      }, /* 2B     illegal 6502 */
+    {"BIT", ABSOL, 4, 0                        }, /* 2C BIT */
+    {"AND", ABSOL, 4, 0                        }, /* 2D AND */
+    {"ROL", ABSOL, 6, 0                        }, /* 2E ROL */
+    {"BBR2", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 2F BBR2 */
+    {"BMI", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 30 BMI */
+    {"AND", ININD, 5, CYCLE_PAGE               }, /* 31 AND */
+    {"AND", ZEPIN, 5, _65C02                   }, /* 32 AND */
+    {"???", 0    , 1, BAD                      }, /* 33     illegal 6502 */
+    {"BIT", ZEPIX, 4, _65C02                   }, /* 34 BIT */
+    {"AND", ZEPIX, 4, 0                        }, /* 35 AND */
+    {"ROL", ZEPIX, 6, 0                        }, /* 36 ROL */
+    {"RMB3", ZEROP, 5, _65C02                  }, /* 37 RMB3 */
+    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
+    {"AND", ABSIY, 4, CYCLE_PAGE               }, /* 39 AND */
+    {"DEC", ACCUM, 2, _65C02                   }, /* 3A DEC */
+    {"???", 0    , 1, BAD                      }, /* 3B     illegal 6502 */
+    {"BIT", ABSIX, 4, CYCLE_PAGE | _65C02      }, /* 3C BIT */
+    {"AND", ABSIX, 4, CYCLE_PAGE               }, /* 3D AND */
+    {"ROL", ABSIX, 6, CYCLE_PAGE               }, /* 3E ROL */
+    {"BBR3", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 3F BBR3 */
+    {"RTI", IMPLI, 6, 0                        }, /* 40 RTI */
+    {"EOR", INDIN, 6, 0                        }, /* 41 EOR */
+    {"NOP", IMMED, 2, 0                        }, /* 42 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* 43     illegal 6502 */
+    {"NOP", ZEROP, 3, 0                        }, /* 44 NOP reserved */
+    {"EOR", ZEROP, 3, 0                        }, /* 45 EOR */
+    {"LSR", ZEROP, 5, 0                        }, /* 46 LSR */
+    {"RMB4", ZEROP, 5, _65C02                  }, /* 47 RMB4 */
+    {"PHA", IMPLI, 3, 0                        }, /* 48 PHA */
+    {"EOR", IMMED, 2, 0                        }, /* 49 EOR */
+    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
+    {"???", 0    , 1, BAD                      }, /* 4B     illegal 6502 */
+    {"JMP", ABSOL, 3, 0                        }, /* 4C JMP */
+    {"EOR", ABSOL, 4, 0                        }, /* 4D EOR */
+    {"LSR", ABSOL, 6, 0                        }, /* 4E LSR */
+    {"BBR4", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 4F BBR4 */
+    {"BVC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 50 BVC */
+    {"EOR", ININD, 5, CYCLE_PAGE               }, /* 51 EOR */
+    {"EOR", ZEPIN, 5, _65C02                   }, /* 52 EOR */
+    {"???", 0    , 1, BAD                      }, /* 53     illegal 6502 */
+    {"NOP", ZEPIX, 4, 0                        }, /* 54 NOP reserved */
+    {"EOR", ZEPIX, 4, 0                        }, /* 55 EOR */
+    {"LSR", ZEPIX, 6, 0                        }, /* 56 LSR */
+    {"RMB5", ZEROP, 5, _65C02                  }, /* 57 RMB5 */
+    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
+    {"EOR", ABSIY, 4, CYCLE_PAGE               }, /* 59 EOR */
+    {"PHY", IMPLI, 3, _65C02                   }, /* 5A PHY */
+    {"???", 0    , 1, BAD                      }, /* 5B     illegal 6502 */
+    {"NOP", ABSOL, 8, 0                        }, /* 5C NOP reserved */
+    {"EOR", ABSIX, 4, CYCLE_PAGE               }, /* 5D EOR */
+    {"LSR", ABSIX, 6, CYCLE_PAGE               }, /* 5E LSR */
+    {"BBR5", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 5F BBR5 */
+    {"RTS", IMPLI, 6, 0                        }, /* 60 RTS */
+    {"ADC", INDIN, 6, 0                        }, /* 61 ADC */
+    {"NOP", IMMED, 2, 0                        }, /* 62 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* 63     illegal 6502 */
+    {"STZ", ZEROP, 3, _65C02                   }, /* 64 STZ */
+    {"ADC", ZEROP, 3, 0                        }, /* 65 ADC */
+    {"ROR", ZEROP, 5, 0                        }, /* 66 ROR */
+    {"RMB6", ZEROP, 5, _65C02                  }, /* 67 RMB6 */
+    {"PLA", IMPLI, 4, 0                        }, /* 68 PLA */
+    {"ADC", IMMED, 2, 0                        }, /* 69 ADC */
+    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
+    {"???", 0    , 1, BAD                      }, /* 6B     illegal 6502 */
+    {"JMP", INDIA, 6, 0                        }, /* 6C JMP */
+    {"ADC", ABSOL, 4, 0                        }, /* 6D ADC */
+    {"ROR", ABSOL, 6, 0                        }, /* 6E ROR */
+    {"BBR6", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 6F BBR6 */
+    {"BVS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 70 BVS */
+    {"ADC", ININD, 5, CYCLE_PAGE               }, /* 71 ADC */
+    {"ADC", ZEPIN, 5, _65C02                   }, /* 72 ADC */
+    {"???", 0    , 1, BAD                      }, /* 73     illegal 6502 */
+    {"STZ", ZEPIX, 4, _65C02                   }, /* 74 STZ */
+    {"ADC", ZEPIX, 4, 0                        }, /* 75 ADC */
+    {"ROR", ZEPIX, 6, 0                        }, /* 76 ROR */
+    {"RMB7", ZEROP, 5, _65C02                  }, /* 77 RMB7 */
+    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
+    {"ADC", ABSIY, 4, CYCLE_PAGE               }, /* 79 ADC */
+    {"PLY", IMPLI, 4, _65C02                   }, /* 7A PLY */
+    {"???", 0    , 1, BAD                      }, /* 7B     illegal 6502 */
+    {"JMP", INDAX, 6, _65C02                   }, /* 7C JMP */
+    {"ADC", ABSIX, 4, CYCLE_PAGE               }, /* 7D ADC */
+    {"ROR", ABSIX, 6, CYCLE_PAGE               }, /* 7E ROR */
+    {"BBR7", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 7F BBR7 */
+    {"BRA", RELAT, 3, CYCLE_PAGE | _65C02      }, /* 80 BRA */
+    {"STA", INDIN, 6, 0                        }, /* 81 STA */
+    {"NOP", IMMED, 2, 0                        }, /* 82 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* 83     illegal 6502 */
+    {"STY", ZEROP, 3, 0                        }, /* 84 STY */
+    {"STA", ZEROP, 3, 0                        }, /* 85 STA */
+    {"STX", ZEROP, 3, 0                        }, /* 86 STX */
+    {"SMB0", ZEROP, 5, _65C02                  }, /* 87 SMB0 */
+    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
+    {"BIT", IMMED, 2, _65C02                   }, /* 89 BIT */
+    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
+    {"???", 0    , 1, BAD                      }, /* 8B     illegal 6502 */
+    {"STY", ABSOL, 4, 0                        }, /* 8C STY */
+    {"STA", ABSOL, 4, 0                        }, /* 8D STA */
+    {"STX", ABSOL, 4, 0                        }, /* 8E STX */
+    {"BBS0", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 8F BBS0 */
+    {"BCC", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* 90 BCC */
+    {"STA", ININD, 6, 0                        }, /* 91 STA */
+    {"STA", ZEPIN, 5, _65C02                   }, /* 92 STA */
+    {"???", 0    , 1, BAD                      }, /* 93     illegal 6502 */
+    {"STY", ZEPIX, 4, 0                        }, /* 94 STY */
+    {"STA", ZEPIX, 4, 0                        }, /* 95 STA */
+    {"STX", ZEPIY, 4, 0                        }, /* 96 STX */
+    {"SMB1", ZEROP, 5, _65C02                  }, /* 97 SMB1 */
+    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
+    {"STA", ABSIY, 5, 0                        }, /* 99 STA */
+    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
+    {"???", 0    , 1, BAD                      }, /* 9B     illegal 6502 */
+    {"STZ", ABSOL, 4, _65C02                   }, /* 9C STZ */
+    {"STA", ABSIX, 5, 0                        }, /* 9D STA */
+    {"STZ", ABSIX, 5, _65C02                   }, /* 9E STZ */
+    {"BBS1", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* 9F BBS1 */
+    {"LDY", IMMED, 2, 0                        }, /* A0 LDY */
+    {"LDA", INDIN, 6, 0                        }, /* A1 LDA */
+    {"LDX", IMMED, 2, 0                        }, /* A2 LDX */
+    {"???", 0    , 1, BAD                      }, /* A3     illegal 6502 */
+    {"LDY", ZEROP, 3, 0                        }, /* A4 LDY */
+    {"LDA", ZEROP, 3, 0                        }, /* A5 LDA */
+    {"LDX", ZEROP, 3, 0                        }, /* A6 LDX */
+    {"SMB2", ZEROP, 5, _65C02                  }, /* A7 SMB2 */
+    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
+    {"LDA", IMMED, 2, 0                        }, /* A9 LDA */
+    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
+    {"???", 0    , 1, BAD                      }, /* AB     illegal 6502 */
+    {"LDY", ABSOL, 4, 0                        }, /* AC LDY */
+    {"LDA", ABSOL, 4, 0                        }, /* AD LDA */
+    {"LDX", ABSOL, 4, 0                        }, /* AE LDX */
+    {"BBS2", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* AF BBS2 */
+    {"BCS", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* B0 BCS */
+    {"LDA", ININD, 5, CYCLE_PAGE               }, /* B1 LDA */
+    {"LDA", ZEPIN, 5, _65C02                   }, /* B2 LDA */
+    {"???", 0    , 1, BAD                      }, /* B3     illegal 6502 */
+    {"LDY", ZEPIX, 4, 0                        }, /* B4 LDY */
+    {"LDA", ZEPIX, 4, 0                        }, /* B5 LDA */
+    {"LDX", ZEPIY, 4, 0                        }, /* B6 LDX */
+    {"SMB3", ZEROP, 5, _65C02                  }, /* B7 SMB3 */
+    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
+    {"LDA", ABSIY, 4, CYCLE_PAGE               }, /* B9 LDA */
+    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
+    {"???", 0    , 1, BAD                      }, /* BB     illegal 6502 */
+    {"LDY", ABSIX, 4, CYCLE_PAGE               }, /* BC LDY */
+    {"LDA", ABSIX, 4, CYCLE_PAGE               }, /* BD LDA */
+    {"LDX", ABSIY, 4, CYCLE_PAGE               }, /* BE LDX */
+    {"BBS3", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* BF BBS3 */
+    {"CPY", IMMED, 2, 0                        }, /* C0 CPY */
+    {"CMP", INDIN, 6, 0                        }, /* C1 CMP */
+    {"NOP", IMMED, 2, 0                        }, /* C2 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* C3     illegal 6502 */
+    {"CPY", ZEROP, 3, 0                        }, /* C4 CPY */
+    {"CMP", ZEROP, 3, 0                        }, /* C5 CMP */
+    {"DEC", ZEROP, 5, 0                        }, /* C6 DEC */
+    {"SMB4", ZEROP, 5, _65C02                  }, /* C7 SMB4 */
+    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
+    {"CMP", IMMED, 2, 0                        }, /* C9 CMP */
+    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
+    {"WAI", IMPLI, 3, _65C02                   }, /* CB WAI */
+    {"CPY", ABSOL, 4, 0                        }, /* CC CPY */
+    {"CMP", ABSOL, 4, 0                        }, /* CD CMP */
+    {"DEC", ABSOL, 6, 0                        }, /* CE DEC */
+    {"BBS4", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* CF BBS4 */
+    {"BNE", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* D0 BNE */
+    {"CMP", ININD, 5, CYCLE_PAGE               }, /* D1 CMP */
+    {"CMP", ZEPIN, 5, _65C02                   }, /* D2 CMP */
+    {"???", 0    , 1, BAD                      }, /* D3     illegal 6502 */
+    {"NOP", ZEPIX, 4, 0                        }, /* D4 NOP reserved */
+    {"CMP", ZEPIX, 4, 0                        }, /* D5 CMP */
+    {"DEC", ZEPIX, 6, 0                        }, /* D6 DEC */
+    {"SMB5", ZEROP, 5, _65C02                  }, /* D7 SMB5 */
+    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
+    {"CMP", ABSIY, 4, CYCLE_PAGE               }, /* D9 CMP */
+    {"PHX", IMPLI, 3, _65C02                   }, /* DA PHX */
+    {"STP", IMPLI, 3, _65C02                   }, /* DB STP */
+    {"NOP", ABSOL, 4, 0                        }, /* DC NOP reserved */
+    {"CMP", ABSIX, 4, CYCLE_PAGE               }, /* DD CMP */
+    {"DEC", ABSIX, 7, 0                        }, /* DE DEC */
+    {"BBS5", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* DF BBS5 */
+    {"CPX", IMMED, 2, 0                        }, /* E0 CPX */
+    {"SBC", INDIN, 6, 0                        }, /* E1 SBC */
+    {"NOP", IMMED, 2, 0                        }, /* E2 NOP reserved */
+    {"???", 0    , 1, BAD                      }, /* E3     illegal 6502 */
+    {"CPX", ZEROP, 3, 0                        }, /* E4 CPX */
+    {"SBC", ZEROP, 3, 0                        }, /* E5 SBC */
+    {"INC", ZEROP, 5, 0                        }, /* E6 INC */
+    {"SMB6", ZEROP, 5, _65C02                  }, /* E7 SMB6 */
+    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
+    {"SBC", IMMED, 2, 0                        }, /* E9 SBC */
+    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
+    {"???", 0    , 1, BAD                      }, /* EB     illegal 6502 */
+    {"CPX", ABSOL, 4, 0                        }, /* EC CPX */
+    {"SBC", ABSOL, 4, 0                        }, /* ED SBC */
+    {"INC", ABSOL, 6, 0                        }, /* EE INC */
+    {"BBS6", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* EF BBS6 */
+    {"BEQ", RELAT, 2, CYCLE_PAGE | CYCLE_BRANCH}, /* F0 BEQ */
+    {"SBC", ININD, 5, CYCLE_PAGE               }, /* F1 SBC */
+    {"SBC", ZEPIN, 5, _65C02                   }, /* F2 SBC */
+    {"???", 0    , 1, BAD                      }, /* F3     illegal 6502 */
+    {"NOP", ZEPIX, 4, 0                        }, /* F4 NOP reserved */
+    {"SBC", ZEPIX, 4, 0                        }, /* F5 SBC */
+    {"INC", ZEPIX, 6, 0                        }, /* F6 INC */
+    {"SMB7", ZEROP, 5, _65C02                  }, /* F7 SMB7 */
+    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
+    {"SBC", ABSIY, 4, CYCLE_PAGE               }, /* F9 SBC */
+    {"PLX", IMPLI, 4, _65C02                   }, /* FA PLX */
+    {"???", 0    , 1, BAD                      }, /* FB     illegal 6502 */
+    {"NOP", ABSOL, 4, 0                        }, /* FC NOP reserved */
+    {"SBC", ABSIX, 4, CYCLE_PAGE               }, /* FD SBC */
+    {"INC", ABSIX, 7, 0                        }, /* FE INC */
+    {"BBS7", ZEREL, 5, CYCLE_PAGE | CYCLE_BRANCH | _65C02}, /* FF BBS7 */
+}; // 65C02
+
+/* Cycles of native mode with 8-bit registers and a page aligned direct page */
+static const opcode_t g_65816_opcodes[NUMBER_OPCODES] = {
+    {"BRK", IMMED, 8, 0                        }, /* 00 BRK */
+    {"ORA", INDIN, 6, CYCLE_M                  }, /* 01 ORA */
+    {"COP", IMMED, 8, 0                        }, /* 02 COP */
+    {"ORA", STREL, 4, CYCLE_M                  }, /* 03 ORA */
+    {"TSB", ZEROP, 5, CYCLE_RMW                }, /* 04 TSB */
+    {"ORA", ZEROP, 3, CYCLE_M                  }, /* 05 ORA */
+    {"ASL", ZEROP, 5, CYCLE_RMW                }, /* 06 ASL */
+    {"ORA", INDLO, 6, CYCLE_M                  }, /* 07 ORA */
+    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
+    {"ORA", IMMED, 2, CYCLE_M                  }, /* 09 ORA */
+    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
+    {"PHD", IMPLI, 4, 0                        }, /* 0B PHD */
+    {"TSB", ABSOL, 6, CYCLE_RMW                }, /* 0C TSB */
+    {"ORA", ABSOL, 4, CYCLE_M                  }, /* 0D ORA */
+    {"ASL", ABSOL, 6, CYCLE_RMW                }, /* 0E ASL */
+    {"ORA", ABSLO, 5, CYCLE_M                  }, /* 0F ORA */
+    {"BPL", RELAT, 2, CYCLE_BRANCH             }, /* 10 BPL */
+    {"ORA", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* 11 ORA */
+    {"ORA", ZEPIN, 5, CYCLE_M                  }, /* 12 ORA */
+    {"ORA", SRIIY, 7, CYCLE_M                  }, /* 13 ORA */
+    {"TRB", ZEROP, 5, CYCLE_RMW                }, /* 14 TRB */
+    {"ORA", ZEPIX, 4, CYCLE_M                  }, /* 15 ORA */
+    {"ASL", ZEPIX, 6, CYCLE_RMW                }, /* 16 ASL */
+    {"ORA", INLIY, 6, CYCLE_M                  }, /* 17 ORA */
+    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
+    {"ORA", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* 19 ORA */
+    {"INC", ACCUM, 2, 0                        }, /* 1A INC */
+    {"TCS", IMPLI, 2, 0                        }, /* 1B TCS */
+    {"TRB", ABSOL, 6, CYCLE_RMW                }, /* 1C TRB */
+    {"ORA", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* 1D ORA */
+    {"ASL", ABSIX, 7, CYCLE_RMW                }, /* 1E ASL */
+    {"ORA", ABLIX, 5, CYCLE_M                  }, /* 1F ORA */
+    {"JSR", ABSOL, 6, 0                        }, /* 20 JSR */
+    {"AND", INDIN, 6, CYCLE_M                  }, /* 21 AND */
+    {"JSL", ABSLO, 8, 0                        }, /* 22 JSL */
+    {"AND", STREL, 4, CYCLE_M                  }, /* 23 AND */
+    {"BIT", ZEROP, 3, CYCLE_M                  }, /* 24 BIT */
+    {"AND", ZEROP, 3, CYCLE_M                  }, /* 25 AND */
+    {"ROL", ZEROP, 5, CYCLE_RMW                }, /* 26 ROL */
+    {"AND", INDLO, 6, CYCLE_M                  }, /* 27 AND */
+    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
+    {"AND", IMMED, 2, CYCLE_M                  }, /* 29 AND */
+    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
+    {"PLD", IMPLI, 5, 0                        }, /* 2B PLD */
+    {"BIT", ABSOL, 4, CYCLE_M                  }, /* 2C BIT */
+    {"AND", ABSOL, 4, CYCLE_M                  }, /* 2D AND */
+    {"ROL", ABSOL, 6, CYCLE_RMW                }, /* 2E ROL */
+    {"AND", ABSLO, 5, CYCLE_M                  }, /* 2F AND */
+    {"BMI", RELAT, 2, CYCLE_BRANCH             }, /* 30 BMI */
+    {"AND", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* 31 AND */
+    {"AND", ZEPIN, 5, CYCLE_M                  }, /* 32 AND */
+    {"AND", SRIIY, 7, CYCLE_M                  }, /* 33 AND */
+    {"BIT", ZEPIX, 4, CYCLE_M                  }, /* 34 BIT */
+    {"AND", ZEPIX, 4, CYCLE_M                  }, /* 35 AND */
+    {"ROL", ZEPIX, 6, CYCLE_RMW                }, /* 36 ROL */
+    {"AND", INLIY, 6, CYCLE_M                  }, /* 37 AND */
+    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
+    {"AND", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* 39 AND */
+    {"DEC", ACCUM, 2, 0                        }, /* 3A DEC */
+    {"TSC", IMPLI, 2, 0                        }, /* 3B TSC */
+    {"BIT", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* 3C BIT */
+    {"AND", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* 3D AND */
+    {"ROL", ABSIX, 7, CYCLE_RMW                }, /* 3E ROL */
+    {"AND", ABLIX, 5, CYCLE_M                  }, /* 3F AND */
+    {"RTI", IMPLI, 7, 0                        }, /* 40 RTI */
+    {"EOR", INDIN, 6, CYCLE_M                  }, /* 41 EOR */
+    {"WDM", IMMED, 2, 0                        }, /* 42 WDM */
+    {"EOR", STREL, 4, CYCLE_M                  }, /* 43 EOR */
+    {"MVP", BLKMV, 7, 0                        }, /* 44 MVP */
+    {"EOR", ZEROP, 3, CYCLE_M                  }, /* 45 EOR */
+    {"LSR", ZEROP, 5, CYCLE_RMW                }, /* 46 LSR */
+    {"EOR", INDLO, 6, CYCLE_M                  }, /* 47 EOR */
+    {"PHA", IMPLI, 3, CYCLE_M                  }, /* 48 PHA */
+    {"EOR", IMMED, 2, CYCLE_M                  }, /* 49 EOR */
+    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
+    {"PHK", IMPLI, 3, 0                        }, /* 4B PHK */
+    {"JMP", ABSOL, 3, 0                        }, /* 4C JMP */
+    {"EOR", ABSOL, 4, CYCLE_M                  }, /* 4D EOR */
+    {"LSR", ABSOL, 6, CYCLE_RMW                }, /* 4E LSR */
+    {"EOR", ABSLO, 5, CYCLE_M                  }, /* 4F EOR */
+    {"BVC", RELAT, 2, CYCLE_BRANCH             }, /* 50 BVC */
+    {"EOR", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* 51 EOR */
+    {"EOR", ZEPIN, 5, CYCLE_M                  }, /* 52 EOR */
+    {"EOR", SRIIY, 7, CYCLE_M                  }, /* 53 EOR */
+    {"MVN", BLKMV, 7, 0                        }, /* 54 MVN */
+    {"EOR", ZEPIX, 4, CYCLE_M                  }, /* 55 EOR */
+    {"LSR", ZEPIX, 6, CYCLE_RMW                }, /* 56 LSR */
+    {"EOR", INLIY, 6, CYCLE_M                  }, /* 57 EOR */
+    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
+    {"EOR", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* 59 EOR */
+    {"PHY", IMPLI, 3, CYCLE_X                  }, /* 5A PHY */
+    {"TCD", IMPLI, 2, 0                        }, /* 5B TCD */
+    {"JML", ABSLO, 4, 0                        }, /* 5C JML */
+    {"EOR", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* 5D EOR */
+    {"LSR", ABSIX, 7, CYCLE_RMW                }, /* 5E LSR */
+    {"EOR", ABLIX, 5, CYCLE_M                  }, /* 5F EOR */
+    {"RTS", IMPLI, 6, 0                        }, /* 60 RTS */
+    {"ADC", INDIN, 6, CYCLE_M                  }, /* 61 ADC */
+    {"PER", RELLO, 6, 0                        }, /* 62 PER */
+    {"ADC", STREL, 4, CYCLE_M                  }, /* 63 ADC */
+    {"STZ", ZEROP, 3, CYCLE_M                  }, /* 64 STZ */
+    {"ADC", ZEROP, 3, CYCLE_M                  }, /* 65 ADC */
+    {"ROR", ZEROP, 5, CYCLE_RMW                }, /* 66 ROR */
+    {"ADC", INDLO, 6, CYCLE_M                  }, /* 67 ADC */
+    {"PLA", IMPLI, 4, CYCLE_M                  }, /* 68 PLA */
+    {"ADC", IMMED, 2, CYCLE_M                  }, /* 69 ADC */
+    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
+    {"RTL", IMPLI, 6, 0                        }, /* 6B RTL */
+    {"JMP", INDIA, 5, 0                        }, /* 6C JMP */
+    {"ADC", ABSOL, 4, CYCLE_M                  }, /* 6D ADC */
+    {"ROR", ABSOL, 6, CYCLE_RMW                }, /* 6E ROR */
+    {"ADC", ABSLO, 5, CYCLE_M                  }, /* 6F ADC */
+    {"BVS", RELAT, 2, CYCLE_BRANCH             }, /* 70 BVS */
+    {"ADC", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* 71 ADC */
+    {"ADC", ZEPIN, 5, CYCLE_M                  }, /* 72 ADC */
+    {"ADC", SRIIY, 7, CYCLE_M                  }, /* 73 ADC */
+    {"STZ", ZEPIX, 4, CYCLE_M                  }, /* 74 STZ */
+    {"ADC", ZEPIX, 4, CYCLE_M                  }, /* 75 ADC */
+    {"ROR", ZEPIX, 6, CYCLE_RMW                }, /* 76 ROR */
+    {"ADC", INLIY, 6, CYCLE_M                  }, /* 77 ADC */
+    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
+    {"ADC", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* 79 ADC */
+    {"PLY", IMPLI, 4, CYCLE_X                  }, /* 7A PLY */
+    {"TDC", IMPLI, 2, 0                        }, /* 7B TDC */
+    {"JMP", INDAX, 6, 0                        }, /* 7C JMP */
+    {"ADC", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* 7D ADC */
+    {"ROR", ABSIX, 7, CYCLE_RMW                }, /* 7E ROR */
+    {"ADC", ABLIX, 5, CYCLE_M                  }, /* 7F ADC */
+    {"BRA", RELAT, 3, 0                        }, /* 80 BRA */
+    {"STA", INDIN, 6, CYCLE_M                  }, /* 81 STA */
+    {"BRL", RELLO, 4, 0                        }, /* 82 BRL */
+    {"STA", STREL, 4, CYCLE_M                  }, /* 83 STA */
+    {"STY", ZEROP, 3, CYCLE_X                  }, /* 84 STY */
+    {"STA", ZEROP, 3, CYCLE_M                  }, /* 85 STA */
+    {"STX", ZEROP, 3, CYCLE_X                  }, /* 86 STX */
+    {"STA", INDLO, 6, CYCLE_M                  }, /* 87 STA */
+    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
+    {"BIT", IMMED, 2, CYCLE_M                  }, /* 89 BIT */
+    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
+    {"PHB", IMPLI, 3, 0                        }, /* 8B PHB */
+    {"STY", ABSOL, 4, CYCLE_X                  }, /* 8C STY */
+    {"STA", ABSOL, 4, CYCLE_M                  }, /* 8D STA */
+    {"STX", ABSOL, 4, CYCLE_X                  }, /* 8E STX */
+    {"STA", ABSLO, 5, CYCLE_M                  }, /* 8F STA */
+    {"BCC", RELAT, 2, CYCLE_BRANCH             }, /* 90 BCC */
+    {"STA", ININD, 6, CYCLE_M                  }, /* 91 STA */
+    {"STA", ZEPIN, 5, CYCLE_M                  }, /* 92 STA */
+    {"STA", SRIIY, 7, CYCLE_M                  }, /* 93 STA */
+    {"STY", ZEPIX, 4, CYCLE_X                  }, /* 94 STY */
+    {"STA", ZEPIX, 4, CYCLE_M                  }, /* 95 STA */
+    {"STX", ZEPIY, 4, CYCLE_X                  }, /* 96 STX */
+    {"STA", INLIY, 6, CYCLE_M                  }, /* 97 STA */
+    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
+    {"STA", ABSIY, 5, CYCLE_M                  }, /* 99 STA */
+    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
+    {"TXY", IMPLI, 2, 0                        }, /* 9B TXY */
+    {"STZ", ABSOL, 4, CYCLE_M                  }, /* 9C STZ */
+    {"STA", ABSIX, 5, CYCLE_M                  }, /* 9D STA */
+    {"STZ", ABSIX, 5, CYCLE_M                  }, /* 9E STZ */
+    {"STA", ABLIX, 5, CYCLE_M                  }, /* 9F STA */
+    {"LDY", IMMED, 2, CYCLE_X                  }, /* A0 LDY */
+    {"LDA", INDIN, 6, CYCLE_M                  }, /* A1 LDA */
+    {"LDX", IMMED, 2, CYCLE_X                  }, /* A2 LDX */
+    {"LDA", STREL, 4, CYCLE_M                  }, /* A3 LDA */
+    {"LDY", ZEROP, 3, CYCLE_X                  }, /* A4 LDY */
+    {"LDA", ZEROP, 3, CYCLE_M                  }, /* A5 LDA */
+    {"LDX", ZEROP, 3, CYCLE_X                  }, /* A6 LDX */
+    {"LDA", INDLO, 6, CYCLE_M                  }, /* A7 LDA */
+    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
+    {"LDA", IMMED, 2, CYCLE_M                  }, /* A9 LDA */
+    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
+    {"PLB", IMPLI, 4, 0                        }, /* AB PLB */
+    {"LDY", ABSOL, 4, CYCLE_X                  }, /* AC LDY */
+    {"LDA", ABSOL, 4, CYCLE_M                  }, /* AD LDA */
+    {"LDX", ABSOL, 4, CYCLE_X                  }, /* AE LDX */
+    {"LDA", ABSLO, 5, CYCLE_M                  }, /* AF LDA */
+    {"BCS", RELAT, 2, CYCLE_BRANCH             }, /* B0 BCS */
+    {"LDA", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* B1 LDA */
+    {"LDA", ZEPIN, 5, CYCLE_M                  }, /* B2 LDA */
+    {"LDA", SRIIY, 7, CYCLE_M                  }, /* B3 LDA */
+    {"LDY", ZEPIX, 4, CYCLE_X                  }, /* B4 LDY */
+    {"LDA", ZEPIX, 4, CYCLE_M                  }, /* B5 LDA */
+    {"LDX", ZEPIY, 4, CYCLE_X                  }, /* B6 LDX */
+    {"LDA", INLIY, 6, CYCLE_M                  }, /* B7 LDA */
+    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
+    {"LDA", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* B9 LDA */
+    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
+    {"TYX", IMPLI, 2, 0                        }, /* BB TYX */
+    {"LDY", ABSIX, 4, CYCLE_X | CYCLE_PAGE     }, /* BC LDY */
+    {"LDA", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* BD LDA */
+    {"LDX", ABSIY, 4, CYCLE_X | CYCLE_PAGE     }, /* BE LDX */
+    {"LDA", ABLIX, 5, CYCLE_M                  }, /* BF LDA */
+    {"CPY", IMMED, 2, CYCLE_X                  }, /* C0 CPY */
+    {"CMP", INDIN, 6, CYCLE_M                  }, /* C1 CMP */
+    {"REP", IMMED, 3, 0                        }, /* C2 REP */
+    {"CMP", STREL, 4, CYCLE_M                  }, /* C3 CMP */
+    {"CPY", ZEROP, 3, CYCLE_X                  }, /* C4 CPY */
+    {"CMP", ZEROP, 3, CYCLE_M                  }, /* C5 CMP */
+    {"DEC", ZEROP, 5, CYCLE_RMW                }, /* C6 DEC */
+    {"CMP", INDLO, 6, CYCLE_M                  }, /* C7 CMP */
+    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
+    {"CMP", IMMED, 2, CYCLE_M                  }, /* C9 CMP */
+    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
+    {"WAI", IMPLI, 3, 0                        }, /* CB WAI */
+    {"CPY", ABSOL, 4, CYCLE_X                  }, /* CC CPY */
+    {"CMP", ABSOL, 4, CYCLE_M                  }, /* CD CMP */
+    {"DEC", ABSOL, 6, CYCLE_RMW                }, /* CE DEC */
+    {"CMP", ABSLO, 5, CYCLE_M                  }, /* CF CMP */
+    {"BNE", RELAT, 2, CYCLE_BRANCH             }, /* D0 BNE */
+    {"CMP", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* D1 CMP */
+    {"CMP", ZEPIN, 5, CYCLE_M                  }, /* D2 CMP */
+    {"CMP", SRIIY, 7, CYCLE_M                  }, /* D3 CMP */
+    {"PEI", ZEPIN, 6, 0                        }, /* D4 PEI */
+    {"CMP", ZEPIX, 4, CYCLE_M                  }, /* D5 CMP */
+    {"DEC", ZEPIX, 6, CYCLE_RMW                }, /* D6 DEC */
+    {"CMP", INLIY, 6, CYCLE_M                  }, /* D7 CMP */
+    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
+    {"CMP", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* D9 CMP */
+    {"PHX", IMPLI, 3, CYCLE_X                  }, /* DA PHX */
+    {"STP", IMPLI, 3, 0                        }, /* DB STP */
+    {"JML", INDLA, 6, 0                        }, /* DC JML */
+    {"CMP", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* DD CMP */
+    {"DEC", ABSIX, 7, CYCLE_RMW                }, /* DE DEC */
+    {"CMP", ABLIX, 5, CYCLE_M                  }, /* DF CMP */
+    {"CPX", IMMED, 2, CYCLE_X                  }, /* E0 CPX */
+    {"SBC", INDIN, 6, CYCLE_M                  }, /* E1 SBC */
+    {"SEP", IMMED, 3, 0                        }, /* E2 SEP */
+    {"SBC", STREL, 4, CYCLE_M                  }, /* E3 SBC */
+    {"CPX", ZEROP, 3, CYCLE_X                  }, /* E4 CPX */
+    {"SBC", ZEROP, 3, CYCLE_M                  }, /* E5 SBC */
+    {"INC", ZEROP, 5, CYCLE_RMW                }, /* E6 INC */
+    {"SBC", INDLO, 6, CYCLE_M                  }, /* E7 SBC */
+    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
+    {"SBC", IMMED, 2, CYCLE_M                  }, /* E9 SBC */
+    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
+    {"XBA", IMPLI, 3, 0                        }, /* EB XBA */
+    {"CPX", ABSOL, 4, CYCLE_X                  }, /* EC CPX */
+    {"SBC", ABSOL, 4, CYCLE_M                  }, /* ED SBC */
+    {"INC", ABSOL, 6, CYCLE_RMW                }, /* EE INC */
+    {"SBC", ABSLO, 5, CYCLE_M                  }, /* EF SBC */
+    {"BEQ", RELAT, 2, CYCLE_BRANCH             }, /* F0 BEQ */
+    {"SBC", ININD, 5, CYCLE_M | CYCLE_PAGE     }, /* F1 SBC */
+    {"SBC", ZEPIN, 5, CYCLE_M                  }, /* F2 SBC */
+    {"SBC", SRIIY, 7, CYCLE_M                  }, /* F3 SBC */
+    {"PEA", ABSOL, 5, 0                        }, /* F4 PEA */
+    {"SBC", ZEPIX, 4, CYCLE_M                  }, /* F5 SBC */
+    {"INC", ZEPIX, 6, CYCLE_RMW                }, /* F6 INC */
+    {"SBC", INLIY, 6, CYCLE_M                  }, /* F7 SBC */
+    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
+    {"SBC", ABSIY, 4, CYCLE_M | CYCLE_PAGE     }, /* F9 SBC */
+    {"PLX", IMPLI, 4, CYCLE_X                  }, /* FA PLX */
+    {"XCE", IMPLI, 2, 0                        }, /* FB XCE */
+    {"JSR", INDAX, 8, 0                        }, /* FC JSR */
+    {"SBC", ABSIX, 4, CYCLE_M | CYCLE_PAGE     }, /* FD SBC */
+    {"INC", ABSIX, 7, CYCLE_RMW                }, /* FE INC */
+    {"SBC", ABLIX, 5, CYCLE_M                  }  /* FF SBC */
+}; // 65816
+
+/* Cycles without the T flag, which adds 3 to the ALU instructions. Block
+   transfers take DCC6502_BLOCK_CYCLES more per byte */
+static const opcode_t g_huc6280_opcodes[NUMBER_OPCODES] = {
+    {"BRK", IMPLI, 8, 0                        }, /* 00 BRK */
+    {"ORA", INDIN, 7, 0                        }, /* 01 ORA */
+    {"SXY", IMPLI, 3, _65C02                   }, /* 02 SXY */
+    {"ST0", IMMED, 4, _65C02                   }, /* 03 ST0 */
+    {"TSB", ZEROP, 6, _65C02                   }, /* 04 TSB */
+    {"ORA", ZEROP, 4, 0                        }, /* 05 ORA */
+    {"ASL", ZEROP, 6, 0                        }, /* 06 ASL */
+    {"RMB0", ZEROP, 7, _65C02                  }, /* 07 RMB0 */
+    {"PHP", IMPLI, 3, 0                        }, /* 08 PHP */
+    {"ORA", IMMED, 2, 0                        }, /* 09 ORA */
+    {"ASL", ACCUM, 2, 0                        }, /* 0A ASL */
+    {"???", 0    , 2, BAD                      }, /* 0B     illegal HuC6280 */
+    {"TSB", ABSOL, 7, _65C02                   }, /* 0C TSB */
+    {"ORA", ABSOL, 5, 0                        }, /* 0D ORA */
+    {"ASL", ABSOL, 7, 0                        }, /* 0E ASL */
+    {"BBR0", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 0F BBR0 */
+    {"BPL", RELAT, 2, CYCLE_BRANCH2            }, /* 10 BPL */
+    {"ORA", ININD, 7, 0                        }, /* 11 ORA */
+    {"ORA", ZEPIN, 7, _65C02                   }, /* 12 ORA */
+    {"ST1", IMMED, 4, _65C02                   }, /* 13 ST1 */
+    {"TRB", ZEROP, 6, _65C02                   }, /* 14 TRB */
+    {"ORA", ZEPIX, 4, 0                        }, /* 15 ORA */
+    {"ASL", ZEPIX, 6, 0                        }, /* 16 ASL */
+    {"RMB1", ZEROP, 7, _65C02                  }, /* 17 RMB1 */
+    {"CLC", IMPLI, 2, 0                        }, /* 18 CLC */
+    {"ORA", ABSIY, 5, 0                        }, /* 19 ORA */
+    {"INC", ACCUM, 2, _65C02                   }, /* 1A INC */
+    {"???", 0    , 2, BAD                      }, /* 1B     illegal HuC6280 */
+    {"TRB", ABSOL, 7, _65C02                   }, /* 1C TRB */
+    {"ORA", ABSIX, 5, 0                        }, /* 1D ORA */
+    {"ASL", ABSIX, 7, 0                        }, /* 1E ASL */
+    {"BBR1", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 1F BBR1 */
+    {"JSR", ABSOL, 7, 0                        }, /* 20 JSR */
+    {"AND", INDIN, 7, 0                        }, /* 21 AND */
+    {"SAX", IMPLI, 3, _65C02                   }, /* 22 SAX */
+    {"ST2", IMMED, 4, _65C02                   }, /* 23 ST2 */
+    {"BIT", ZEROP, 4, 0                        }, /* 24 BIT */
+    {"AND", ZEROP, 4, 0                        }, /* 25 AND */
+    {"ROL", ZEROP, 6, 0                        }, /* 26 ROL */
+    {"RMB2", ZEROP, 7, _65C02                  }, /* 27 RMB2 */
+    {"PLP", IMPLI, 4, 0                        }, /* 28 PLP */
+    {"AND", IMMED, 2, 0                        }, /* 29 AND */
+    {"ROL", ACCUM, 2, 0                        }, /* 2A ROL */
+    {"???", 0    , 2, BAD                      }, /* 2B     illegal HuC6280 */
+    {"BIT", ABSOL, 5, 0                        }, /* 2C BIT */
+    {"AND", ABSOL, 5, 0                        }, /* 2D AND */
+    {"ROL", ABSOL, 7, 0                        }, /* 2E ROL */
+    {"BBR2", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 2F BBR2 */
+    {"BMI", RELAT, 2, CYCLE_BRANCH2            }, /* 30 BMI */
+    {"AND", ININD, 7, 0                        }, /* 31 AND */
+    {"AND", ZEPIN, 7, _65C02                   }, /* 32 AND */
+    {"???", 0    , 2, BAD                      }, /* 33     illegal HuC6280 */
+    {"BIT", ZEPIX, 4, _65C02                   }, /* 34 BIT */
+    {"AND", ZEPIX, 4, 0                        }, /* 35 AND */
+    {"ROL", ZEPIX, 6, 0                        }, /* 36 ROL */
+    {"RMB3", ZEROP, 7, _65C02                  }, /* 37 RMB3 */
+    {"SEC", IMPLI, 2, 0                        }, /* 38 SEC */
+    {"AND", ABSIY, 5, 0                        }, /* 39 AND */
+    {"DEC", ACCUM, 2, _65C02                   }, /* 3A DEC */
+    {"???", 0    , 2, BAD                      }, /* 3B     illegal HuC6280 */
+    {"BIT", ABSIX, 5, _65C02                   }, /* 3C BIT */
+    {"AND", ABSIX, 5, 0                        }, /* 3D AND */
+    {"ROL", ABSIX, 7, 0                        }, /* 3E ROL */
+    {"BBR3", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 3F BBR3 */
+    {"RTI", IMPLI, 7, 0                        }, /* 40 RTI */
+    {"EOR", INDIN, 7, 0                        }, /* 41 EOR */
+    {"SAY", IMPLI, 3, _65C02                   }, /* 42 SAY */
+    {"TMA", IMMED, 4, _65C02                   }, /* 43 TMA */
+    {"BSR", RELAT, 8, _65C02                   }, /* 44 BSR */
+    {"EOR", ZEROP, 4, 0                        }, /* 45 EOR */
+    {"LSR", ZEROP, 6, 0                        }, /* 46 LSR */
+    {"RMB4", ZEROP, 7, _65C02                  }, /* 47 RMB4 */
+    {"PHA", IMPLI, 3, 0                        }, /* 48 PHA */
+    {"EOR", IMMED, 2, 0                        }, /* 49 EOR */
+    {"LSR", ACCUM, 2, 0                        }, /* 4A LSR */
+    {"???", 0    , 2, BAD                      }, /* 4B     illegal HuC6280 */
+    {"JMP", ABSOL, 4, 0                        }, /* 4C JMP */
+    {"EOR", ABSOL, 5, 0                        }, /* 4D EOR */
+    {"LSR", ABSOL, 7, 0                        }, /* 4E LSR */
+    {"BBR4", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 4F BBR4 */
+    {"BVC", RELAT, 2, CYCLE_BRANCH2            }, /* 50 BVC */
+    {"EOR", ININD, 7, 0                        }, /* 51 EOR */
+    {"EOR", ZEPIN, 7, _65C02                   }, /* 52 EOR */
+    {"TAM", IMMED, 5, _65C02                   }, /* 53 TAM */
+    {"CSL", IMPLI, 3, _65C02                   }, /* 54 CSL */
+    {"EOR", ZEPIX, 4, 0                        }, /* 55 EOR */
+    {"LSR", ZEPIX, 6, 0                        }, /* 56 LSR */
+    {"RMB5", ZEROP, 7, _65C02                  }, /* 57 RMB5 */
+    {"CLI", IMPLI, 2, 0                        }, /* 58 CLI */
+    {"EOR", ABSIY, 5, 0                        }, /* 59 EOR */
+    {"PHY", IMPLI, 3, _65C02                   }, /* 5A PHY */
+    {"???", 0    , 2, BAD                      }, /* 5B     illegal HuC6280 */
+    {"???", 0    , 2, BAD                      }, /* 5C     illegal HuC6280 */
+    {"EOR", ABSIX, 5, 0                        }, /* 5D EOR */
+    {"LSR", ABSIX, 7, 0                        }, /* 5E LSR */
+    {"BBR5", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 5F BBR5 */
+    {"RTS", IMPLI, 7, 0                        }, /* 60 RTS */
+    {"ADC", INDIN, 7, 0                        }, /* 61 ADC */
+    {"CLA", IMPLI, 2, _65C02                   }, /* 62 CLA */
+    {"???", 0    , 2, BAD                      }, /* 63     illegal HuC6280 */
+    {"STZ", ZEROP, 4, _65C02                   }, /* 64 STZ */
+    {"ADC", ZEROP, 4, 0                        }, /* 65 ADC */
+    {"ROR", ZEROP, 6, 0                        }, /* 66 ROR */
+    {"RMB6", ZEROP, 7, _65C02                  }, /* 67 RMB6 */
+    {"PLA", IMPLI, 4, 0                        }, /* 68 PLA */
+    {"ADC", IMMED, 2, 0                        }, /* 69 ADC */
+    {"ROR", ACCUM, 2, 0                        }, /* 6A ROR */
+    {"???", 0    , 2, BAD                      }, /* 6B     illegal HuC6280 */
+    {"JMP", INDIA, 7, 0                        }, /* 6C JMP */
+    {"ADC", ABSOL, 5, 0                        }, /* 6D ADC */
+    {"ROR", ABSOL, 7, 0                        }, /* 6E ROR */
+    {"BBR6", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 6F BBR6 */
+    {"BVS", RELAT, 2, CYCLE_BRANCH2            }, /* 70 BVS */
+    {"ADC", ININD, 7, 0                        }, /* 71 ADC */
+    {"ADC", ZEPIN, 7, _65C02                   }, /* 72 ADC */
+    {"TII", BLKTR, 17, _65C02                  }, /* 73 TII */
+    {"STZ", ZEPIX, 4, _65C02                   }, /* 74 STZ */
+    {"ADC", ZEPIX, 4, 0                        }, /* 75 ADC */
+    {"ROR", ZEPIX, 6, 0                        }, /* 76 ROR */
+    {"RMB7", ZEROP, 7, _65C02                  }, /* 77 RMB7 */
+    {"SEI", IMPLI, 2, 0                        }, /* 78 SEI */
+    {"ADC", ABSIY, 5, 0                        }, /* 79 ADC */
+    {"PLY", IMPLI, 4, _65C02                   }, /* 7A PLY */
+    {"???", 0    , 2, BAD                      }, /* 7B     illegal HuC6280 */
+    {"JMP", INDAX, 7, _65C02                   }, /* 7C JMP */
+    {"ADC", ABSIX, 5, 0                        }, /* 7D ADC */
+    {"ROR", ABSIX, 7, 0                        }, /* 7E ROR */
+    {"BBR7", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 7F BBR7 */
+    {"BRA", RELAT, 4, _65C02                   }, /* 80 BRA */
+    {"STA", INDIN, 7, 0                        }, /* 81 STA */
+    {"CLX", IMPLI, 2, _65C02                   }, /* 82 CLX */
+    {"TST", TSTZP, 7, _65C02                   }, /* 83 TST */
+    {"STY", ZEROP, 4, 0                        }, /* 84 STY */
+    {"STA", ZEROP, 4, 0                        }, /* 85 STA */
+    {"STX", ZEROP, 4, 0                        }, /* 86 STX */
+    {"SMB0", ZEROP, 7, _65C02                  }, /* 87 SMB0 */
+    {"DEY", IMPLI, 2, 0                        }, /* 88 DEY */
+    {"BIT", IMMED, 2, _65C02                   }, /* 89 BIT */
+    {"TXA", IMPLI, 2, 0                        }, /* 8A TXA */
+    {"???", 0    , 2, BAD                      }, /* 8B     illegal HuC6280 */
+    {"STY", ABSOL, 5, 0                        }, /* 8C STY */
+    {"STA", ABSOL, 5, 0                        }, /* 8D STA */
+    {"STX", ABSOL, 5, 0                        }, /* 8E STX */
+    {"BBS0", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 8F BBS0 */
+    {"BCC", RELAT, 2, CYCLE_BRANCH2            }, /* 90 BCC */
+    {"STA", ININD, 7, 0                        }, /* 91 STA */
+    {"STA", ZEPIN, 7, _65C02                   }, /* 92 STA */
+    {"TST", TSTAB, 8, _65C02                   }, /* 93 TST */
+    {"STY", ZEPIX, 4, 0                        }, /* 94 STY */
+    {"STA", ZEPIX, 4, 0                        }, /* 95 STA */
+    {"STX", ZEPIY, 4, 0                        }, /* 96 STX */
+    {"SMB1", ZEROP, 7, _65C02                  }, /* 97 SMB1 */
+    {"TYA", IMPLI, 2, 0                        }, /* 98 TYA */
+    {"STA", ABSIY, 5, 0                        }, /* 99 STA */
+    {"TXS", IMPLI, 2, 0                        }, /* 9A TXS */
+    {"???", 0    , 2, BAD                      }, /* 9B     illegal HuC6280 */
+    {"STZ", ABSOL, 5, _65C02                   }, /* 9C STZ */
+    {"STA", ABSIX, 5, 0                        }, /* 9D STA */
+    {"STZ", ABSIX, 5, _65C02                   }, /* 9E STZ */
+    {"BBS1", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* 9F BBS1 */
+    {"LDY", IMMED, 2, 0                        }, /* A0 LDY */
+    {"LDA", INDIN, 7, 0                        }, /* A1 LDA */
+    {"LDX", IMMED, 2, 0                        }, /* A2 LDX */
+    {"TST", TSTZX, 7, _65C02                   }, /* A3 TST */
+    {"LDY", ZEROP, 4, 0                        }, /* A4 LDY */
+    {"LDA", ZEROP, 4, 0                        }, /* A5 LDA */
+    {"LDX", ZEROP, 4, 0                        }, /* A6 LDX */
+    {"SMB2", ZEROP, 7, _65C02                  }, /* A7 SMB2 */
+    {"TAY", IMPLI, 2, 0                        }, /* A8 TAY */
+    {"LDA", IMMED, 2, 0                        }, /* A9 LDA */
+    {"TAX", IMPLI, 2, 0                        }, /* AA TAX */
+    {"???", 0    , 2, BAD                      }, /* AB     illegal HuC6280 */
+    {"LDY", ABSOL, 5, 0                        }, /* AC LDY */
+    {"LDA", ABSOL, 5, 0                        }, /* AD LDA */
+    {"LDX", ABSOL, 5, 0                        }, /* AE LDX */
+    {"BBS2", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* AF BBS2 */
+    {"BCS", RELAT, 2, CYCLE_BRANCH2            }, /* B0 BCS */
+    {"LDA", ININD, 7, 0                        }, /* B1 LDA */
+    {"LDA", ZEPIN, 7, _65C02                   }, /* B2 LDA */
+    {"TST", TSTAX, 8, _65C02                   }, /* B3 TST */
+    {"LDY", ZEPIX, 4, 0                        }, /* B4 LDY */
+    {"LDA", ZEPIX, 4, 0                        }, /* B5 LDA */
+    {"LDX", ZEPIY, 4, 0                        }, /* B6 LDX */
+    {"SMB3", ZEROP, 7, _65C02                  }, /* B7 SMB3 */
+    {"CLV", IMPLI, 2, 0                        }, /* B8 CLV */
+    {"LDA", ABSIY, 5, 0                        }, /* B9 LDA */
+    {"TSX", IMPLI, 2, 0                        }, /* BA TSX */
+    {"???", 0    , 2, BAD                      }, /* BB     illegal HuC6280 */
+    {"LDY", ABSIX, 5, 0                        }, /* BC LDY */
+    {"LDA", ABSIX, 5, 0                        }, /* BD LDA */
+    {"LDX", ABSIY, 5, 0                        }, /* BE LDX */
+    {"BBS3", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* BF BBS3 */
+    {"CPY", IMMED, 2, 0                        }, /* C0 CPY */
+    {"CMP", INDIN, 7, 0                        }, /* C1 CMP */
+    {"CLY", IMPLI, 2, _65C02                   }, /* C2 CLY */
+    {"TDD", BLKTR, 17, _65C02                  }, /* C3 TDD */
+    {"CPY", ZEROP, 4, 0                        }, /* C4 CPY */
+    {"CMP", ZEROP, 4, 0                        }, /* C5 CMP */
+    {"DEC", ZEROP, 6, 0                        }, /* C6 DEC */
+    {"SMB4", ZEROP, 7, _65C02                  }, /* C7 SMB4 */
+    {"INY", IMPLI, 2, 0                        }, /* C8 INY */
+    {"CMP", IMMED, 2, 0                        }, /* C9 CMP */
+    {"DEX", IMPLI, 2, 0                        }, /* CA DEX */
+    {"???", 0    , 2, BAD                      }, /* CB     illegal HuC6280 */
+    {"CPY", ABSOL, 5, 0                        }, /* CC CPY */
+    {"CMP", ABSOL, 5, 0                        }, /* CD CMP */
+    {"DEC", ABSOL, 7, 0                        }, /* CE DEC */
+    {"BBS4", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* CF BBS4 */
+    {"BNE", RELAT, 2, CYCLE_BRANCH2            }, /* D0 BNE */
+    {"CMP", ININD, 7, 0                        }, /* D1 CMP */
+    {"CMP", ZEPIN, 7, _65C02                   }, /* D2 CMP */
+    {"TIN", BLKTR, 17, _65C02                  }, /* D3 TIN */
+    {"CSH", IMPLI, 3, _65C02                   }, /* D4 CSH */
+    {"CMP", ZEPIX, 4, 0                        }, /* D5 CMP */
+    {"DEC", ZEPIX, 6, 0                        }, /* D6 DEC */
+    {"SMB5", ZEROP, 7, _65C02                  }, /* D7 SMB5 */
+    {"CLD", IMPLI, 2, 0                        }, /* D8 CLD */
+    {"CMP", ABSIY, 5, 0                        }, /* D9 CMP */
+    {"PHX", IMPLI, 3, _65C02                   }, /* DA PHX */
+    {"???", 0    , 2, BAD                      }, /* DB     illegal HuC6280 */
+    {"???", 0    , 2, BAD                      }, /* DC     illegal HuC6280 */
+    {"CMP", ABSIX, 5, 0                        }, /* DD CMP */
+    {"DEC", ABSIX, 7, 0                        }, /* DE DEC */
+    {"BBS5", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* DF BBS5 */
+    {"CPX", IMMED, 2, 0                        }, /* E0 CPX */
+    {"SBC", INDIN, 7, 0                        }, /* E1 SBC */
+    {"???", 0    , 2, BAD                      }, /* E2     illegal HuC6280 */
+    {"TIA", BLKTR, 17, _65C02                  }, /* E3 TIA */
+    {"CPX", ZEROP, 4, 0                        }, /* E4 CPX */
+    {"SBC", ZEROP, 4, 0                        }, /* E5 SBC */
+    {"INC", ZEROP, 6, 0                        }, /* E6 INC */
+    {"SMB6", ZEROP, 7, _65C02                  }, /* E7 SMB6 */
+    {"INX", IMPLI, 2, 0                        }, /* E8 INX */
+    {"SBC", IMMED, 2, 0                        }, /* E9 SBC */
+    {"NOP", IMPLI, 2, 0                        }, /* EA NOP */
+    {"???", 0    , 2, BAD                      }, /* EB     illegal HuC6280 */
+    {"CPX", ABSOL, 5, 0                        }, /* EC CPX */
+    {"SBC", ABSOL, 5, 0                        }, /* ED SBC */
+    {"INC", ABSOL, 7, 0                        }, /* EE INC */
+    {"BBS6", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }, /* EF BBS6 */
+    {"BEQ", RELAT, 2, CYCLE_BRANCH2            }, /* F0 BEQ */
+    {"SBC", ININD, 7, 0                        }, /* F1 SBC */
+    {"SBC", ZEPIN, 7, _65C02                   }, /* F2 SBC */
+    {"TAI", BLKTR, 17, _65C02                  }, /* F3 TAI */
+    {"SET", IMPLI, 2, _65C02                   }, /* F4 SET */
+    {"SBC", ZEPIX, 4, 0                        }, /* F5 SBC */
+    {"INC", ZEPIX, 6, 0                        }, /* F6 INC */
+    {"SMB7", ZEROP, 7, _65C02                  }, /* F7 SMB7 */
+    {"SED", IMPLI, 2, 0                        }, /* F8 SED */
+    {"SBC", ABSIY, 5, 0                        }, /* F9 SBC */
+    {"PLX", IMPLI, 4, _65C02                   }, /* FA PLX */
+    {"???", 0    , 2, BAD                      }, /* FB     illegal HuC6280 */
+    {"???", 0    , 2, BAD                      }, /* FC     illegal HuC6280 */
+    {"SBC", ABSIX, 5, 0                        }, /* FD SBC */
+    {"INC", ABSIX, 7, 0                        }, /* FE INC */
+    {"BBS7", ZEREL, 6, CYCLE_BRANCH2 | _65C02  }  /* FF BBS7 */
+}; // HuC6280
+
+
+/* Operand layout of each addressing_mode_e */
+static const addressing_t g_addressing[] = {
+    { 2, " #$", 2, ""   , "immediate"          }, /* IMMED */
+    { 3, " $" , 4, ""   , "absolute"           }, /* ABSOL */
+    { 2, " $" , 2, ""   , "zero page"          }, /* ZEROP */
+    { 1, ""   , 0, ""   , "implied"            }, /* IMPLI */
+    { 3, " ($", 4, ")"  , "indirect"           }, /* INDIA */
+    { 3, " $" , 4, ",X" , "absolute,X"         }, /* ABSIX */
+    { 3, " $" , 4, ",Y" , "absolute,Y"         }, /* ABSIY */
+    { 2, " $" , 2, ",X" , "zero page,X"        }, /* ZEPIX */
+    { 2, " $" , 2, ",Y" , "zero page,Y"        }, /* ZEPIY */
+    { 2, " ($", 2, ",X)", "indexed indirect"   }, /* INDIN */
+    { 2, " ($", 2, "),Y", "indirect indexed"   }, /* ININD */
+    { 2, " $" , 4, ""   , "relative"           }, /* RELAT */
+    { 1, " A" , 0, ""   , "accumulator"        }, /* ACCUM */
+    { 2, " ($", 2, ")"  , "zero page indirect" }, /* ZEPIN */
+    { 3, " ($", 4, ",X)", "absolute indexed indirect" }, /* INDAX */
+    { 3, " $" , 4, ""   , "zero page,relative" }, /* ZEREL, the zero page byte and ',' precede the target */
+    { 4, " $" , 6, ""   , "absolute long"      }, /* ABSLO */
+    { 4, " $" , 6, ",X" , "absolute long,X"    }, /* ABLIX */
+    { 2, " [$", 2, "]"  , "zero page indirect long" }, /* INDLO */
+    { 2, " [$", 2, "],Y", "indirect long indexed" }, /* INLIY */
+    { 2, " $" , 2, ",S" , "stack relative"     }, /* STREL */
+    { 2, " ($", 2, ",S),Y", "stack relative indirect indexed" }, /* SRIIY */
+    { 3, " $" , 4, ""   , "relative long"      }, /* RELLO */
+    { 3, " $" , 2, ""   , "block move"         }, /* BLKMV, the source bank and ',' precede the destination */
+    { 3, " [$", 4, "]"  , "absolute indirect long" }, /* INDLA */
+    { 7, " $" , 4, ""   , "block transfer"     }, /* BLKTR, the source and the destination precede the length */
+    { 3, " #$", 2, ""   , "immediate,zero page" }, /* TSTZP, the immediate byte and ',$' precede the address */
+    { 4, " #$", 4, ""   , "immediate,absolute" }, /* TSTAB */
+    { 3, " #$", 2, ",X" , "immediate,zero page,X" }, /* TSTZX */
+    { 4, " #$", 4, ",X" , "immediate,absolute,X" }  /* TSTAX */
+};
+
+
+static const char g_hex_digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7',
+    '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+void dcc6502_init(dcc6502_t *dcc, dcc6502_cpu_e cpu) {
+    if (DCC6502_CPU_65C02 == cpu)
+        dcc6502_init_table(dcc, g_65C02_opcodes);
+    else if (DCC6502_CPU_6502_UNDOC == cpu)
+        dcc6502_init_table(dcc, g_6502u_opcodes);
+    else if (DCC6502_CPU_65816 == cpu)
+        dcc6502_init_table(dcc, g_65816_opcodes);
+    else if (DCC6502_CPU_HUC6280 == cpu)
+        dcc6502_init_table(dcc, g_huc6280_opcodes);
+    else
+        dcc6502_init_table(dcc, g_6502_opcodes);
+}
+
+void dcc6502_init_table(dcc6502_t *dcc, const opcode_t *table) {
+    int opcode, id;
+
+    dcc->table = table;
+
+    for (opcode = 0; opcode < NUMBER_OPCODES; opcode++) {
+        dcc->mnemonic[opcode] = 0;
+        for (id = 0; g_mnemonics[id]; id++) {
+            if (!strcmp(g_mnemonics[id], dcc->table[opcode].mnemonic)) {
+                dcc->mnemonic[opcode] = id;
+                break;
+            }
+        }
+    }
+}
+
+size_t dcc6502_decode(const dcc6502_t *dcc, const uint8_t *code, size_t avail, uint16_t address, dcc6502_insn_t *insn) {
+    return dcc6502_decode_p(dcc, code, avail, address, DCC6502_P_RESET, insn);
+}
+
+size_t dcc6502_decode_p(const dcc6502_t *dcc, const uint8_t *code, size_t avail, uint32_t address, unsigned int p, dcc6502_insn_t *insn) {
+    const opcode_t *entry;
+    unsigned int    exceptions;
+    uint32_t        bank, next, count;
+    int             i;
+
+    if (0 == avail)
+        return 0;
+
+    entry      = &dcc->table[code[0]];
+    exceptions = entry->cycles_exceptions;
+    if (exceptions & BAD) {
+        insn->length = 1;
+    } else {
+        insn->length = g_addressing[entry->addressing].length;
+        // 65816 immediates are 16-bit while M, or X, is clear
+        if ((IMMED == entry->addressing) &&
+            (((exceptions & CYCLE_M) && !(p & DCC6502_P_M)) || ((exceptions & CYCLE_X) && !(p & DCC6502_P_X))))
+            insn->length++;
+    }
+    if (insn->length > avail)
+        return 0;
+
+    insn->address    = address;
+    insn->opcode     = code[0];
+    insn->mnemonic   = dcc->mnemonic[code[0]];
+    insn->addressing = entry->addressing;
+    insn->flags      = exceptions;
+    for (i = 0; i < MAX_INSTRUCTION_LENGTH; i++)
+        insn->bytes[i] = (i < insn->length) ? code[i] : 0;
+
+    insn->operand = 0;
+    for (i = insn->length - 1; i > 0; i--)
+        insn->operand = (insn->operand << 8) | code[i];
+
+    // The program counter wraps around within its bank
+    bank         = address & 0xff0000u;
+    next         = bank | ((address + insn->length) & 0xffffu);
+    insn->target = insn->operand;
+    if ((RELAT == entry->addressing) && !(exceptions & BAD))
+        insn->target = bank | ((next + (int8_t)code[1]) & 0xffffu);
+    else if ((ZEREL == entry->addressing) && !(exceptions & BAD))
+        insn->target = bank | ((next + (int8_t)code[2]) & 0xffffu);
+    else if ((RELLO == entry->addressing) && !(exceptions & BAD))
+        insn->target = bank | ((next + (int16_t)insn->operand) & 0xffffu);
+    else if ((BLKTR == entry->addressing) && !(exceptions & BAD))
+        insn->target = insn->operand >> 16;
+    else if ((entry->addressing >= TSTZP) && !(exceptions & BAD))
+        insn->target = insn->operand >> 8;
+
+    // A taken branch costs one more cycle, two when it crosses a page. BRA
+    // is always taken, only its page crossing costs
+    insn->cycles_min = entry->cycles;
+    insn->cycles_max = entry->cycles;
+    if ((RELAT == entry->addressing) || (ZEREL == entry->addressing)) {
+        if (exceptions & CYCLE_BRANCH) {
+            insn->cycles_max++;
+            if ((exceptions & CYCLE_PAGE) && ((next ^ insn->target) & 0xff00u))
+                insn->cycles_max++;
+        } else if (exceptions & CYCLE_BRANCH2) {
+            insn->cycles_max += 2;
+        } else if ((exceptions & CYCLE_PAGE) && ((next ^ insn->target) & 0xff00u)) {
+            insn->cycles_min++;
+            insn->cycles_max++;
+        }
+    } else if (exceptions & CYCLE_PAGE) {
+        // 16-bit index registers always take the page crossing cycle
+        if (!(p & DCC6502_P_X))
+            insn->cycles_min++;
+        insn->cycles_max++;
+    }
+
+    // 65816 accesses of 16-bit registers take one more cycle per byte
+    if (!(p & DCC6502_P_M)) {
+        i = ((exceptions & CYCLE_M) ? 1 : 0) + ((exceptions & CYCLE_RMW) ? 2 : 0);
+        insn->cycles_min += i;
+        insn->cycles_max += i;
+    }
+    if (!(p & DCC6502_P_X) && (exceptions & CYCLE_X)) {
+        insn->cycles_min++;
+        insn->cycles_max++;
+    }
+
+    // Block transfers move their length in bytes, a zero length moves 64K
+    if ((BLKTR == entry->addressing) && !(exceptions & BAD)) {
+        count = code[5] | (code[6] << 8);
+        count = count ? count : 0x10000u;
+        insn->cycles_min += DCC6502_BLOCK_CYCLES * count;
+        insn->cycles_max += DCC6502_BLOCK_CYCLES * count;
+    }
+
+    return insn->length;
+}
+
+unsigned int dcc6502_track(const dcc6502_insn_t *insn, unsigned int p) {
+    unsigned int carry;
+
+    if (insn->flags & BAD)
+        return p & ~DCC6502_P_CKNOWN;
+
+    switch (insn->mnemonic) {
+        case MNEMONIC_CLC:
+            return (p & ~DCC6502_P_C) | DCC6502_P_CKNOWN;
+        case MNEMONIC_SEC:
+            return p | DCC6502_P_C | DCC6502_P_CKNOWN;
+        case MNEMONIC_REP:
+            // M and X can not be cleared in emulation mode
+            if (!(p & DCC6502_P_E))
+                p &= ~(insn->operand & (DCC6502_P_M | DCC6502_P_X));
+            if (insn->operand & DCC6502_P_C)
+                p = (p & ~DCC6502_P_C) | DCC6502_P_CKNOWN;
+            return p;
+        case MNEMONIC_SEP:
+            p |= insn->operand & (DCC6502_P_M | DCC6502_P_X);
+            if (insn->operand & DCC6502_P_C)
+                p |= DCC6502_P_C | DCC6502_P_CKNOWN;
+            return p;
+        case MNEMONIC_XCE:
+            // Without a known carry, assume the usual switch to native mode
+            carry = (p & DCC6502_P_E) ? DCC6502_P_C : 0;
+            if ((p & DCC6502_P_CKNOWN) && (p & DCC6502_P_C))
+                return (p & ~DCC6502_P_C) | carry | DCC6502_P_E | DCC6502_P_M | DCC6502_P_X;
+            return (p & ~(DCC6502_P_C | DCC6502_P_E)) | carry | DCC6502_P_CKNOWN;
+        default:
+            return p & ~DCC6502_P_CKNOWN;
+    }
+}
+
+size_t dcc6502_disassemble(const dcc6502_t *dcc, const uint8_t *code, size_t length, uint32_t org, dcc6502_callback_t callback, void *user) {
+    dcc6502_insn_t insn;
+    size_t         pos = 0;
+    unsigned int   p   = DCC6502_P_RESET;
+
+    while (dcc6502_decode_p(dcc, &code[pos], length - pos, org, p, &insn)) {
+        pos += insn.length;
+        org  = (org & 0xff0000u) | ((org + insn.length) & 0xffffu);
+        p    = dcc6502_track(&insn, p);
+        if (callback(&insn, user))
+            break;
+    }
+    return pos;
+}
+
+size_t dcc6502_format(const dcc6502_insn_t *insn, char *output, size_t size) {
+    const addressing_t *mode = &g_addressing[insn->addressing];
+    const char         *str;
+    char                text[32];
+    char               *p = text;
+    uint32_t            value;
+    int                 digits, shift;
+    size_t              len;
+
+    if (insn->flags & BAD) {
+        value = insn->opcode;
+        for (str = ".byte $"; *str; )
+            *p++ = *str++;
+        *p++ = g_hex_digits[value >> 4];
+        *p++ = g_hex_digits[value & 0xf];
+    } else {
+        value  = ((RELAT == insn->addressing) || (ZEREL == insn->addressing) || (RELLO == insn->addressing) ||
+                  (insn->addressing >= TSTZP)) ? insn->target : insn->operand;
+        if (BLKTR == insn->addressing)
+            value = insn->bytes[5] | (insn->bytes[6] << 8);
+        digits = ((IMMED == insn->addressing) && (3 == insn->length)) ? 4 : mode->digits;
+        for (str = g_mnemonics[insn->mnemonic]; *str; )
+            *p++ = *str++;
+        for (str = mode->prefix; *str; )
+            *p++ = *str++;
+        if ((ZEREL == insn->addressing) || (BLKMV == insn->addressing)) {
+            shift = (ZEREL == insn->addressing) ? 0 : 8;
+            *p++ = g_hex_digits[(insn->operand >> (shift + 4)) & 0xf];
+            *p++ = g_hex_digits[(insn->operand >> shift) & 0xf];
+            *p++ = ',';
+            *p++ = '$';
+        } else if (BLKTR == insn->addressing) {
+            for (digits = 0; digits < 2; digits++) {
+                for (shift = 16 * digits + 12; shift >= 16 * digits; shift -= 4)
+                    *p++ = g_hex_digits[(insn->operand >> shift) & 0xf];
+                *p++ = ',';
+                *p++ = '$';
+            }
+            digits = mode->digits;
+        } else if (insn->addressing >= TSTZP) {
+            *p++ = g_hex_digits[(insn->operand >> 4) & 0xf];
+            *p++ = g_hex_digits[insn->operand & 0xf];
+            *p++ = ',';
+            *p++ = '$';
+        }
+        for (shift = 4 * (digits - 1); shift >= 0; shift -= 4)
+            *p++ = g_hex_digits[(value >> shift) & 0xf];
+        for (str = mode->suffix; *str; )
+            *p++ = *str++;
+    }
+
+    len = p - text;
+    if (size) {
+        if (len >= size)
+            len = size - 1;
+        memcpy(output, text, len);
+        output[len] = '\0';
+    }
+    return len;
+}
+
+size_t dcc6502_record_header(uint8_t *output, uint32_t org, dcc6502_cpu_e cpu) {
+    memset(output, 0, DCC6502_HEADER_SIZE);
+    memcpy(output, DCC6502_RECORD_MAGIC, 4);
+    output[4]  = DCC6502_RECORD_VERSION & 0xff;
+    output[5]  = DCC6502_RECORD_VERSION >> 8;
+    output[6]  = DCC6502_RECORD_SIZE & 0xff;
+    output[7]  = DCC6502_RECORD_SIZE >> 8;
+    output[8]  = org & 0xff;
+    output[9]  = (org >> 8) & 0xff;
+    output[10] = (uint8_t)cpu;
+    output[11] = (org >> 16) & 0xff;
+    return DCC6502_HEADER_SIZE;
+}
+
+size_t dcc6502_record(const dcc6502_insn_t *insn, uint8_t *output) {
+    int i;
+
+    output[0]  = insn->address & 0xff;
+    output[1]  = (insn->address >> 8) & 0xff;
+    output[2]  = insn->bytes[0];
+    output[3]  = insn->bytes[1];
+    output[4]  = insn->bytes[2];
+    output[5]  = insn->length;
+    output[6]  = insn->opcode;
+    output[7]  = (uint8_t)insn->addressing;
+    output[8]  = insn->target & 0xff;
+    output[9]  = (insn->target >> 8) & 0xff;
+    output[10] = (insn->cycles_min > 0xff) ? 0xff : insn->cycles_min;
+    output[11] = (insn->cycles_max > 0xff) ? 0xff : insn->cycles_max;
+    output[12] = insn->flags & 0xff;
+    output[13] = insn->mnemonic;
+    output[14] = insn->bytes[3];
+    output[15] = (insn->address >> 16) & 0xff;
+    output[16] = insn->bytes[4];
+    output[17] = insn->bytes[5];
+    output[18] = insn->bytes[6];
+    output[19] = insn->flags >> 8;
+    for (i = 0; i < 4; i++) {
+        output[20 + i] = (insn->cycles_min >> (8 * i)) & 0xff;
+        output[24 + i] = (insn->cycles_max >> (8 * i)) & 0xff;
+        output[28 + i] = 0;
+    }
+    return DCC6502_RECORD_SIZE;
+}
+
+const char *dcc6502_mnemonic(unsigned int id) {
+    if (id >= (sizeof(g_mnemonics) / sizeof(g_mnemonics[0])) - 1)
+        return g_mnemonics[0];
+    return g_mnemonics[id];
+}
+
+const addressing_t *dcc6502_addressing(addressing_mode_e mode) {
+    return &g_addressing[mode];
+}